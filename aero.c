@@ -0,0 +1,671 @@
+/**
+	\file aero.c
+	\brief code de l'aeroglisseur, configurations "race" et "drag" (voir profile.h)
+	\author Lucas Mongrain
+	\date 18/04/18
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "uart.h"
+#include "frame.h"
+#include "lcd.h"
+#include "utils.h"
+#include "util_29.h"
+#include "driver.h"
+#include "failsafe.h"
+#include "time.h"
+#include "trace.h"
+#include "stack.h"
+#include "packet.h"
+#include "config.h"
+#include "param.h"
+#include "profile.h"
+#include "launch.h"
+#include "ramp.h"
+#include "slew.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief contient l'angle du centre
+*/
+#define CENTER 1580UL
+
+/**
+    \brief profil utilise tant que l'EEPROM ne contient pas de configuration valide,
+    -DAERO_PROFILE=PROFILE_DRAG pour partir en configuration "drag"
+*/
+#ifndef AERO_PROFILE
+#define AERO_PROFILE PROFILE_RACE
+#endif
+
+/**
+    \brief lecture de l'ADC de la batterie a 0%, et ecart de lecture entre 0% et 100%
+*/
+#define BATTERY_OFFSET 107
+#define BATTERY_SPAN 26
+
+/**
+    \brief correction de l'oscillateur interne (atmega avec marque)
+*/
+#define OSCCAL_OFFSET 6
+
+/**
+    \brief mode et facteur de division des PWM de la sustentation (timer 0) et de la propulsion
+    (timer 2), verifies a la compilation (voir driver.h)
+
+    fast PWM sans division: 31,25 kHz a 8 MHz, au-dela de l'audible, au lieu de 30 Hz avec /1024
+*/
+#define LIFT_PWM_MODE PWM_MODE_FAST
+#define LIFT_PWM_PRESCALER 1
+#define THRUST_PWM_MODE PWM_MODE_FAST
+#define THRUST_PWM_PRESCALER 1
+
+/**
+    \brief courbe de la propulsion, 0 = la commande est appliquee telle quelle
+*/
+#define THROTTLE_CURVE 0
+
+/**
+    \brief identifiants du point d'acces cree par le module wifi
+*/
+#define WIFI_SSID "THING"
+#define WIFI_PASSWORD "f8aa2328679b"
+
+/**
+    \brief temps sans commande valide avant de couper les moteurs
+
+    doit etre plus long que le delai qui suit l'envoi de AT+CIPSEND a la premiere commande
+*/
+#define FAILSAFE_TIMEOUT_MS 750
+
+/**
+    \brief duree de chaque point de la courbe de descente des moteurs
+*/
+#define FAILSAFE_STEP_MS 200
+
+/**
+    \brief courbe de descente des moteurs quand le lien est perdu (255 = 100% de la derniere commande)
+*/
+static const uint8_t failsafe_curve[] = {192, 128, 64};
+
+/**
+    \brief variation maximale de l'impulsion du servomoteur a chaque periode de 20 ms, en us
+    (toute la course en environ 10 periodes)
+*/
+#define SERVO_MAX_STEP_US 100
+
+/**
+    \brief TRUE pour repartir chaque deplacement du servomoteur sur l'intervalle entre les
+    commandes (voir slew.h)
+*/
+#define SERVO_INTERPOLATE FALSE
+
+/**
+    \brief variation maximale du duty de la sustentation et de la propulsion a chaque periode de
+    20 ms, en montee et en descente (voir ramp.h)
+
+    0 a 255 en 160 ms pour la sustentation et en 220 ms pour la propulsion, qui tire le plus de
+    courant; la descente est plus rapide pour ne pas retarder une coupure
+*/
+#define LIFT_RAMP_ACCEL 32
+#define LIFT_RAMP_DECEL 64
+#define THRUST_RAMP_ACCEL 24
+#define THRUST_RAMP_DECEL 64
+
+/**
+    \brief le pilote reprend la main sur la courbe de depart au-dela de cette propulsion ou de cet
+    ecart de la direction
+*/
+#define LAUNCH_THRUST_DEADBAND 20
+#define LAUNCH_STEERING_DEADBAND 30
+
+/**
+    \brief courbes de depart du drag (voir launch.h): heure (ms), sustentation, propulsion,
+    correction du servomoteur (us)
+
+    la sustentation monte seule pendant 300 ms pour gonfler la jupe, puis la poussee arrive d'un
+    coup (aussi vite que le permet THRUST_RAMP_ACCEL) ou en rampe d'une seconde
+*/
+static const launch_point_t launch_hard[] PROGMEM =
+{
+    {0, 255, 0, 0}, {300, 255, 0, 0}, {320, 255, 255, 0}, {8000, 255, 255, 0}
+};
+
+static const launch_point_t launch_ramp[] PROGMEM =
+{
+    {0, 255, 0, 0}, {300, 255, 0, 0}, {1300, 255, 255, 0}, {8000, 255, 255, 0}
+};
+
+static const launch_curve_t launch_curves[] =
+{
+    {launch_hard, sizeof(launch_hard) / sizeof(launch_point_t)},
+    {launch_ramp, sizeof(launch_ramp) / sizeof(launch_point_t)}
+};
+
+/**
+    \brief profils de conduite, dans l'ordre de profile_enum
+*/
+static const profile_t profiles[PROFILE_NB] PROGMEM =
+{
+    // droite (us), gauche (us), poussee maximale, une trame de statut toutes les N commandes
+    {400, 440, 255, 1},     // PROFILE_RACE
+    {100, 150, 255, 1}      // PROFILE_DRAG
+};
+
+/**
+    \brief reglages utilises tant que l'EEPROM ne contient pas de configuration valide (voir config.h)
+
+    les debattements et la telemetrie sont remplaces par ceux de AERO_PROFILE au premier demarrage
+*/
+static const config_t config_defaults PROGMEM =
+{
+    {CENTER, 0, 0, BATTERY_OFFSET, BATTERY_SPAN, OSCCAL_OFFSET, THROTTLE_CURVE, 1, AERO_PROFILE},
+    {WIFI_SSID, WIFI_PASSWORD}
+};
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+/**
+    \brief ecrit une duree dans une trame, octet de poids faible en premier
+    \param[out] data les 2 octets de destination
+    \param[in] us la duree, saturee a 65535 us (la premiere commande attend AT+CIPSEND)
+    \return void
+*/
+static void put_duration(uint8_t* data, uint32_t us)
+{
+    if(us > 0xFFFF)
+    {
+        us = 0xFFFF;
+    }
+
+    data[0] = (uint8_t)(us & 0xFF);
+    data[1] = (uint8_t)(us >> 8);
+}
+
+/**
+    \brief applique la courbe de la propulsion, un melange de la droite et de la cubique
+    \param[in] thrust la commande, 0 a 255
+    \param[in] curve 0 = lineaire, 255 = cubique (plus de precision aux faibles poussees)
+    \return la propulsion a appliquer, 0 et 255 sont conserves
+*/
+static uint8_t throttle_curve(uint8_t thrust, uint8_t curve)
+{
+    uint32_t cubic = ((uint32_t)thrust * thrust * thrust) / (255UL * 255UL);
+
+    return (uint8_t)(((uint32_t)(255 - curve) * thrust + (uint32_t)curve * cubic) / 255UL);
+}
+
+/**
+    \brief appelee par param.c, interruptions masquees, pour chaque reglage change par la manette
+*/
+static void apply_parameter(config_value_enum key, uint16_t value)
+{
+    switch(key)
+    {
+        // la coupure du failsafe garde sa propre copie du centre
+        case CONFIG_SERVO_CENTER:
+            failsafe_set_servo_center(value);
+            profile_update();
+            break;
+
+        case CONFIG_SERVO_RIGHT:
+        case CONFIG_SERVO_LEFT:
+            profile_update();
+            break;
+
+        case CONFIG_PROFILE:
+            profile_select(value);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+
+/**
+    \brief logique de l'aeroglisseur
+    \param[in] argc nombre d'argument passer a la fonction
+    \param[in] argv tableau de string passer a la fonction
+    \return la valeur de fin
+
+    l'aeroglisseur utilise un autre protocole que celui decrit dans le cour de tch98, le protocole utilise
+    le principe de l'escape byte, l'escape byte decider par l'equipe est le 'A', ainsi "AB" -> debut de la communication,
+    "AC" -> fin de la communication, "AA" -> byte de donnee A, "AD" -> byte 0. les autres donnees sont envoyer en "raw byte"
+    Donc, une chaine transmit a l'aeroglisseur peut ressembler a "ABAAEF8AC". L'aeroglisseur et la manette agisse comme des
+    transmetteur/recepteur, le recepteur est la finite state machine et, a l'interrieur de la manette, le message est transmit
+    dans les temps ou rien est receptionner. Tandis qu'a l'interieur de l'aeroglisseur le message est transmit a la fin de la
+    reception d'un message (pour profiter du 50ms de la manette)
+*/
+int main(int argc, char** argv)
+{
+    uint8_t bat = 0;
+    uint8_t thrust;
+
+    // commandes appliquees depuis la derniere trame de statut
+    uint8_t nb_unreported = 0;
+
+    // egal TRUE si une trame de statut attend que le tick ait applique la commande
+    bool status_pending = FALSE;
+
+    // egal TRUE si la commande a donne des cibles que le tick n'a pas encore ecrites
+    bool apply_pending = FALSE;
+
+    // egal TRUE si une nouvelle commande est arrivee depuis le dernier tour de boucle
+    bool new_command = FALSE;
+
+    // egal TRUE si l'EEPROM contient une configuration valide
+    bool config_found;
+
+    // egal TRUE si tous les modules ont pu enregistrer leur tick aupres de la base de temps
+    bool ticks_registered;
+
+    // egal TRUE si la trace doit etre envoyee, des que le ESP est en mode transparent
+    bool trace_requested = FALSE;
+
+    // egal TRUE si la perte du lien est deja affichee
+    bool link_lost = FALSE;
+
+    // s'assure que AT+SEND est envoyer une seul fois
+    uint8_t config_wifi = 0;
+
+    // nombre de fois ou des bytes recus ont ete ecrases, renvoye dans le statut
+    uint8_t rx_overflows = 0;
+
+    // decodeur des trames, trame en reception et boite aux lettres contenant la derniere commande,
+    // les trames viennent de la reserve de packet.h et passent de l'une a l'autre par pointeur
+    frame_decoder_t decoder;
+    bool frame_complete;
+    frame_t* received;
+    frame_t* command = NULL;
+    frame_t* status;
+
+    // reponse aux reglages en attente du mode transparent du ESP, NULL s'il n'y en a pas
+    frame_t* reply = NULL;
+
+    // heures (time_micros) de reception, de decodage et d'application de la derniere commande,
+    // l'application est la premiere ecriture des registres par le tick (voir latency.h)
+    uint32_t rx_first = 0;
+    uint32_t rx_last = 0;
+    uint32_t decoded_at = 0;
+    uint32_t applied_at = 0;
+    uint32_t servo_applied_at;
+    uint32_t motors_applied_at;
+
+    // profondeur maximale de la pile, mesuree apres l'envoi du statut precedent
+    uint16_t stack_used = 0;
+
+    char transmit_data[FRAME_ENCODED_MAX_LENGTH];
+    char result[32];
+    char hor[4];
+    char ver[4];
+    char sus[4];
+    char bat_pourcentage[4];
+
+    failsafe_config_t failsafe_config = {
+        FAILSAFE_TIMEOUT_MS,
+        FAILSAFE_STEP_MS,
+        failsafe_curve,
+        sizeof(failsafe_curve),
+        CENTER
+    };
+
+    pwm_config_t pwm_config = {
+        PWM_TIMER_CONFIG(LIFT_PWM_MODE, LIFT_PWM_PRESCALER),
+        PWM_TIMER_CONFIG(THRUST_PWM_MODE, THRUST_PWM_PRESCALER)
+    };
+
+    ramp_config_t ramp_config = {
+        {
+            {LIFT_RAMP_ACCEL, LIFT_RAMP_DECEL},
+            {THRUST_RAMP_ACCEL, THRUST_RAMP_DECEL}
+        }
+    };
+
+    slew_config_t slew_config = {
+        SERVO_MAX_STEP_US,
+        SERVO_INTERPOLATE
+    };
+
+    launch_config_t launch_config = {
+        launch_curves,
+        sizeof(launch_curves) / sizeof(launch_curve_t),
+        LAUNCH_THRUST_DEADBAND,
+        LAUNCH_STEERING_DEADBAND
+    };
+
+    // pas d'arguments sur le microcontroleur, ils ne servent qu'au simulateur de host/mcu_sim.c
+    (void)argc;
+    (void)argv;
+
+    // les reglages de l'EEPROM remplacent les valeurs par defaut avant d'initialiser les composantes,
+    // ils contiennent deja le profil choisi et ses retouches
+    config_found = config_init(&config_defaults);
+    profile_init(profiles);
+
+    if(config_found == FALSE)
+    {
+        profile_select(AERO_PROFILE);
+    }
+
+    failsafe_config.servo_center = config_get(CONFIG_SERVO_CENTER);
+    param_init(apply_parameter);
+
+    sei();
+    lcd_init();
+    adc_init();
+    uart_init();
+    pwm_init(&pwm_config);
+    servo_init();
+    time_init();
+    trace_init();
+
+    //initialise les composante
+    servo_set_a(config_get(CONFIG_SERVO_CENTER));
+    pwm_set_a(0);
+    pwm_set_b(0);
+
+    // les ticks s'executent dans l'ordre de leur enregistrement (voir time.h)
+
+    // coupe les moteurs si la manette ne donne plus de nouvelles
+    ticks_registered = failsafe_init(&failsafe_config);
+
+    // joue les courbes de depart du drag dans l'interruption, apres le failsafe
+    ticks_registered &= launch_init(&launch_config);
+
+    // seul le tick ecrit OCR1A, apres le failsafe et la courbe de depart qui lui donnent leur cible
+    ticks_registered &= slew_init(&slew_config, config_get(CONFIG_SERVO_CENTER));
+
+    // seul le tick ecrit OCR0 et OCR2, pour la meme raison
+    ticks_registered &= ramp_init(&ramp_config);
+
+    // sans son tick, un module ne fait rien sans le signaler (pas de failsafe, servo fige): les
+    // moteurs restent coupes et l'aeroglisseur ne demarre pas
+    if(ticks_registered == FALSE)
+    {
+        lcd_clear_display();
+        lcd_write_string_P(PSTR("erreur: ticks"));
+
+        while(1)
+        {
+            hal_spin();
+        }
+    }
+
+    // initialise la chip wifi
+    OSCCAL = OSCCAL + (int8_t)config_get(CONFIG_OSCCAL_OFFSET);
+
+    lcd_write_string_P(PSTR("setup wifi..."));
+
+    DDRD = set_bit(DDRD, PD2);
+    PORTD = clear_bit(PORTD, PD2);
+    PORTD = set_bit(PORTD, PD2);
+
+    uart_put_string_P(PSTR("AT+CWMODE_DEF=3\r\n"));
+    _delay_ms(500);
+    uart_flush();
+    uart_put_string_P(PSTR("AT+CWSAP_DEF=\""));
+    uart_put_string((char*)config_get_string(CONFIG_WIFI_SSID));
+    uart_put_string_P(PSTR("\",\""));
+    uart_put_string((char*)config_get_string(CONFIG_WIFI_PASSWORD));
+    uart_put_string_P(PSTR("\",1,3\r\n"));
+    _delay_ms(500);
+    uart_flush();
+    uart_put_string_P(PSTR("AT+CIPMODE=1\r\n"));
+    _delay_ms(500);
+    uart_flush();
+    uart_put_string_P(PSTR("AT+CIPSTART=\"UDP\",\"0.0.0.0\",31337,1337\r\n"));
+    _delay_ms(500);
+    uart_flush();
+
+
+    lcd_clear_display();
+    lcd_write_string_P(PSTR("waiting for data"));
+
+
+
+    // seule la commande la plus recente est utile, les plus vieux bytes sont sacrifies en premier
+    frame_decoder_init(&decoder);
+    packet_init();
+    received = packet_alloc();
+    status = packet_alloc();
+    uart_set_rx_overflow_policy(UART_OVERFLOW_DROP_OLDEST);
+
+    while(1)
+    {
+        // au repos, la boucle ne fait qu'attendre les interruptions du UART et du timer 1 (voir hal.h)
+        hal_spin();
+
+        // vide le rx buffer, chaque trame complete ecrase la precedente dans la boite aux lettres
+        new_command = FALSE;
+        while(uart_is_rx_buffer_empty() == FALSE)
+        {
+            frame_complete = frame_decoder_push(&decoder, uart_get_byte(), received);
+
+            // des bytes ont ete ecrases avant ce byte, peut-etre pendant que le buffer se vidait:
+            // la trame en cours colle deux morceaux sans lien et n'est pas traitee, meme complete
+            if(uart_is_rx_overflowed() == TRUE)
+            {
+                frame_decoder_init(&decoder);
+                rx_overflows++;
+                continue;
+            }
+
+            // une trame vide ("ABAC") n'a pas de type, data[0] est encore celui de la trame
+            // precedente decodee dans le meme paquet
+            if(frame_complete == TRUE && received->length >= 1)
+            {
+                TRACE(TRACE_FRAME_RX, received->data[0]);
+
+                switch(received->data[0])
+                {
+                    // une commande contient au moins le type, hor, ver et sus
+                    case FRAME_TYPE_COMMAND:
+                        if(received->length >= 4)
+                        {
+                            // la trame recue devient la commande sans copie, l'ancienne est rendue
+                            packet_free(command);
+                            command = received;
+                            received = packet_alloc();
+                            new_command = TRUE;
+
+                            uart_get_rx_timestamps(&rx_first, &rx_last);
+                            decoded_at = time_micros();
+                        }
+                        break;
+
+                    case FRAME_TYPE_TRACE_REQUEST:
+                        trace_requested = TRUE;
+                        break;
+
+                    // les reglages changent entre deux commandes, la reponse est gardee dans la
+                    // trame libre de la reserve (voir packet.h) jusqu'a son envoi, une nouvelle
+                    // demande remplace la reponse qui n'est pas encore partie
+                    case FRAME_TYPE_PARAM_SET:
+                    case FRAME_TYPE_PARAM_GET:
+                        if(reply == NULL)
+                        {
+                            reply = packet_alloc();
+                        }
+
+                        if(reply != NULL)
+                        {
+                            param_handle(received, reply);
+                        }
+                        break;
+
+                    // le depart local n'existe qu'en configuration drag
+                    case FRAME_TYPE_LAUNCH:
+                        if(config_get(CONFIG_PROFILE) == PROFILE_DRAG)
+                        {
+                            launch_handle(received);
+                        }
+                        break;
+
+                    // les autres trames ne sont pas pour l'aeroglisseur
+                    default:
+                        break;
+                }
+            }
+        }
+
+        // avant AT+CIPSEND, le ESP prendrait la reponse pour une commande AT et la jetterait
+        if(reply != NULL && config_wifi == 1)
+        {
+            TRACE(TRACE_FRAME_TX, reply->data[0]);
+            frame_encode(transmit_data, reply->data, reply->length);
+            uart_put_string(transmit_data);
+            packet_free(reply);
+            reply = NULL;
+        }
+
+        // affiche la perte du lien une seule fois, les moteurs sont deja coupes par l'interruption
+        if(failsafe_is_tripped() == TRUE && !link_lost)
+        {
+            lcd_clear_display();
+            lcd_write_string_P(PSTR("link lost"));
+            link_lost = TRUE;
+        }
+
+        // applique seulement la commande la plus recente
+        if(new_command == TRUE)
+        {
+            TRACE(TRACE_FRAME_START, 0);
+
+            thrust = profile_get_thrust(throttle_curve(command->data[2], config_get(CONFIG_THROTTLE_CURVE)));
+            failsafe_feed(command->data[3], thrust);
+            link_lost = FALSE;
+
+            // afficher au lcd pour debugging
+            uint8_to_string(hor, command->data[1]);
+            uint8_to_string(ver, command->data[2]);
+            uint8_to_string(sus, command->data[3]);
+
+            result[0] = '\0';
+
+            string_concat_P(result, result, PSTR("H"));
+            string_concat(result, result, hor);
+            string_concat_P(result, result, PSTR("/V"));
+            string_concat(result, result, ver);
+            string_concat_P(result, result, PSTR("/S"));
+            string_concat(result, result, sus);
+            string_concat_P(result, result, PSTR("\r\n"));
+            string_concat_P(result, result, PSTR("A:"));
+            string_concat(result, result, bat_pourcentage);
+            string_concat_P(result, result, PSTR("%"));
+
+            if(launch_get_state() == LAUNCH_ARMED)
+            {
+                string_concat_P(result, result, PSTR(" arme"));
+            }
+            else if(launch_get_state() == LAUNCH_RUNNING)
+            {
+                string_concat_P(result, result, PSTR(" depart"));
+            }
+
+            // la courbe de depart garde les sorties tant que le pilote ne touche pas aux manettes
+            if(launch_feed(command->data[1], command->data[2]) == FALSE)
+            {
+                // equation de droite, precalculee pour chaque cote par profile.c, appliquee au
+                // prochain tick a la vitesse permise par slew.c
+                slew_set_target(profile_get_servo(command->data[1]));
+
+                // execute la logique du programme, au prochain tick a la vitesse permise par ramp.c
+                ramp_set_target(RAMP_THRUST, thrust);
+                ramp_set_target(RAMP_LIFT, command->data[3]);
+                apply_pending = TRUE;
+            }
+            else
+            {
+                // la courbe de depart garde les sorties, la commande n'ecrit aucun registre
+                apply_pending = FALSE;
+                applied_at = decoded_at;
+            }
+
+            TRACE(TRACE_LCD_FLUSH, 0);
+            lcd_clear_display();
+            lcd_write_string(result);
+            TRACE(TRACE_LCD_FLUSH, 1);
+
+            // transmet le pourcentage de la batterie
+            bat = ((adc_read(PA0)-(int16_t)config_get(CONFIG_BATTERY_OFFSET))*100)/(int16_t)config_get(CONFIG_BATTERY_SPAN);
+
+            // envoie AT+CIPSEND si pas encore envoyer
+            if(config_wifi == 0)
+            {
+                uart_put_string_P(PSTR("AT+CIPSEND\r\n"));
+                _delay_ms(500);
+                uart_flush();
+                config_wifi = 1;
+            }
+
+            uint8_to_string(bat_pourcentage, bat);
+
+            // une trame de statut toutes les CONFIG_TELEMETRY_DIVIDER commandes
+            nb_unreported++;
+
+            if(nb_unreported >= config_get(CONFIG_TELEMETRY_DIVIDER))
+            {
+                nb_unreported = 0;
+                status_pending = TRUE;
+            }
+
+            TRACE(TRACE_FRAME_END, 0);
+        }
+
+        // les cibles sont ecrites dans OCR1A, OCR0 et OCR2 au tick suivant la commande, au plus
+        // 20 ms plus tard; slew et ramp s'executent au meme tick, la derniere ecriture compte
+        if(apply_pending == TRUE && slew_get_applied_at(&servo_applied_at) == TRUE &&
+           ramp_get_applied_at(&motors_applied_at) == TRUE)
+        {
+            apply_pending = FALSE;
+            applied_at = ((int32_t)(motors_applied_at - servo_applied_at) > 0) ? motors_applied_at : servo_applied_at;
+        }
+
+        // le statut attend l'ecriture des registres pour que APPLY la mesure
+        if(status_pending == TRUE && apply_pending == FALSE && config_wifi == 1)
+        {
+            status_pending = FALSE;
+
+            status->data[0] = FRAME_TYPE_STATUS;
+            status->data[1] = bat;
+            status->data[2] = failsafe_get_trip_count();
+
+            // renvoie la sequence de la commande et les durees mesurees ici (voir latency.h)
+            status->data[3] = (command->length >= 5) ? command->data[4] : 0;
+            put_duration(&status->data[4], rx_last - rx_first);
+            put_duration(&status->data[6], decoded_at - rx_last);
+            put_duration(&status->data[8], applied_at - decoded_at);
+            put_duration(&status->data[10], time_micros() - rx_first);
+            status->data[12] = rx_overflows;
+            status->data[13] = (uint8_t)(stack_used & 0xFF);
+            status->data[14] = (uint8_t)(stack_used >> 8);
+            status->data[15] = ramp_get_saturation();
+            status->length = 16;
+            TRACE(TRACE_FRAME_TX, FRAME_TYPE_STATUS);
+            frame_encode(transmit_data, status->data, status->length);
+            uart_put_string(transmit_data);
+
+            // le parcours de la RAM libre se fait pendant que le statut part sur la ligne
+            stack_used = stack_get_max_used();
+        }
+
+        // envoie la trace seulement apres la commande pour ne pas retarder celle-ci, et seulement
+        // une fois le ESP en mode transparent (AT+CIPSEND envoye avec la premiere commande)
+        if(trace_requested == TRUE && config_wifi == 1)
+        {
+            trace_dump();
+            trace_requested = FALSE;
+        }
+    }
+}
@@ -0,0 +1,271 @@
+/**
+	\file bench.c
+	\brief mesure le nombre de cycles des fonctions critiques sur l'ATmega32
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: make bench
+
+    Le programme compte les cycles avec le timer 1 sans facteur de division (1 tic = 1 cycle),
+    en soustrayant le cout de la lecture de TCNT1. Chaque fonction est appelee BENCH_NB_RUNS fois
+    avec des arguments differents (frame_decoder_push une fois par byte de la trame), les
+    interruptions masquees, puis une ligne par fonction est envoyee au UART:
+
+        BENCH <fonction> <min> <moyenne> <max>
+
+    Sous simavr, le programme s'arrete en dormant avec les interruptions masquees apres la
+    ligne BENCH_END. Le meme programme peut etre programme dans la carte et lu au port serie.
+
+    Les interruptions sont appelees comme des fonctions: le compte inclut le prologue, l'epilogue
+    et le reti, mais pas les 4 cycles de reponse a l'interruption ni le jmp de la table des
+    vecteurs.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+#include <avr/sleep.h>
+
+#include "utils.h"
+#include "util_29.h"
+#include "fifo.h"
+#include "frame.h"
+#include "uart.h"
+#include "lcd.h"
+#include "time.h"
+#include "trace.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief nombre d'appels mesures par fonction
+*/
+#define BENCH_NB_RUNS 16
+
+/**
+    \brief mesure le nombre de cycles d'une instruction, les interruptions masquees, puis remet
+    SREG comme il etait
+*/
+#define MEASURE(result, statement)              \
+    do                                          \
+    {                                           \
+        uint16_t start_;                        \
+        uint8_t sreg_;                          \
+        sreg_ = SREG;                           \
+        cli();                                  \
+        start_ = TCNT1;                         \
+        statement;                              \
+        (result) = TCNT1 - start_ - overhead;   \
+        SREG = sreg_;                           \
+    }while(0)
+
+/**
+    \brief resultat d'une fonction
+*/
+typedef struct
+{
+    const char* name;
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint16_t count;
+}bench_result_t;
+
+typedef enum
+{
+    BENCH_FIFO_PUSH,
+    BENCH_FIFO_POP,
+    BENCH_UINT8_TO_STRING,
+    BENCH_STRING_CONCAT,
+    BENCH_HD44780_WRITE_CHAR,
+    BENCH_FRAME_DECODER_PUSH,
+    BENCH_FRAME_DECODE_COMMAND,
+    BENCH_FRAME_ENCODE,
+    BENCH_TIME_MICROS,
+    BENCH_TRACE_RECORD,
+    BENCH_USART_RXC_VECT,
+    BENCH_USART_UDRE_VECT,
+    BENCH_NB_FUNCTIONS
+}bench_function_enum;
+
+// les interruptions sont appelees directement
+void USART_RXC_vect(void);
+void USART_UDRE_vect(void);
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static bench_result_t results[BENCH_NB_FUNCTIONS] = {
+    {"fifo_push"},
+    {"fifo_pop"},
+    {"uint8_to_string"},
+    {"string_concat"},
+    {"hd44780_write_char"},
+    {"frame_decoder_push"},
+    {"frame_decode_command"},
+    {"frame_encode"},
+    {"time_micros"},
+    {"trace_record"},
+    {"USART_RXC_vect"},
+    {"USART_UDRE_vect"}
+};
+
+// cout de deux lectures consecutives de TCNT1
+static uint16_t overhead;
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static void add_result(bench_function_enum function, uint16_t cycles)
+{
+    bench_result_t* result = &results[function];
+
+    if(result->count == 0 || cycles < result->min)
+    {
+        result->min = cycles;
+    }
+
+    if(cycles > result->max)
+    {
+        result->max = cycles;
+    }
+
+    result->sum += cycles;
+    result->count++;
+}
+
+static void print_results(void)
+{
+    uint8_t i;
+    char line[48];
+
+    for(i = 0; i < BENCH_NB_FUNCTIONS; i++)
+    {
+        memory_set(line, 0, sizeof(line));
+
+        // le UART de simavr n'affiche une ligne qu'au '\n'
+        string_concat(line, line, "BENCH ");
+        string_concat(line, line, (char*)results[i].name);
+        string_concat(line, line, " ");
+        uint16_to_string(&line[string_length(line)], results[i].min);
+        string_concat(line, line, " ");
+        uint16_to_string(&line[string_length(line)], results[i].sum / results[i].count);
+        string_concat(line, line, " ");
+        uint16_to_string(&line[string_length(line)], results[i].max);
+        string_concat(line, line, "\n");
+
+        uart_put_string(line);
+        uart_flush();
+    }
+
+    uart_put_string("BENCH_END\n");
+    uart_flush();
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(void)
+{
+    uint8_t i;
+    uint8_t j;
+    uint16_t cycles;
+    uint8_t ucsrb;
+
+    fifo_t fifo;
+    uint8_t fifo_buffer[32];
+    char string[32];
+    char encoded[FRAME_ENCODED_MAX_LENGTH];
+    uint8_t encoded_length;
+    uint8_t command[] = {FRAME_TYPE_COMMAND, 128, 'A', 0, 0};
+    frame_decoder_t decoder;
+    frame_t frame;
+
+    lcd_init();
+    uart_init();
+    trace_init();
+    sei();
+
+    // timer 1 en mode normal sans facteur de division: TCNT1 compte les cycles
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+    TIMSK = clear_bit(TIMSK, TOIE1);
+
+    MEASURE(overhead, );
+
+    fifo_init(&fifo, fifo_buffer, sizeof(fifo_buffer));
+    frame_decoder_init(&decoder);
+
+    for(i = 0; i < BENCH_NB_RUNS; i++)
+    {
+        MEASURE(cycles, fifo_push(&fifo, i));
+        add_result(BENCH_FIFO_PUSH, cycles);
+
+        MEASURE(cycles, fifo_pop(&fifo));
+        add_result(BENCH_FIFO_POP, cycles);
+
+        MEASURE(cycles, uint8_to_string(string, i * 17));
+        add_result(BENCH_UINT8_TO_STRING, cycles);
+
+        // construction typique de l'affichage de l'aeroglisseur
+        string[0] = '\0';
+        string_concat(string, string, "H123");
+        MEASURE(cycles, string_concat(string, string, "/V045"));
+        add_result(BENCH_STRING_CONCAT, cycles);
+
+        MEASURE(cycles, hd44780_write_char('0' + i));
+        add_result(BENCH_HD44780_WRITE_CHAR, cycles);
+
+        command[4] = i;
+        MEASURE(cycles, encoded_length = frame_encode(encoded, command, sizeof(command)));
+        add_result(BENCH_FRAME_ENCODE, cycles);
+
+        // par byte, puis pour une trame de commande complete
+        for(j = 0; j < encoded_length; j++)
+        {
+            MEASURE(cycles, frame_decoder_push(&decoder, encoded[j], &frame));
+            add_result(BENCH_FRAME_DECODER_PUSH, cycles);
+        }
+
+        MEASURE(cycles,
+            for(j = 0; j < encoded_length; j++)
+            {
+                frame_decoder_push(&decoder, encoded[j], &frame);
+            }
+        );
+        add_result(BENCH_FRAME_DECODE_COMMAND, cycles);
+
+        MEASURE(cycles, time_micros());
+        add_result(BENCH_TIME_MICROS, cycles);
+
+        MEASURE(cycles, trace_record(TRACE_ISR_RX, i));
+        add_result(BENCH_TRACE_RECORD, cycles);
+
+        // les vraies interruptions du UART ne doivent pas s'executer pendant la mesure
+        ucsrb = UCSRB;
+        UCSRB = (1 << RXEN) | (1 << TXEN);
+
+        MEASURE(cycles, USART_RXC_vect());
+        add_result(BENCH_USART_RXC_VECT, cycles);
+        uart_clean_rx_buffer();
+
+        uart_put_byte('0' + i);
+        UCSRB = (1 << RXEN) | (1 << TXEN);
+        MEASURE(cycles, USART_UDRE_vect());
+        add_result(BENCH_USART_UDRE_VECT, cycles);
+
+        UCSRB = ucsrb;
+        uart_flush();
+    }
+
+    print_results();
+
+    // simavr s'arrete quand le processeur dort avec les interruptions masquees
+    cli();
+    sleep_mode();
+
+    while(1);
+}
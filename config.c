@@ -0,0 +1,292 @@
+/**
+	\file config.c
+	\brief parametres de reglage conserves dans l'EEPROM, avec une copie en RAM
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "config.h"
+#include "profile.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+// position des champs dans un emplacement
+#define VERSION_OFFSET 0
+#define SEQUENCE_OFFSET 1
+#define CONFIG_OFFSET 3
+#define CRC_OFFSET (CONFIG_OFFSET + sizeof(config_t))
+#define RECORD_SIZE (CRC_OFFSET + 2)
+
+// limites des reglages numeriques, dans l'ordre de config_value_enum
+static const int16_t limits[CONFIG_NB_VALUES][2] PROGMEM =
+{
+    {1000, 2000},       // CONFIG_SERVO_CENTER
+    {0, 500},           // CONFIG_SERVO_RIGHT
+    {0, 500},           // CONFIG_SERVO_LEFT
+    {0, 255},           // CONFIG_BATTERY_OFFSET
+    {1, 255},           // CONFIG_BATTERY_SPAN
+    {-128, 127},        // CONFIG_OSCCAL_OFFSET
+    {0, 255},           // CONFIG_THROTTLE_CURVE
+    {1, 50},            // CONFIG_TELEMETRY_DIVIDER
+    {0, PROFILE_NB - 1} // CONFIG_PROFILE
+};
+
+// un enregistrement doit tenir dans un emplacement, sinon la taille du tableau est negative
+typedef char record_fits_in_slot[(RECORD_SIZE <= CONFIG_SLOT_SIZE) ? 1 : -1];
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+// copie en RAM de la configuration
+static config_t cache;
+
+// emplacement et sequence de la configuration courante dans l'EEPROM
+static uint8_t current_slot;
+static uint16_t current_sequence;
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static uint8_t eeprom_read(uint16_t address);
+static void eeprom_write(uint16_t address, uint8_t byte);
+static uint16_t crc_update(uint16_t crc, uint8_t byte);
+static bool read_record(uint8_t slot, uint16_t* sequence, config_t* config);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+bool config_init(const config_t* defaults)
+{
+    uint8_t slot;
+    uint8_t i;
+    uint16_t sequence;
+    bool found = FALSE;
+
+    for(i = 0; i < sizeof(config_t); i++)
+    {
+        ((uint8_t*)&cache)[i] = pgm_read_byte((const uint8_t*)defaults + i);
+    }
+
+    current_slot = CONFIG_NB_SLOTS;
+    current_sequence = 0;
+
+    // le plus recent gagne, la sequence est comparee par difference pour passer 65535 -> 0
+    for(slot = 0; slot < CONFIG_NB_SLOTS; slot++)
+    {
+        if(read_record(slot, &sequence, NULL) == TRUE &&
+           (found == FALSE || (int16_t)(sequence - current_sequence) > 0))
+        {
+            current_slot = slot;
+            current_sequence = sequence;
+            found = TRUE;
+        }
+    }
+
+    if(found == TRUE)
+    {
+        read_record(current_slot, &sequence, &cache);
+    }
+
+    return found;
+}
+
+uint16_t config_get(config_value_enum key)
+{
+    return cache.values[key];
+}
+
+void config_set(config_value_enum key, uint16_t value)
+{
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    cache.values[key] = value;
+
+    SREG = sreg;
+}
+
+bool config_is_valid(config_value_enum key, uint16_t value)
+{
+    int16_t min;
+    int16_t max;
+
+    if(key >= CONFIG_NB_VALUES)
+    {
+        return FALSE;
+    }
+
+    min = (int16_t)pgm_read_word(&limits[key][0]);
+    max = (int16_t)pgm_read_word(&limits[key][1]);
+
+    return (int16_t)value >= min && (int16_t)value <= max;
+}
+
+const char* config_get_string(config_string_enum key)
+{
+    return cache.strings[key];
+}
+
+void config_set_string(config_string_enum key, const char* string)
+{
+    uint8_t i;
+
+    for(i = 0; i < CONFIG_STRING_LENGTH - 1 && string[i] != '\0'; i++)
+    {
+        cache.strings[key][i] = string[i];
+    }
+
+    // la fin de la chaine est mise a 0 pour que le CRC ne depende que du contenu
+    for(; i < CONFIG_STRING_LENGTH; i++)
+    {
+        cache.strings[key][i] = '\0';
+    }
+}
+
+void config_save(void)
+{
+    uint8_t slot;
+    uint16_t base;
+    uint16_t crc = 0xFFFF;
+    uint16_t sequence;
+    uint8_t i;
+
+    slot = (current_slot + 1 < CONFIG_NB_SLOTS) ? current_slot + 1 : 0;
+    sequence = current_sequence + 1;
+    base = (uint16_t)slot * CONFIG_SLOT_SIZE;
+
+    // l'ancien CRC est efface en premier: un enregistrement a moitie ecrit ne peut pas etre pris
+    // pour le plus recent
+    eeprom_write(base + CRC_OFFSET, ~eeprom_read(base + CRC_OFFSET));
+
+    eeprom_write(base + VERSION_OFFSET, CONFIG_VERSION);
+    eeprom_write(base + SEQUENCE_OFFSET, (uint8_t)(sequence & 0xFF));
+    eeprom_write(base + SEQUENCE_OFFSET + 1, (uint8_t)(sequence >> 8));
+
+    crc = crc_update(crc, CONFIG_VERSION);
+    crc = crc_update(crc, (uint8_t)(sequence & 0xFF));
+    crc = crc_update(crc, (uint8_t)(sequence >> 8));
+
+    for(i = 0; i < sizeof(config_t); i++)
+    {
+        eeprom_write(base + CONFIG_OFFSET + i, ((uint8_t*)&cache)[i]);
+        crc = crc_update(crc, ((uint8_t*)&cache)[i]);
+    }
+
+    eeprom_write(base + CRC_OFFSET, (uint8_t)(crc & 0xFF));
+    eeprom_write(base + CRC_OFFSET + 1, (uint8_t)(crc >> 8));
+
+    current_slot = slot;
+    current_sequence = sequence;
+}
+
+uint8_t config_get_slot(void)
+{
+    return current_slot;
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static uint8_t eeprom_read(uint16_t address)
+{
+    // une ecriture en cours bloque la lecture
+    while(read_bit(EECR, EEWE))
+    {
+    }
+
+    EEAR = address;
+    EECR = set_bit(EECR, EERE);
+
+    return EEDR;
+}
+
+/**
+    \brief ecrit un byte dans l'EEPROM s'il n'a pas deja cette valeur
+*/
+static void eeprom_write(uint16_t address, uint8_t byte)
+{
+    uint8_t sreg;
+
+    if(eeprom_read(address) == byte)
+    {
+        return;
+    }
+
+    EEDR = byte;
+
+    // EEWE doit suivre EEMWE de moins de 4 cycles
+    sreg = SREG;
+    cli();
+
+    EECR = set_bit(EECR, EEMWE);
+    EECR = set_bit(EECR, EEWE);
+
+    SREG = sreg;
+}
+
+/**
+    \brief CRC-16 CCITT (polynome 0x1021), comme _crc_ccitt_update de avr-libc mais non reflechi
+*/
+static uint16_t crc_update(uint16_t crc, uint8_t byte)
+{
+    uint8_t i;
+
+    crc ^= (uint16_t)byte << 8;
+
+    for(i = 0; i < 8; i++)
+    {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+
+    return crc;
+}
+
+/**
+    \brief lit et valide un enregistrement
+    \param[in] slot l'emplacement
+    \param[out] sequence la sequence de l'enregistrement
+    \param[out] config la configuration, ou NULL pour seulement valider
+    \return TRUE si la version et le CRC sont bons
+*/
+static bool read_record(uint8_t slot, uint16_t* sequence, config_t* config)
+{
+    uint16_t base = (uint16_t)slot * CONFIG_SLOT_SIZE;
+    uint16_t crc = 0xFFFF;
+    uint16_t i;
+    uint8_t byte;
+
+    if(eeprom_read(base + VERSION_OFFSET) != CONFIG_VERSION)
+    {
+        return FALSE;
+    }
+
+    for(i = VERSION_OFFSET; i < CRC_OFFSET; i++)
+    {
+        byte = eeprom_read(base + i);
+        crc = crc_update(crc, byte);
+
+        if(config != NULL && i >= CONFIG_OFFSET)
+        {
+            ((uint8_t*)config)[i - CONFIG_OFFSET] = byte;
+        }
+    }
+
+    if(eeprom_read(base + CRC_OFFSET) != (uint8_t)(crc & 0xFF) ||
+       eeprom_read(base + CRC_OFFSET + 1) != (uint8_t)(crc >> 8))
+    {
+        return FALSE;
+    }
+
+    *sequence = eeprom_read(base + SEQUENCE_OFFSET) | ((uint16_t)eeprom_read(base + SEQUENCE_OFFSET + 1) << 8);
+
+    return TRUE;
+}
@@ -0,0 +1,161 @@
+#ifndef CONFIG_H_INCLUDED
+#define CONFIG_H_INCLUDED
+
+/**
+	\file config.h
+	\brief parametres de reglage conserves dans l'EEPROM, avec une copie en RAM
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Les reglages (centre et limites du servomoteur, echelle de la batterie, correction de
+    l'oscillateur, courbe de la propulsion, cadence de la telemetrie, profil, identifiants wifi) ne
+    sont plus fixes a la compilation: chaque programme donne ses valeurs par defaut a config_init,
+    qui les remplace par la derniere configuration valide trouvee dans l'EEPROM. Les modules
+    lisent ensuite la copie en RAM avec config_get et config_get_string, sans toucher a l'EEPROM.
+
+    L'EEPROM de l'ATmega32 (1024 bytes, environ 100 000 ecritures par byte) est divisee en
+    CONFIG_NB_SLOTS emplacements de CONFIG_SLOT_SIZE bytes. Chaque config_save ecrit
+    l'enregistrement complet dans l'emplacement suivant, en tournant, ce qui repartit l'usure sur
+    toute l'EEPROM. Un enregistrement contient:
+
+        version (1) | sequence (2) | config_t | CRC-16 CCITT (2)
+
+    A l'initialisation, l'enregistrement retenu est celui dont la version est CONFIG_VERSION, dont
+    le CRC est bon et dont la sequence est la plus recente. Le CRC est ecrit en dernier: si
+    l'alimentation est coupee pendant config_save, l'enregistrement incomplet est rejete et le
+    precedent reste valide. Les bytes qui ont deja la bonne valeur ne sont pas reecrits.
+
+    Il faut changer CONFIG_VERSION quand config_t change, pour que les anciens enregistrements
+    soient ignores plutot que mal lus.
+
+    Une ecriture dans l'EEPROM prend environ 8.5 ms par byte: une premiere sauvegarde bloque
+    pendant environ une demi-seconde, une sauvegarde qui ne change qu'un reglage par rapport au
+    contenu de l'emplacement prend quelques dizaines de ms.
+
+    Sur PC, l'EEPROM est simulee par host/eeprom_sim.c.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief version de config_t, a incrementer quand la structure change
+*/
+#define CONFIG_VERSION 3
+
+/**
+    \brief taille de l'EEPROM de l'ATmega32
+*/
+#define CONFIG_EEPROM_SIZE 1024
+
+/**
+    \brief taille d'un emplacement, un enregistrement doit y tenir
+*/
+#define CONFIG_SLOT_SIZE 64
+
+#define CONFIG_NB_SLOTS (CONFIG_EEPROM_SIZE / CONFIG_SLOT_SIZE)
+
+/**
+    \brief longueur maximale d'une chaine, '\0' compris
+*/
+#define CONFIG_STRING_LENGTH 16
+
+/**
+    \brief reglages numeriques
+*/
+typedef enum
+{
+    CONFIG_SERVO_CENTER,        // valeur du servomoteur tout droit, en us
+    CONFIG_SERVO_RIGHT,         // debattement vers la droite, en us
+    CONFIG_SERVO_LEFT,          // debattement vers la gauche, en us
+    CONFIG_BATTERY_OFFSET,      // lecture de l'ADC a 0% de batterie
+    CONFIG_BATTERY_SPAN,        // ecart de lecture de l'ADC entre 0% et 100%
+    CONFIG_OSCCAL_OFFSET,       // correction ajoutee a OSCCAL, signee
+    CONFIG_THROTTLE_CURVE,      // courbe de la propulsion, 0 = lineaire, 255 = cubique
+    CONFIG_TELEMETRY_DIVIDER,   // une trame de statut toutes les N commandes appliquees
+    CONFIG_PROFILE,             // profil de conduite de l'aeroglisseur, voir profile.h
+    CONFIG_NB_VALUES
+}config_value_enum;
+
+/**
+    \brief reglages en chaine de caracteres
+*/
+typedef enum
+{
+    CONFIG_WIFI_SSID,
+    CONFIG_WIFI_PASSWORD,
+    CONFIG_NB_STRINGS
+}config_string_enum;
+
+/**
+    \brief tous les reglages, tels qu'ils sont conserves dans l'EEPROM
+*/
+typedef struct
+{
+    uint16_t values[CONFIG_NB_VALUES];
+    char strings[CONFIG_NB_STRINGS][CONFIG_STRING_LENGTH];
+}config_t;
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief charge la configuration la plus recente de l'EEPROM dans la RAM
+    \param[in] defaults les valeurs par defaut du programme, en flash (PROGMEM)
+    \return TRUE si une configuration valide a ete trouvee dans l'EEPROM, FALSE si les valeurs
+    par defaut sont utilisees
+*/
+bool config_init(const config_t* defaults);
+
+/**
+    \brief lit un reglage numerique dans la copie en RAM
+*/
+uint16_t config_get(config_value_enum key);
+
+/**
+    \brief change un reglage numerique dans la copie en RAM, config_save le conserve
+
+    l'ecriture est atomique: une interruption ne peut pas lire une valeur a moitie ecrite
+*/
+void config_set(config_value_enum key, uint16_t value);
+
+/**
+    \brief verifie qu'une valeur est dans les limites d'un reglage numerique
+    \return TRUE si config_set peut l'accepter sans danger
+
+    les limites sont comparees en signe (CONFIG_OSCCAL_OFFSET peut etre negatif)
+*/
+bool config_is_valid(config_value_enum key, uint16_t value);
+
+/**
+    \brief lit un reglage en chaine de caracteres dans la copie en RAM
+*/
+const char* config_get_string(config_string_enum key);
+
+/**
+    \brief change un reglage en chaine de caracteres dans la copie en RAM, tronque a
+    CONFIG_STRING_LENGTH - 1 caracteres
+*/
+void config_set_string(config_string_enum key, const char* string);
+
+/**
+    \brief ecrit la copie en RAM dans l'emplacement suivant de l'EEPROM
+    \return void
+
+    bloque pendant l'ecriture (environ 8.5 ms par byte modifie)
+*/
+void config_save(void);
+
+/**
+    \brief emplacement de l'EEPROM de la configuration courante
+    \return l'emplacement, ou CONFIG_NB_SLOTS si rien n'a encore ete ecrit
+*/
+uint8_t config_get_slot(void);
+
+#endif
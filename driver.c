@@ -11,11 +11,19 @@
 Includes
 ******************************************************************************/
 
-#include <avr/io.h>
+#include "hal.h"
 #include <math.h>
 #include "driver.h"
-
-
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static uint8_t pwm_timer0_bits(const pwm_timer_config_t* config);
+static uint8_t pwm_timer2_bits(const pwm_timer_config_t* config);
+
+
 /******************************************************************************
 Definitions des fonctions
 ******************************************************************************/
@@ -104,34 +112,18 @@ void servo_set_a(uint16_t servo_value)
     OCR1A = servo_value;
 }
 
-void pwm_init(){
+void pwm_init(const pwm_config_t* config){
 
 	// Configuration des broches de sortie (met PB4 en entree, particularite du circuit)
     DDRB = clear_bit(DDRB, PB4);
     DDRB = set_bit(DDRB, PB3);
 
-    // Configuration du compteur et du comparateur
-    //uint8_t conf = WGM00 | WGM01;
-    //uint8_t start = CS01 | CS00;
-    TCCR0 = set_bit(TCCR0, WGM00);
-    TCCR0 = set_bit(TCCR0, WGM01);
-    //TCCR0 = set_bits(TCCR0, conf);
-    //TCCR0 = clear_bits(TCCR0, ~conf & 0b01001000);
-	// Demarrer le compteur et fixer un facteur de division de frequence a 1024
-    TCCR0 = set_bit(TCCR0, CS00);
-    TCCR0 = set_bit(TCCR0, CS02);
-    TCCR0 = clear_bit(TCCR0, CS01);
-    //TCCR0 = clear_bits(TCCR0, ~start & 0b00000011);
+	// Configuration du compteur et demarrage, le comparateur reste deconnecte jusqu'a pwm_set_a
+    TCCR0 = pwm_timer0_bits(&config->a);
 
     DDRD = set_bit(DDRD, PD7);
 
-    TCCR2 = set_bit(TCCR2, WGM20);
-    TCCR2 = set_bit(TCCR2, WGM21);
-
-    TCCR2 = set_bit(TCCR2, CS20);
-    TCCR2 = set_bit(TCCR2, CS22);
-    TCCR2 = set_bit(TCCR2, CS21);
-
+    TCCR2 = pwm_timer2_bits(&config->b);
 }
 
 void pwm_set_a(uint8_t duty){
@@ -139,7 +131,7 @@ void pwm_set_a(uint8_t duty){
 	// Pour avoir un duty de 0, il faut eteindre le PWM et directement piloter la sortie e 0
 	if(duty == 0){
 
-		//Mettre 0 dans la broche PD7 (OC2) du port
+		//Mettre 0 dans la broche PB3 (OC0) du port
 		PORTB = clear_bit(PORTB, PB3);
 
 		//Desactive le comparateur
@@ -160,7 +152,7 @@ void pwm_set_b(uint8_t duty){
 	// Pour avoir un duty de 0, il faut eteindre le PWM et directement piloter la sortie e 0
 	if(duty == 0){
 
-		//Mettre 0 dans la broche PB3 (OC0) du port
+		//Mettre 0 dans la broche PD7 (OC2) du port
 		PORTD = clear_bit(PORTD, PD7);
 
 		//Desactive le comparateur
@@ -173,4 +165,48 @@ void pwm_set_b(uint8_t duty){
 		//Active le comparateur
 		TCCR2 = set_bit(TCCR2, COM21);
 	}
-}
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/**
+	\brief Valeur de TCCR0 (mode et facteur de division) pour une configuration, 0 = timer arrete
+*/
+static uint8_t pwm_timer0_bits(const pwm_timer_config_t* config){
+
+	uint8_t bits;
+
+	// Le fast PWM compte de 0 a 255, le phase correct monte et redescend
+	bits = (config->mode == PWM_MODE_FAST) ? (1 << WGM00) | (1 << WGM01) : (1 << WGM00);
+
+	switch(config->prescaler){
+
+		case 1:  return bits | (1 << CS00);
+		case 8:  return bits | (1 << CS01);
+		case 64: return bits | (1 << CS01) | (1 << CS00);
+		default: return 0;
+	}
+}
+
+/**
+	\brief Valeur de TCCR2 (mode et facteur de division) pour une configuration, 0 = timer arrete
+
+	Les bits CS2x du timer 2 n'ont pas le meme sens que ceux du timer 0 (il a aussi /32 et /128)
+*/
+static uint8_t pwm_timer2_bits(const pwm_timer_config_t* config){
+
+	uint8_t bits;
+
+	bits = (config->mode == PWM_MODE_FAST) ? (1 << WGM20) | (1 << WGM21) : (1 << WGM20);
+
+	switch(config->prescaler){
+
+		case 1:  return bits | (1 << CS20);
+		case 8:  return bits | (1 << CS21);
+		case 64: return bits | (1 << CS22);
+		default: return 0;
+	}
+}
@@ -30,8 +30,76 @@
 Includes
 ---------------------------------------------------------------------------- */
 
-#include "utils.h"
-
+#include "utils.h"
+
+/* ----------------------------------------------------------------------------
+Defines
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Mode d'un timer de PWM
+*/
+typedef enum
+{
+	PWM_MODE_FAST,				// monte de 0 a 255, frequence F_CPU / (prescaler * 256)
+	PWM_MODE_PHASE_CORRECT		// monte et descend, frequence F_CPU / (prescaler * 510), symetrique
+}pwm_mode_enum;
+
+/**
+    \brief Configuration d'un timer de PWM
+
+	A construire avec PWM_TIMER_CONFIG pour que la configuration soit validee a la compilation.
+*/
+typedef struct
+{
+	pwm_mode_enum mode;
+	uint8_t prescaler;			// facteur de division de l'horloge: 1, 8 ou 64
+}pwm_timer_config_t;
+
+/**
+    \brief Configuration des deux PWM
+*/
+typedef struct
+{
+	pwm_timer_config_t a;		// timer 0, PWM A
+	pwm_timer_config_t b;		// timer 2, PWM B
+}pwm_config_t;
+
+/**
+    \brief Vrai si le facteur de division est accepte par pwm_init (les deux timers l'ont)
+*/
+#define PWM_PRESCALER_IS_VALID(prescaler) ((prescaler) == 1 || (prescaler) == 8 || (prescaler) == 64)
+
+/**
+    \brief Vrai si le mode est un pwm_mode_enum
+*/
+#define PWM_MODE_IS_VALID(mode) ((mode) == PWM_MODE_FAST || (mode) == PWM_MODE_PHASE_CORRECT)
+
+/**
+    \brief Frequence du PWM en Hz pour un mode et un facteur de division
+
+	A 8 MHz: 31250, 3906 et 488 Hz en fast PWM, 15686, 1960 et 245 Hz en phase correct.
+*/
+#define PWM_FREQUENCY_HZ(mode, prescaler) \
+	(F_CPU / ((uint32_t)(prescaler) * ((mode) == PWM_MODE_FAST ? 256UL : 510UL)))
+
+/**
+    \brief Initialiseur d'un pwm_timer_config_t qui ne compile pas si le mode ou le facteur de
+	division n'est pas valide
+
+	Par exemple, fast PWM sur le timer 0 et phase correct sur le timer 2:
+
+		pwm_config_t config = {PWM_TIMER_CONFIG(PWM_MODE_FAST, 1), PWM_TIMER_CONFIG(PWM_MODE_PHASE_CORRECT, 8)};
+
+	Un facteur de division de 1024 (l'ancien reglage, environ 30 Hz) donne une erreur de compilation
+	(tableau de taille negative).
+*/
+#define PWM_TIMER_CONFIG(mode, prescaler) \
+	{ \
+		(mode) + 0 * sizeof(char[PWM_MODE_IS_VALID(mode) ? 1 : -1]), \
+		(prescaler) + 0 * sizeof(char[PWM_PRESCALER_IS_VALID(prescaler) ? 1 : -1]) \
+	}
+
 /* ----------------------------------------------------------------------------
 Prototypes
 ---------------------------------------------------------------------------- */
@@ -132,10 +200,12 @@ void servo_set_a(uint16_t servo_value);
 
 /**
     \brief Initialise les modules de PWM
-    \param init_a Si == TRUE, le PWM A est initialisé
-    \param init_b Si == TRUE, le PWM B est initialisé
+    \param[in]	config Le mode et le facteur de division de chaque timer (voir PWM_TIMER_CONFIG)
     \return rien.
 
+	Les sorties restent a 0 jusqu'au premier pwm_set_a / pwm_set_b non nul. Un facteur de division
+	refuse (configuration construite sans PWM_TIMER_CONFIG) laisse le timer arrete.
+
 	Le PWM A correspond au timer 0. Le timer 0 utilise la broche PB3 du microcontrôleur
 	ce qui correspond à la broche 4 du DIP. Le PWM B correspond au timer 2. Le timer 2
 	utilise la broche PD7 du microcontrôleur ce qui correspond à la broche 21 du DIP.
@@ -163,7 +233,7 @@ void servo_set_a(uint16_t servo_value);
 			  --| 20   21 |-- PWM B
 			    +---------+
 */
-void pwm_init();
+void pwm_init(const pwm_config_t* config);
 
 /**
     \brief Applique un PWM à la sortie PWM A (broche 4 du DIP)
@@ -171,8 +241,10 @@ void pwm_init();
     \return rien.
 
 	Un duty (rapport cyclique) de 0 correspond à un PWM de 0% et un duty de 255 correspond à un
-	PWM de 100%. Cette relation est linéaire sur toute l'intervalle.
-*/
+	PWM de 100%. Cette relation est linéaire sur toute l'intervalle: (duty + 1) / 256 en fast PWM
+	et duty / 255 en phase correct. Le duty de 0 deconnecte la sortie du comparateur et force la
+	broche a 0, sinon le fast PWM donnerait encore une impulsion d'un cycle par periode.
+*/
 void pwm_set_a(uint8_t duty);
 
 /**
@@ -181,8 +253,10 @@ void pwm_set_a(uint8_t duty);
     \return rien.
 
 	Un duty (rapport cyclique) de 0 correspond à un PWM de 0% et un duty de 255 correspond à un
-	PWM de 100%. Cette relation est linéaire sur toute l'intervalle.
-*/
+	PWM de 100%. Cette relation est linéaire sur toute l'intervalle: (duty + 1) / 256 en fast PWM
+	et duty / 255 en phase correct. Le duty de 0 deconnecte la sortie du comparateur et force la
+	broche a 0, sinon le fast PWM donnerait encore une impulsion d'un cycle par periode.
+*/
 void pwm_set_b(uint8_t duty);
 
 #endif /* DRIVER_H_INCLUDED */
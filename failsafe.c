@@ -0,0 +1,161 @@
+/**
+	\file failsafe.c
+	\brief coupe les moteurs de l'aeroglisseur quand la manette ne donne plus de nouvelles
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "failsafe.h"
+#include "driver.h"
+#include "ramp.h"
+#include "slew.h"
+#include "time.h"
+#include "trace.h"
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static failsafe_config_t failsafe_config;
+
+// age de la derniere commande en ms
+static volatile uint16_t command_age;
+
+// derniere commande recue
+static volatile uint8_t last_lift;
+static volatile uint8_t last_thrust;
+
+static volatile bool armed;
+static volatile bool tripped;
+static volatile uint8_t trip_count;
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static void failsafe_tick(void);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+bool failsafe_init(const failsafe_config_t* config)
+{
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    failsafe_config = *config;
+
+    // un pas nul ferait une division par 0 dans l'interruption
+    if(failsafe_config.step_ms == 0)
+    {
+        failsafe_config.step_ms = FAILSAFE_TICK_MS;
+    }
+
+    command_age = 0;
+    last_lift = 0;
+    last_thrust = 0;
+    armed = FALSE;
+    tripped = FALSE;
+    trip_count = 0;
+
+    SREG = sreg;
+
+    return time_add_tick_callback(failsafe_tick);
+}
+
+void failsafe_feed(uint8_t lift, uint8_t thrust)
+{
+    uint8_t sreg;
+
+    // l'interruption ne doit pas voir une commande a moitie mise a jour
+    sreg = SREG;
+    cli();
+
+    command_age = 0;
+    last_lift = lift;
+    last_thrust = thrust;
+    armed = TRUE;
+    tripped = FALSE;
+
+    SREG = sreg;
+}
+
+void failsafe_set_servo_center(uint16_t servo_center)
+{
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    failsafe_config.servo_center = servo_center;
+
+    SREG = sreg;
+}
+
+bool failsafe_is_tripped(void)
+{
+    return tripped;
+}
+
+bool failsafe_is_armed(void)
+{
+    return (armed && !tripped) ? TRUE : FALSE;
+}
+
+uint8_t failsafe_get_trip_count(void)
+{
+    return trip_count;
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+/**
+    \brief appelee a chaque fin de periode du timer 1, aux 20 ms, dans l'interruption
+*/
+static void failsafe_tick(void)
+{
+    uint16_t step;
+    uint8_t scale;
+
+    if(armed)
+    {
+        // l'age sature au lieu de revenir a 0
+        if(command_age <= 0xFFFF - FAILSAFE_TICK_MS)
+        {
+            command_age += FAILSAFE_TICK_MS;
+        }
+
+        if(command_age >= failsafe_config.timeout_ms)
+        {
+            if(!tripped)
+            {
+                tripped = TRUE;
+                trip_count++;
+                TRACE(TRACE_FAILSAFE, trip_count);
+                slew_set_target(failsafe_config.servo_center);
+            }
+
+            // trouve le point de la courbe correspondant au temps ecoule depuis la coupure
+            step = (command_age - failsafe_config.timeout_ms) / failsafe_config.step_ms;
+
+            if(step < failsafe_config.curve_length)
+            {
+                scale = failsafe_config.curve[step];
+            }
+            else
+            {
+                scale = 0;
+            }
+
+            ramp_set_target(RAMP_LIFT, ((uint16_t)last_lift * scale) / 255);
+            ramp_set_target(RAMP_THRUST, ((uint16_t)last_thrust * scale) / 255);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef FAILSAFE_H_INCLUDED
+#define FAILSAFE_H_INCLUDED
+
+/**
+	\file failsafe.h
+	\brief coupe les moteurs de l'aeroglisseur quand la manette ne donne plus de nouvelles
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Le module mesure l'age de la derniere commande valide a l'aide du tick de la base de temps
+    (l'interruption de fin de periode du timer 1, aux 20 ms, voir time.h). Comme la mesure et la
+    coupure sont faites dans l'interruption, la protection fonctionne meme si la boucle principale
+    est bloquee.
+
+    Quand l'age depasse timeout_ms, le servomoteur est centre et la sustentation (PWM A) et la
+    propulsion (PWM B) descendent en suivant la courbe de la configuration. Chaque point de la courbe
+    est applique pendant step_ms et represente une fraction de la derniere commande (255 = 100%).
+    Apres le dernier point, les moteurs sont a 0.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief periode du tick de la base de temps en ms
+*/
+#define FAILSAFE_TICK_MS 20
+
+/**
+    \brief configuration de la protection
+*/
+typedef struct
+{
+    // temps sans commande valide avant de couper les moteurs
+    uint16_t timeout_ms;
+
+    // duree de chaque point de la courbe de descente
+    uint16_t step_ms;
+
+    // courbe de descente, 255 = 100% de la derniere commande
+    const uint8_t* curve;
+    uint8_t curve_length;
+
+    // valeur du servomoteur lorsque l'aeroglisseur va tout droit
+    uint16_t servo_center;
+}failsafe_config_t;
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief initialise la protection et l'enregistre aupres de la base de temps
+    \param[in] config la configuration, copiee par le module
+    \return TRUE si le tick a ete enregistre, FALSE si la base de temps n'a plus de place
+    (TIME_NB_TICK_CALLBACKS): le module ne ferait alors rien
+
+    time_init doit avoir ete appele pour que le tick tourne. La protection n'est armee qu'a la
+    reception de la premiere commande.
+*/
+bool failsafe_init(const failsafe_config_t* config);
+
+/**
+    \brief indique au module qu'une commande valide vient d'etre recue
+    \param[in] lift la sustentation commandee (PWM A)
+    \param[in] thrust la propulsion commandee (PWM B)
+    \return void
+
+    l'age de la commande est remis a 0 et la coupure est annulee, l'appelant doit ensuite
+    appliquer la commande lui-meme.
+*/
+void failsafe_feed(uint8_t lift, uint8_t thrust);
+
+/**
+    \brief change la valeur du servomoteur appliquee a la coupure
+    \param[in] servo_center valeur du servomoteur lorsque l'aeroglisseur va tout droit
+    \return void
+*/
+void failsafe_set_servo_center(uint16_t servo_center);
+
+/**
+    \brief indique si les moteurs sont presentement coupes par la protection
+    \return TRUE si le lien est perdu
+*/
+bool failsafe_is_tripped(void);
+
+/**
+    \brief indique si la protection surveille le lien
+    \return TRUE si une commande a ete recue depuis failsafe_init et que le lien n'est pas perdu
+*/
+bool failsafe_is_armed(void);
+
+/**
+    \brief retourne le nombre de pertes de lien depuis le demarrage
+    \return le nombre de pertes de lien (revient a 0 apres 255)
+*/
+uint8_t failsafe_get_trip_count(void);
+
+#endif
@@ -63,6 +63,28 @@ void fifo_push(fifo_t* fifo, uint8_t value){
 }
 
 
+void fifo_push_overwrite(fifo_t* fifo, uint8_t value){
+
+    /* Si le buffer est plein on sacrifie la valeur la plus vieille pour faire de la place */
+    if(fifo->is_full == TRUE){
+
+        if(fifo->out_offset == fifo->size - 1){
+
+            fifo->out_offset = 0;
+        }
+
+        else{
+
+            fifo->out_offset++;
+        }
+
+        fifo->is_full = FALSE;
+    }
+
+    fifo_push(fifo, value);
+}
+
+
 uint8_t fifo_pop(fifo_t* fifo){
 
     uint8_t value;
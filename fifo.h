@@ -44,6 +44,7 @@ Prototypes
 
 void fifo_init(fifo_t* fifo, uint8_t* ptr_buffer, uint8_t buffer_size);
 void fifo_push(fifo_t* fifo, uint8_t value);
+void fifo_push_overwrite(fifo_t* fifo, uint8_t value);
 uint8_t fifo_pop(fifo_t* fifo);
 void fifo_clean(fifo_t* fifo);
 bool fifo_is_empty(fifo_t* fifo);
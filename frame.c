@@ -0,0 +1,169 @@
+/**
+	\file frame.c
+	\brief decodeur des trames echangees entre la manette et l'aeroglisseur
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+#include "frame.h"
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static void append(frame_decoder_t* decoder, uint8_t byte, frame_t* frame);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void frame_decoder_init(frame_decoder_t* decoder)
+{
+    decoder->state = FRAME_REJECT_STATE;
+    decoder->in_data_write = FALSE;
+    decoder->index = 0;
+}
+
+bool frame_decoder_push(frame_decoder_t* decoder, uint8_t byte, frame_t* frame)
+{
+    bool complete = FALSE;
+
+    switch(decoder->state)
+    {
+        // si a l'etat de rejet des bytes
+        case FRAME_REJECT_STATE:
+            // si le byte est l'escape byte, change l'etat en escape state, jete tout les autres bytes
+            if(byte == FRAME_ESCAPE)
+            {
+                decoder->state = FRAME_ESCAPE_STATE;
+            }
+            break;
+
+        // si en escape state
+        case FRAME_ESCAPE_STATE:
+            switch(byte)
+            {
+                // si le prochain byte est 'B', une trame incomplete est abandonnee
+                case FRAME_BEGIN:
+                    decoder->state = FRAME_ACCEPT_STATE;
+                    decoder->in_data_write = TRUE;
+                    decoder->index = 0;
+                    break;
+
+                // si le prochain byte est 'C'
+                case FRAME_END:
+                    if(decoder->in_data_write)
+                    {
+                        // les donnees sont deja dans frame
+                        frame->length = decoder->index;
+                        complete = TRUE;
+                    }
+                    decoder->state = FRAME_REJECT_STATE;
+                    decoder->in_data_write = FALSE;
+                    break;
+
+                // si le prochain byte est 'A'
+                case FRAME_VALUE:
+                    append(decoder, FRAME_VALUE, frame);
+                    break;
+
+                // si le prochain byte est 'D'
+                case FRAME_ZERO_VALUE:
+                    append(decoder, 0, frame);
+                    break;
+
+                // si le prochain byte est du garbage
+                default:
+                    decoder->state = FRAME_REJECT_STATE;
+                    decoder->in_data_write = FALSE;
+                    break;
+            }
+            break;
+
+        // si en accept state, met les donnees dans le buffer
+        case FRAME_ACCEPT_STATE:
+            // si on trouve un escape byte
+            if(byte == FRAME_ESCAPE)
+            {
+                decoder->state = FRAME_ESCAPE_STATE;
+            }
+
+            // sinon on ecrit le data
+            else
+            {
+                append(decoder, byte, frame);
+            }
+            break;
+
+        // si l'etat n'est pas gerer, on se resynchronise sur la prochaine trame
+        default:
+            frame_decoder_init(decoder);
+            break;
+    }
+
+    return complete;
+}
+
+uint8_t frame_encode(char* out, const uint8_t* data, uint8_t length)
+{
+    uint8_t i;
+    uint8_t index = 0;
+
+    out[index++] = FRAME_ESCAPE;
+    out[index++] = FRAME_BEGIN;
+
+    for(i = 0; i < length; i++)
+    {
+        // l'escape byte et le 0 ne peuvent pas etre envoyes tels quels
+        if(data[i] == FRAME_ESCAPE)
+        {
+            out[index++] = FRAME_ESCAPE;
+            out[index++] = FRAME_VALUE;
+        }
+        else if(data[i] == 0)
+        {
+            out[index++] = FRAME_ESCAPE;
+            out[index++] = FRAME_ZERO_VALUE;
+        }
+        else
+        {
+            out[index++] = data[i];
+        }
+    }
+
+    out[index++] = FRAME_ESCAPE;
+    out[index++] = FRAME_END;
+    out[index] = '\0';
+
+    return index;
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+/**
+    \brief ajoute un byte de donnee a la trame en cours
+    \param[in,out] decoder le decodeur
+    \param[in] byte le byte a ajouter
+    \param[out] frame la trame en cours
+    \return void
+
+    si aucune trame n'est en cours ou si la trame est trop longue, elle est rejetee
+*/
+static void append(frame_decoder_t* decoder, uint8_t byte, frame_t* frame)
+{
+    if(decoder->in_data_write && decoder->index < FRAME_MAX_LENGTH)
+    {
+        frame->data[decoder->index] = byte;
+        decoder->index++;
+        decoder->state = FRAME_ACCEPT_STATE;
+    }
+    else
+    {
+        decoder->state = FRAME_REJECT_STATE;
+        decoder->in_data_write = FALSE;
+    }
+}
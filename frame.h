@@ -0,0 +1,187 @@
+#ifndef FRAME_H_INCLUDED
+#define FRAME_H_INCLUDED
+
+/**
+	\file frame.h
+	\brief decodeur des trames echangees entre la manette et l'aeroglisseur
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    le protocole utilise le principe de l'escape byte, l'escape byte decider par l'equipe est le 'A', ainsi
+    "AB" -> debut de la trame, "AC" -> fin de la trame, "AA" -> byte de donnee A, "AD" -> byte 0. les autres
+    donnees sont envoyer en "raw byte". Donc, une trame peut ressembler a "ABAAEF8AC".
+
+    Le premier byte de donnee d'une trame indique son type (FRAME_TYPE_...), les suivants dependent
+    du type.
+
+    Le decodeur recoit les bytes un a la fois et les ecrit directement dans un frame_t fourni par
+    l'appelant, sans buffer intermediaire ni copie. Une nouvelle trame ecrase la precedente, ainsi en
+    vidant le rx buffer d'un coup, seule la trame la plus recente est conservee et les trames
+    intermediaires sont ignorees. Pour garder une trame complete, l'appelant donne une autre trame
+    au decodeur (voir packet.h).
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief contient la valeur de l'escape byte
+*/
+#define FRAME_ESCAPE 'A'
+
+/**
+    \brief contient la valeur signifiant "debut"
+*/
+#define FRAME_BEGIN 'B'
+
+/**
+    \brief contient la valeur signifiant "fin"
+*/
+#define FRAME_END 'C'
+
+/**
+    \brief contient la valeur signifiant 'A'
+*/
+#define FRAME_VALUE 'A'
+
+/**
+    \brief contient la valeur signifiant 0
+*/
+#define FRAME_ZERO_VALUE 'D'
+
+/**
+    \brief nombre maximal de bytes de donnee dans une trame
+
+    une trame plus longue est rejetee au complet au lieu de deborder du buffer
+*/
+#define FRAME_MAX_LENGTH 32
+
+/**
+    \brief longueur maximale d'une trame encodee, "AB" + chaque byte double + "AC" + '\0'
+*/
+#define FRAME_ENCODED_MAX_LENGTH (2 * FRAME_MAX_LENGTH + 5)
+
+/**
+    \brief manette -> aeroglisseur: hor, ver, sus, sequence
+*/
+#define FRAME_TYPE_COMMAND 'K'
+
+/**
+    \brief aeroglisseur -> manette: batterie, nombre de pertes de lien, sequence de la commande
+    appliquee, puis les durees UART_RX, DECODE, APPLY et le temps de traitement (voir latency.h;
+    la trame part apres le tick qui a ecrit les registres de la commande),
+    en us sur 16 bits, octet de poids faible en premier, puis le nombre de debordements du fifo
+    RX vus par la boucle principale (modulo 256), puis la profondeur maximale de la pile en bytes
+    (voir stack.h) sur 16 bits, octet de poids faible en premier, puis les moteurs dont la rampe
+    sature (voir ramp.h)
+*/
+#define FRAME_TYPE_STATUS 'S'
+
+/**
+    \brief demande a l'aeroglisseur d'envoyer le contenu de sa trace (pas de donnees)
+*/
+#define FRAME_TYPE_TRACE_REQUEST 'T'
+
+/**
+    \brief un enregistrement de la trace: event, arg, timestamp (LSB, MSB)
+*/
+#define FRAME_TYPE_TRACE_RECORD 'R'
+
+/**
+    \brief manette -> aeroglisseur: change des reglages (voir param.h), options (PARAM_PERSIST),
+    puis des triplets cle (config_value_enum), valeur sur 16 bits, octet de poids faible en premier
+*/
+#define FRAME_TYPE_PARAM_SET 'P'
+
+/**
+    \brief manette -> aeroglisseur: lit des reglages, la liste des cles ou rien pour toutes
+*/
+#define FRAME_TYPE_PARAM_GET 'Q'
+
+/**
+    \brief aeroglisseur -> manette: reponse a P et Q, resultat (param_result_enum), puis les
+    triplets cle, valeur courante
+*/
+#define FRAME_TYPE_PARAM_VALUES 'V'
+
+/**
+    \brief manette -> aeroglisseur: depart du drag (voir launch.h), action (launch_action_enum),
+    puis le numero de la courbe pour LAUNCH_ARM
+*/
+#define FRAME_TYPE_LAUNCH 'L'
+
+/**
+    \brief etat possible de la machine state
+*/
+typedef enum
+{
+    FRAME_REJECT_STATE,
+    FRAME_ESCAPE_STATE,
+    FRAME_ACCEPT_STATE
+}frame_state_enum;
+
+/**
+    \brief trame decodee
+*/
+typedef struct
+{
+    uint8_t data[FRAME_MAX_LENGTH];
+    uint8_t length;
+}frame_t;
+
+/**
+    \brief etat du decodeur
+*/
+typedef struct
+{
+    frame_state_enum state;
+
+    // egal TRUE si le decodeur enregistre des bytes
+    bool in_data_write;
+
+    // nombre de bytes deja ecrits dans la trame en cours
+    uint8_t index;
+}frame_decoder_t;
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief initialise le decodeur, une trame en cours de reception est perdue
+    \param[out] decoder le decodeur a initialiser
+    \return void
+*/
+void frame_decoder_init(frame_decoder_t* decoder);
+
+/**
+    \brief donne un byte recu au decodeur
+    \param[in,out] decoder le decodeur
+    \param[in] byte le byte recu
+    \param[out] frame la trame ou le decodeur ecrit les bytes de donnee
+    \return TRUE si frame contient maintenant une trame complete
+
+    frame doit etre le meme pour tous les bytes d'une trame. Son contenu n'est valide que lorsque
+    la fonction retourne TRUE: les bytes d'une trame partielle y sont ecrits au fur et a mesure,
+    seul length attend la fin de la trame.
+*/
+bool frame_decoder_push(frame_decoder_t* decoder, uint8_t byte, frame_t* frame);
+
+/**
+    \brief encode une trame pour la transmission
+    \param[out] out la chaine encodee, doit avoir au moins FRAME_ENCODED_MAX_LENGTH bytes
+    \param[in] data les donnees de la trame, le type en premier
+    \param[in] length le nombre de bytes de donnee
+    \return la longueur de la chaine encodee sans le '\0'
+
+    la chaine ne contient jamais de 0 avant le '\0' final, elle peut donc etre envoyee
+    directement avec uart_put_string
+*/
+uint8_t frame_encode(char* out, const uint8_t* data, uint8_t length);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef HAL_H_INCLUDED
+#define HAL_H_INCLUDED
+
+/**
+	\file hal.h
+	\brief acces aux registres, aux interruptions et aux attentes du microcontroleur
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Les modules incluent ce fichier au lieu de <avr/io.h>, <avr/interrupt.h> et <util/delay.h>.
+    Sur l'ATmega32, il inclut simplement ces fichiers et les registres sont les vrais registres.
+
+    Compile avec -DHAL_HOST (make host), les registres sont simules en memoire par
+    host/hal_host.c, ce qui permet de tester et de mesurer les modules sur PC.
+
+    Les chaines constantes sont placees en flash avec PSTR() (ou PROGMEM) et lues avec
+    pgm_read_byte, comme avec <avr/pgmspace.h>: sur PC, elles restent en memoire ordinaire.
+
+    hal_spin() est le corps des boucles qui attendent qu'une interruption change une variable
+    (une fifo pleine, par exemple). Sur l'ATmega32, il ne fait rien: l'interruption s'execute
+    pendant la boucle. Sur PC, il laisse le simulateur executer les interruptions.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#ifdef HAL_HOST
+    #include "host/hal_host.h"
+#else
+    #include <avr/io.h>
+    #include <avr/interrupt.h>
+    #include <util/delay.h>
+    #include <avr/pgmspace.h>
+
+    #define hal_spin()
+#endif
+
+#endif
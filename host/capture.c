@@ -0,0 +1,123 @@
+/**
+	\file capture.c
+	\brief fichier de capture des bytes recus par le UART du microcontroleur, avec leur heure
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <string.h>
+
+#include "host/capture.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define CAPTURE_MAGIC "UCAP"
+#define CAPTURE_MAGIC_LENGTH 4
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+int capture_create(capture_t* capture, const char* path)
+{
+    capture->file = fopen(path, "wb");
+    capture->last_us = 0;
+
+    if(capture->file == NULL)
+    {
+        return -1;
+    }
+
+    fwrite(CAPTURE_MAGIC, 1, CAPTURE_MAGIC_LENGTH, capture->file);
+    fputc(CAPTURE_VERSION, capture->file);
+
+    return 0;
+}
+
+int capture_open(capture_t* capture, const char* path)
+{
+    char magic[CAPTURE_MAGIC_LENGTH];
+
+    capture->file = fopen(path, "rb");
+    capture->last_us = 0;
+
+    if(capture->file == NULL)
+    {
+        return -1;
+    }
+
+    if(fread(magic, 1, CAPTURE_MAGIC_LENGTH, capture->file) != CAPTURE_MAGIC_LENGTH ||
+       memcmp(magic, CAPTURE_MAGIC, CAPTURE_MAGIC_LENGTH) != 0 ||
+       fgetc(capture->file) != CAPTURE_VERSION)
+    {
+        fclose(capture->file);
+        capture->file = NULL;
+
+        return -1;
+    }
+
+    return 0;
+}
+
+void capture_write(capture_t* capture, uint64_t us, uint8_t byte)
+{
+    uint64_t delta = (us > capture->last_us) ? us - capture->last_us : 0;
+
+    capture->last_us += delta;
+
+    // LEB128: 7 bits a la fois, le bit 7 indique qu'un autre byte suit
+    while(delta >= 0x80)
+    {
+        fputc((int)(delta & 0x7F) | 0x80, capture->file);
+        delta >>= 7;
+    }
+
+    fputc((int)delta, capture->file);
+    fputc(byte, capture->file);
+}
+
+int capture_read(capture_t* capture, uint64_t* us, uint8_t* byte)
+{
+    uint64_t delta = 0;
+    int shift = 0;
+    int value;
+
+    do
+    {
+        value = fgetc(capture->file);
+
+        if(value == EOF || shift > 63)
+        {
+            return 0;
+        }
+
+        delta |= (uint64_t)(value & 0x7F) << shift;
+        shift += 7;
+    }while(value & 0x80);
+
+    value = fgetc(capture->file);
+
+    if(value == EOF)
+    {
+        return 0;
+    }
+
+    capture->last_us += delta;
+    *us = capture->last_us;
+    *byte = (uint8_t)value;
+
+    return 1;
+}
+
+void capture_close(capture_t* capture)
+{
+    if(capture->file != NULL)
+    {
+        fclose(capture->file);
+        capture->file = NULL;
+    }
+}
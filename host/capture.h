@@ -0,0 +1,75 @@
+#ifndef CAPTURE_H_INCLUDED
+#define CAPTURE_H_INCLUDED
+
+/**
+	\file capture.h
+	\brief fichier de capture des bytes recus par le UART du microcontroleur, avec leur heure
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Format (.ucap):
+
+        "UCAP" + version (1 byte, CAPTURE_VERSION)
+        puis pour chaque byte recu: delai depuis le byte precedent en us (LEB128, 7 bits par
+        byte, poids faible en premier, bit 7 = suite), puis le byte
+
+    Le premier delai est compte a partir du debut de la capture. A 9600 bauds, deux bytes d'une
+    meme rafale sont separes d'environ 1042 us, soit 3 bytes de fichier par byte recu.
+
+    Les captures sont ecrites par host/esp_sim (-c), host/uart_capture (port serie branche sur la
+    broche RX) et host/hover_sim (-C), et rejouees par host/uart_replay.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define CAPTURE_VERSION 1
+
+/**
+    \brief capture ouverte en lecture ou en ecriture
+*/
+typedef struct
+{
+    FILE* file;
+
+    // heure du dernier byte lu ou ecrit, en us depuis le debut de la capture
+    uint64_t last_us;
+}capture_t;
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief cree une capture et ecrit l'entete
+    \return 0, ou -1 si le fichier ne peut pas etre cree
+*/
+int capture_create(capture_t* capture, const char* path);
+
+/**
+    \brief ouvre une capture et verifie l'entete
+    \return 0, ou -1 si le fichier ne peut pas etre ouvert ou n'est pas une capture
+*/
+int capture_open(capture_t* capture, const char* path);
+
+/**
+    \brief ajoute un byte a la capture
+    \param[in] us l'heure du byte depuis le debut de la capture, jamais plus petite que la precedente
+*/
+void capture_write(capture_t* capture, uint64_t us, uint8_t byte);
+
+/**
+    \brief lit le byte suivant
+    \return 1 si un byte a ete lu, 0 a la fin de la capture
+*/
+int capture_read(capture_t* capture, uint64_t* us, uint8_t* byte);
+
+void capture_close(capture_t* capture);
+
+#endif
@@ -0,0 +1,102 @@
+/**
+	\file eeprom_sim.c
+	\brief emulateur de l'EEPROM de l'ATmega32 branche sur les registres simules, sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <string.h>
+
+#include "host/eeprom_sim.h"
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static uint8_t memory[EEPROM_SIM_SIZE];
+static uint32_t writes[EEPROM_SIM_SIZE];
+static uint32_t total_writes;
+
+// ecritures encore permises avant la coupure, -1 si pas de coupure
+static int32_t writes_left = -1;
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void eeprom_sim_init(void)
+{
+    hal_host_set_observer(eeprom_sim_observe);
+}
+
+void eeprom_sim_observe(hal_reg8_enum reg, uint8_t old_value, uint8_t new_value)
+{
+    uint16_t address;
+
+    if(reg != HAL_EECR)
+    {
+        return;
+    }
+
+    address = hal_host_peek16(HAL_EEAR) % EEPROM_SIM_SIZE;
+
+    if(read_bit(new_value, EERE))
+    {
+        hal_host_poke8(HAL_EEDR, memory[address]);
+        new_value = clear_bit(new_value, EERE);
+    }
+
+    if(read_bit(new_value, EEWE) && !read_bit(old_value, EEWE))
+    {
+        if(read_bit(new_value, EEMWE) && writes_left != 0)
+        {
+            memory[address] = hal_host_peek8(HAL_EEDR);
+            writes[address]++;
+            total_writes++;
+
+            if(writes_left > 0)
+            {
+                writes_left--;
+            }
+        }
+
+        new_value = clear_bit(clear_bit(new_value, EEWE), EEMWE);
+    }
+
+    hal_host_poke8(HAL_EECR, new_value);
+}
+
+void eeprom_sim_erase(void)
+{
+    memset(memory, 0xFF, sizeof(memory));
+    memset(writes, 0, sizeof(writes));
+    total_writes = 0;
+    writes_left = -1;
+}
+
+uint8_t eeprom_sim_peek(uint16_t address)
+{
+    return memory[address % EEPROM_SIM_SIZE];
+}
+
+void eeprom_sim_poke(uint16_t address, uint8_t value)
+{
+    memory[address % EEPROM_SIM_SIZE] = value;
+}
+
+uint32_t eeprom_sim_get_writes(uint16_t address)
+{
+    return writes[address % EEPROM_SIM_SIZE];
+}
+
+uint32_t eeprom_sim_get_total_writes(void)
+{
+    return total_writes;
+}
+
+void eeprom_sim_cut_after(int32_t nb_writes)
+{
+    writes_left = nb_writes;
+}
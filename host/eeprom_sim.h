@@ -0,0 +1,78 @@
+#ifndef EEPROM_SIM_H_INCLUDED
+#define EEPROM_SIM_H_INCLUDED
+
+/**
+	\file eeprom_sim.h
+	\brief emulateur de l'EEPROM de l'ATmega32 branche sur les registres simules, sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    L'emulateur observe EECR comme le controleur de l'EEPROM:
+
+    - EERE: EEDR recoit le byte a l'adresse EEAR, puis EERE revient a 0;
+    - EEWE avec EEMWE deja a 1: le byte EEDR est ecrit a l'adresse EEAR, puis EEMWE et EEWE
+      reviennent a 0. EEWE sans EEMWE est ignore.
+
+    L'ecriture est immediate (pas d'attente de 8.5 ms). Chaque byte compte ses ecritures pour
+    mesurer l'usure. eeprom_sim_cut_after simule une coupure de l'alimentation: les ecritures
+    au-dela de la limite sont perdues.
+
+    Comme host/hd44780_sim.h, eeprom_sim_init installe l'observateur de la HAL et un autre
+    observateur peut appeler eeprom_sim_observe dans le sien. Le contenu est conserve par
+    hal_host_reset, comme celui d'une vraie EEPROM apres un reset.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stdint.h>
+
+#include "hal.h"
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define EEPROM_SIM_SIZE 1024
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief installe l'observateur, le contenu et les compteurs ne changent pas
+    \return void
+
+    a appeler apres hal_host_reset
+*/
+void eeprom_sim_init(void);
+
+/**
+    \brief observateur a appeler depuis un autre observateur de la HAL
+*/
+void eeprom_sim_observe(hal_reg8_enum reg, uint8_t old_value, uint8_t new_value);
+
+/**
+    \brief remet l'EEPROM dans l'etat d'une puce neuve (tout a 0xFF) et les compteurs a 0
+*/
+void eeprom_sim_erase(void);
+
+uint8_t eeprom_sim_peek(uint16_t address);
+void eeprom_sim_poke(uint16_t address, uint8_t value);
+
+/**
+    \brief nombre d'ecritures d'un byte depuis eeprom_sim_erase
+*/
+uint32_t eeprom_sim_get_writes(uint16_t address);
+
+/**
+    \brief nombre d'ecritures de tous les bytes depuis eeprom_sim_erase
+*/
+uint32_t eeprom_sim_get_total_writes(void);
+
+/**
+    \brief perd toutes les ecritures apres les nb_writes prochaines, -1 pour ne plus rien perdre
+*/
+void eeprom_sim_cut_after(int32_t nb_writes);
+
+#endif
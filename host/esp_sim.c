@@ -0,0 +1,732 @@
+/**
+	\file esp_sim.c
+	\brief remplace le module ESP8266 par un pseudo-terminal sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: esp_sim [options]
+
+        -l lien     cree un lien symbolique vers le pseudo-terminal (ex: /tmp/esp_aero)
+        -H adresse  remplace l'adresse donnee a AT+CIPSTART (ex: 127.0.0.1 pour 192.168.4.1)
+        -B adresse  adresse locale du socket UDP (toutes par defaut), voir host/udp_relay.c
+        -d ms       delai avant la reponse a chaque commande (10 ms par defaut)
+        -j ms       delai de connexion de AT+CWJAP_DEF (3000 ms par defaut)
+        -e commande repond ERROR (ou FAIL) a cette commande, ex: -e CWJAP_DEF, repetable
+        -E pourcent probabilite qu'une commande reponde ERROR
+        -n          ne renvoie pas l'echo des commandes (ATE0)
+        -c fichier  capture (.ucap, host/capture.h) des bytes ecrits au firmware, voir host/uart_replay.c
+
+    Le programme ouvre un pseudo-terminal et affiche son nom. Le firmware (simavr avec un UART
+    branche sur un pty, ou un adaptateur USB-serie) y envoie les memes commandes AT qu'au vrai
+    module: AT+CWMODE_DEF, AT+CWSAP_DEF, AT+CWJAP_DEF, AT+CIPMODE, AT+CIPSTART et AT+CIPSEND.
+
+    AT+CIPSTART="UDP",adresse,port distant,port local ouvre un socket UDP sur le port local.
+    Si l'adresse est 0.0.0.0, les reponses sont envoyees a l'expediteur du dernier paquet recu,
+    comme le fait l'aeroglisseur. Les paquets recus sont ecrits tels quels dans le pseudo-terminal
+    quand AT+CIPMODE=1, sinon precedes de +IPD,longueur:.
+
+    Apres AT+CIPSEND en mode transparent, les bytes ecrits par le firmware sont regroupes et
+    envoyes en un paquet apres 20 ms sans nouveau byte, comme le vrai module. Une trame "+++"
+    isolee ramene en mode commande.
+
+    Deux instances peuvent simuler la manette et l'aeroglisseur sur la meme machine:
+
+        esp_sim -l /tmp/esp_aero &
+        esp_sim -l /tmp/esp_manette -H 127.0.0.1 &
+
+    La capture donne a chaque byte l'heure ou il finit d'arriver sur la broche RX a 9600 bauds:
+    les bytes d'une meme ecriture se suivent aux 1042 us a partir du moment de l'ecriture.
+
+    Ctrl-C affiche le temps de demarrage (premiere commande jusqu'au mode transparent) et le
+    debit du lien dans chaque direction.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "host/capture.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define LINE_MAX_LENGTH 256
+#define PACKET_MAX_LENGTH 2048
+#define MAX_ERROR_COMMANDS 16
+
+/**
+    \brief duree d'un byte a 9600 bauds (start, 8 bits, stop)
+*/
+#define BYTE_US 1042
+
+/**
+    \brief silence apres lequel le module envoie les bytes recus en mode transparent
+*/
+#define TRANSPARENT_IDLE_MS 20
+
+/**
+    \brief nombre de bytes apres lequel le module envoie un paquet sans attendre le silence
+*/
+#define TRANSPARENT_MAX_LENGTH 2048
+
+/**
+    \brief etats du module
+*/
+typedef enum
+{
+    COMMAND_STATE,
+    TRANSPARENT_STATE
+}esp_state_enum;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static int pty_fd = -1;
+static int udp_fd = -1;
+
+static esp_state_enum state = COMMAND_STATE;
+static int wifi_mode = 1;
+static int cip_mode = 0;
+static int echo = 1;
+
+static const char* host_override = NULL;
+static const char* bind_address = NULL;
+static int response_delay_ms = 10;
+static int join_delay_ms = 3000;
+static int error_percent = 0;
+static const char* error_commands[MAX_ERROR_COMMANDS];
+static int nb_error_commands = 0;
+
+// destination des paquets, 0.0.0.0 pour repondre au dernier expediteur
+static struct sockaddr_in remote;
+static int reply_to_sender = 0;
+static int remote_known = 0;
+
+static char line[LINE_MAX_LENGTH];
+static size_t line_length = 0;
+
+static uint8_t packet[PACKET_MAX_LENGTH];
+static size_t packet_length = 0;
+static double last_byte_ms = 0;
+
+static double first_command_ms = -1;
+static double transparent_ms = -1;
+static double udp_start_ms = -1;
+static uint64_t tx_bytes = 0;
+static uint64_t tx_packets = 0;
+static uint64_t rx_bytes = 0;
+static uint64_t rx_packets = 0;
+
+static volatile sig_atomic_t running = 1;
+
+// capture des bytes envoyes au firmware, en us depuis le demarrage
+static capture_t capture;
+static double capture_start_ms;
+static uint64_t line_free_us = 0;
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static double now_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
+
+static void sleep_ms(int ms)
+{
+    struct timespec duration = {ms / 1000, (ms % 1000) * 1000000L};
+
+    nanosleep(&duration, NULL);
+}
+
+static void stop(int signal)
+{
+    running = 0;
+}
+
+static void capture_bytes(const uint8_t* bytes, size_t length)
+{
+    uint64_t now_us = (uint64_t)((now_ms() - capture_start_ms) * 1000.0);
+    size_t i;
+
+    // la ligne serie est peut-etre encore occupee par l'ecriture precedente
+    if(line_free_us < now_us)
+    {
+        line_free_us = now_us;
+    }
+
+    for(i = 0; i < length; i++)
+    {
+        line_free_us += BYTE_US;
+        capture_write(&capture, line_free_us, bytes[i]);
+    }
+
+    fflush(capture.file);
+}
+
+static void pty_write(const void* data, size_t length)
+{
+    const uint8_t* bytes = data;
+    ssize_t written;
+
+    if(capture.file != NULL)
+    {
+        capture_bytes(bytes, length);
+    }
+
+    while(length > 0)
+    {
+        written = write(pty_fd, bytes, length);
+
+        if(written <= 0)
+        {
+            return;
+        }
+
+        bytes += written;
+        length -= written;
+    }
+}
+
+static void pty_puts(const char* string)
+{
+    pty_write(string, strlen(string));
+}
+
+/**
+    \brief indique si la commande doit echouer (option -e ou -E)
+*/
+static int must_fail(const char* name)
+{
+    int i;
+
+    for(i = 0; i < nb_error_commands; i++)
+    {
+        if(strcmp(error_commands[i], name) == 0)
+        {
+            return 1;
+        }
+    }
+
+    return (error_percent > 0) && (rand() % 100 < error_percent);
+}
+
+/**
+    \brief lit le prochain champ d'une liste separee par des virgules, avec ou sans guillemets
+    \return le debut du champ suivant, NULL s'il n'y en a plus
+*/
+static char* next_field(char* fields, char* out, size_t out_length)
+{
+    size_t length = 0;
+
+    if(fields == NULL || *fields == '\0')
+    {
+        return NULL;
+    }
+
+    if(*fields == '"')
+    {
+        fields++;
+
+        while(*fields != '\0' && *fields != '"')
+        {
+            if(length + 1 < out_length)
+            {
+                out[length++] = *fields;
+            }
+
+            fields++;
+        }
+
+        if(*fields == '"')
+        {
+            fields++;
+        }
+    }
+    else
+    {
+        while(*fields != '\0' && *fields != ',')
+        {
+            if(length + 1 < out_length)
+            {
+                out[length++] = *fields;
+            }
+
+            fields++;
+        }
+    }
+
+    out[length] = '\0';
+
+    return (*fields == ',') ? fields + 1 : fields;
+}
+
+static int cip_start(char* arguments)
+{
+    char type[16];
+    char host[64];
+    char remote_port[16];
+    char local_port[16];
+    struct sockaddr_in local;
+
+    arguments = next_field(arguments, type, sizeof(type));
+    arguments = next_field(arguments, host, sizeof(host));
+    arguments = next_field(arguments, remote_port, sizeof(remote_port));
+    arguments = next_field(arguments, local_port, sizeof(local_port));
+
+    if(arguments == NULL || strcmp(type, "UDP") != 0)
+    {
+        return 0;
+    }
+
+    if(host_override != NULL && strcmp(host, "0.0.0.0") != 0)
+    {
+        snprintf(host, sizeof(host), "%s", host_override);
+    }
+
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(atoi(remote_port));
+
+    if(inet_pton(AF_INET, host, &remote.sin_addr) != 1)
+    {
+        return 0;
+    }
+
+    reply_to_sender = (remote.sin_addr.s_addr == htonl(INADDR_ANY));
+    remote_known = !reply_to_sender;
+
+    udp_fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(atoi(local_port));
+
+    if(bind_address != NULL && inet_pton(AF_INET, bind_address, &local.sin_addr) != 1)
+    {
+        fprintf(stderr, "esp_sim: adresse invalide %s\n", bind_address);
+        return 0;
+    }
+
+    if(udp_fd < 0 || bind(udp_fd, (struct sockaddr*)&local, sizeof(local)) != 0)
+    {
+        perror("esp_sim: bind");
+
+        if(udp_fd >= 0)
+        {
+            close(udp_fd);
+            udp_fd = -1;
+        }
+
+        return 0;
+    }
+
+    udp_start_ms = now_ms();
+    fprintf(stderr, "esp_sim: UDP %s:%s <- port local %s\n", host, remote_port, local_port);
+
+    return 1;
+}
+
+/**
+    \brief execute une commande AT recue sur le pseudo-terminal
+*/
+static void execute(char* command)
+{
+    char* arguments;
+    const char* name;
+
+    if(first_command_ms < 0)
+    {
+        first_command_ms = now_ms();
+    }
+
+    if(echo)
+    {
+        pty_puts(command);
+        pty_puts("\r\n");
+    }
+
+    if(strncmp(command, "AT", 2) != 0)
+    {
+        return;
+    }
+
+    // nom de la commande sans "AT+" ni arguments
+    name = (command[2] == '+') ? &command[3] : &command[2];
+    arguments = strchr(command, '=');
+
+    if(arguments != NULL)
+    {
+        *arguments = '\0';
+        arguments++;
+    }
+
+    sleep_ms(response_delay_ms);
+
+    if(must_fail(name))
+    {
+        pty_puts(strcmp(name, "CWJAP_DEF") == 0 ? "+CWJAP:3\r\n\r\nFAIL\r\n" : "\r\nERROR\r\n");
+    }
+    else if(*name == '\0' || strcmp(name, "E1") == 0 || strcmp(name, "E0") == 0)
+    {
+        echo = (strcmp(name, "E0") != 0) && echo;
+        pty_puts("\r\nOK\r\n");
+    }
+    else if(strcmp(name, "RST") == 0)
+    {
+        pty_puts("\r\nOK\r\n");
+        sleep_ms(response_delay_ms);
+        pty_puts("\r\nready\r\n");
+    }
+    else if(strcmp(name, "CWMODE_DEF") == 0 || strcmp(name, "CWMODE") == 0)
+    {
+        wifi_mode = (arguments != NULL) ? atoi(arguments) : wifi_mode;
+        pty_puts((wifi_mode >= 1 && wifi_mode <= 3) ? "\r\nOK\r\n" : "\r\nERROR\r\n");
+    }
+    else if(strcmp(name, "CWSAP_DEF") == 0 || strcmp(name, "CWSAP") == 0)
+    {
+        // le point d'acces n'existe qu'en mode 2 ou 3
+        pty_puts((wifi_mode >= 2 && arguments != NULL) ? "\r\nOK\r\n" : "\r\nERROR\r\n");
+    }
+    else if(strcmp(name, "CWJAP_DEF") == 0 || strcmp(name, "CWJAP") == 0)
+    {
+        if(wifi_mode == 2 || arguments == NULL)
+        {
+            pty_puts("\r\nERROR\r\n");
+        }
+        else
+        {
+            sleep_ms(join_delay_ms);
+            pty_puts("WIFI CONNECTED\r\nWIFI GOT IP\r\n\r\nOK\r\n");
+        }
+    }
+    else if(strcmp(name, "CIPMODE") == 0)
+    {
+        cip_mode = (arguments != NULL) ? atoi(arguments) : cip_mode;
+        pty_puts("\r\nOK\r\n");
+    }
+    else if(strcmp(name, "CIPSTART") == 0)
+    {
+        if(udp_fd >= 0)
+        {
+            pty_puts("ALREADY CONNECTED\r\n\r\nERROR\r\n");
+        }
+        else if(arguments != NULL && cip_start(arguments))
+        {
+            pty_puts("CONNECT\r\n\r\nOK\r\n");
+        }
+        else
+        {
+            pty_puts("\r\nERROR\r\n");
+        }
+    }
+    else if(strcmp(name, "CIPSEND") == 0 && arguments == NULL)
+    {
+        // seul le mode transparent est supporte
+        if(cip_mode == 1 && udp_fd >= 0)
+        {
+            pty_puts("\r\nOK\r\n\r\n>");
+            state = TRANSPARENT_STATE;
+            packet_length = 0;
+
+            if(transparent_ms < 0)
+            {
+                transparent_ms = now_ms();
+                fprintf(stderr, "esp_sim: mode transparent apres %.0f ms\n",
+                        transparent_ms - first_command_ms);
+            }
+        }
+        else
+        {
+            pty_puts("\r\nERROR\r\n");
+        }
+    }
+    else
+    {
+        pty_puts("\r\nERROR\r\n");
+    }
+}
+
+/**
+    \brief envoie les bytes accumules en mode transparent
+*/
+static void flush_packet(void)
+{
+    if(packet_length == 0)
+    {
+        return;
+    }
+
+    // "+++" seul ramene en mode commande
+    if(packet_length == 3 && memcmp(packet, "+++", 3) == 0)
+    {
+        state = COMMAND_STATE;
+    }
+    else if(udp_fd >= 0 && remote_known)
+    {
+        if(sendto(udp_fd, packet, packet_length, 0, (struct sockaddr*)&remote, sizeof(remote)) > 0)
+        {
+            tx_bytes += packet_length;
+            tx_packets++;
+        }
+    }
+
+    packet_length = 0;
+}
+
+static void pty_receive(void)
+{
+    uint8_t buffer[256];
+    ssize_t length;
+    ssize_t i;
+
+    length = read(pty_fd, buffer, sizeof(buffer));
+
+    for(i = 0; i < length; i++)
+    {
+        if(state == TRANSPARENT_STATE)
+        {
+            packet[packet_length++] = buffer[i];
+            last_byte_ms = now_ms();
+
+            if(packet_length >= TRANSPARENT_MAX_LENGTH)
+            {
+                flush_packet();
+            }
+        }
+        else if(buffer[i] == '\n')
+        {
+            // retire le '\r' de la fin de ligne
+            if(line_length > 0 && line[line_length - 1] == '\r')
+            {
+                line_length--;
+            }
+
+            line[line_length] = '\0';
+            line_length = 0;
+
+            execute(line);
+        }
+        else if(line_length + 1 < LINE_MAX_LENGTH)
+        {
+            line[line_length++] = buffer[i];
+        }
+    }
+}
+
+static void udp_receive(void)
+{
+    uint8_t buffer[PACKET_MAX_LENGTH];
+    char header[32];
+    struct sockaddr_in sender;
+    socklen_t sender_length = sizeof(sender);
+    ssize_t length;
+
+    length = recvfrom(udp_fd, buffer, sizeof(buffer), 0, (struct sockaddr*)&sender, &sender_length);
+
+    if(length <= 0)
+    {
+        return;
+    }
+
+    if(reply_to_sender)
+    {
+        remote = sender;
+        remote_known = 1;
+    }
+
+    rx_bytes += length;
+    rx_packets++;
+
+    if(cip_mode == 1)
+    {
+        pty_write(buffer, length);
+    }
+    else
+    {
+        snprintf(header, sizeof(header), "\r\n+IPD,%d:", (int)length);
+        pty_puts(header);
+        pty_write(buffer, length);
+    }
+}
+
+static void print_statistics(void)
+{
+    double elapsed = (udp_start_ms < 0) ? 0 : (now_ms() - udp_start_ms) / 1000.0;
+
+    if(transparent_ms >= 0)
+    {
+        fprintf(stderr, "demarrage: %.0f ms\n", transparent_ms - first_command_ms);
+    }
+
+    if(elapsed > 0)
+    {
+        fprintf(stderr, "pty -> UDP: %llu bytes, %llu paquets, %.1f bytes/s, %.1f paquets/s\n",
+                (unsigned long long)tx_bytes, (unsigned long long)tx_packets,
+                tx_bytes / elapsed, tx_packets / elapsed);
+        fprintf(stderr, "UDP -> pty: %llu bytes, %llu paquets, %.1f bytes/s, %.1f paquets/s\n",
+                (unsigned long long)rx_bytes, (unsigned long long)rx_packets,
+                rx_bytes / elapsed, rx_packets / elapsed);
+    }
+}
+
+static int open_pty(const char* link_path)
+{
+    struct termios settings;
+    const char* name;
+    int slave_fd;
+
+    pty_fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if(pty_fd < 0 || grantpt(pty_fd) != 0 || unlockpt(pty_fd) != 0)
+    {
+        perror("esp_sim: pty");
+        return 0;
+    }
+
+    name = ptsname(pty_fd);
+
+    // le cote esclave reste ouvert pour que la fermeture par le firmware ne ferme pas le pty
+    slave_fd = open(name, O_RDWR | O_NOCTTY);
+
+    if(slave_fd < 0)
+    {
+        perror(name);
+        return 0;
+    }
+
+    tcgetattr(slave_fd, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(slave_fd, TCSANOW, &settings);
+
+    if(link_path != NULL)
+    {
+        unlink(link_path);
+
+        if(symlink(name, link_path) != 0)
+        {
+            perror(link_path);
+            return 0;
+        }
+    }
+
+    printf("%s\n", (link_path != NULL) ? link_path : name);
+    fflush(stdout);
+
+    return 1;
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    struct pollfd fds[2];
+    const char* link_path = NULL;
+    int option;
+    int timeout;
+
+    while((option = getopt(argc, argv, "l:H:B:d:j:e:E:nc:")) != -1)
+    {
+        switch(option)
+        {
+            case 'l': link_path = optarg; break;
+            case 'H': host_override = optarg; break;
+            case 'B': bind_address = optarg; break;
+            case 'd': response_delay_ms = atoi(optarg); break;
+            case 'j': join_delay_ms = atoi(optarg); break;
+            case 'E': error_percent = atoi(optarg); break;
+            case 'n': echo = 0; break;
+
+            case 'c':
+                if(capture_create(&capture, optarg) != 0)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                capture_start_ms = now_ms();
+                break;
+
+            case 'e':
+                if(nb_error_commands < MAX_ERROR_COMMANDS)
+                {
+                    error_commands[nb_error_commands++] = optarg;
+                }
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-l lien] [-H adresse] [-B adresse] [-d ms] [-j ms] [-e commande] "
+                                "[-E pourcent] [-n] [-c fichier]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if(!open_pty(link_path))
+    {
+        return 1;
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    while(running)
+    {
+        fds[0].fd = pty_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = udp_fd;
+        fds[1].events = POLLIN;
+
+        timeout = (packet_length > 0) ? TRANSPARENT_IDLE_MS : 100;
+
+        if(poll(fds, (udp_fd >= 0) ? 2 : 1, timeout) < 0)
+        {
+            continue;
+        }
+
+        if(fds[0].revents & POLLIN)
+        {
+            pty_receive();
+        }
+
+        if(udp_fd >= 0 && (fds[1].revents & POLLIN))
+        {
+            udp_receive();
+        }
+
+        if(packet_length > 0 && now_ms() - last_byte_ms >= TRANSPARENT_IDLE_MS)
+        {
+            flush_packet();
+        }
+    }
+
+    print_statistics();
+    capture_close(&capture);
+
+    if(link_path != NULL)
+    {
+        unlink(link_path);
+    }
+
+    return 0;
+}
@@ -0,0 +1,634 @@
+/**
+	\file fifo_stress.c
+	\brief stress des fifos du UART entre les interruptions et la boucle principale, sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage:
+        make fifo_check                              les deux politiques de debordement
+        host/fifo_stress [-d secondes] [-s graine]   sous ThreadSanitizer
+
+    Le test execute le vrai uart.c (et donc fifo.c). Un thread joue le role du UART: il execute
+    USART_RXC_vect et USART_UDRE_vect a des moments aleatoires, en parallele avec la boucle
+    principale qui joue le role de main() et utilise l'API du UART (uart_get_byte tant que
+    uart_is_rx_buffer_empty est faux, uart_put_string, uart_is_rx_overflowed). Une interruption
+    peut donc couper main entre deux instructions de fifo.c, comme sur l'ATmega32.
+
+    Les registres ne sont pas ceux de host/hal_host.c, qui n'est pas fait pour deux threads: ce
+    fichier fournit lui-meme hal_host_reg8, hal_host_sei, hal_host_cli et hal_host_spin. Chaque
+    interruption a un mutex qui represente son masque. Le thread des interruptions garde le
+    mutex pendant toute l'interruption, qui ne s'execute que si le bit I de SREG et son bit de
+    UCSRB (RXCIE ou UDRIE) sont a 1. Main garde le mutex d'une interruption tant qu'elle est
+    masquee:
+
+    - a chaque acces de main a UCSRB ou SREG, main prend les deux mutex avant l'acces;
+    - aux autres acces, a sei, a cli et a hal_spin, main relache le mutex de chaque interruption
+      permise par SREG et UCSRB.
+
+    Main ne relache donc un masque qu'a son prochain appel du HAL apres l'ecriture de UCSRB, plus
+    tard que l'ATmega32: le test ne peut que rater une course, pas en inventer une. La boucle du
+    test appelle hal_spin entre deux appels du UART pour que chaque appel commence avec les
+    masques de uart.c. Un acces a un fifo hors du masque se fait alors en parallele avec
+    l'interruption, ThreadSanitizer le rapporte et les bytes en sont perdus, doubles ou
+    desordonnes.
+
+    uart_is_rx_buffer_empty et l'attente de uart_put_string lisent is_empty et is_full hors du
+    masque. Sur l'ATmega32, ce sont des lectures d'un seul byte et seule main peut changer le
+    resultat dans le sens qui compte (vider le fifo de reception, remplir celui de transmission).
+    Ces deux lectures sont ignorees par ThreadSanitizer (host/fifo_stress.supp, race_top, donc
+    seulement quand fifo_is_empty ou fifo_is_full fait l'acces).
+
+    Les bytes de chaque direction sont numerotes (de 1 a 255 en transmission, 0 terminerait la
+    string). Le recepteur de chaque direction compte les bytes perdus, doubles et desordonnes.
+    En reception, un fifo plein perd des bytes selon la politique de debordement: ces bytes sont
+    comptes comme ecrases si uart_is_rx_overflowed a rapporte un debordement apres que le premier
+    byte du trou a ete envoye sur la ligne, sinon comme perdus. Les deux politiques sont executees
+    chacune pendant la moitie de la duree. Le code de sortie est 1 s'il y a une erreur ou si
+    aucun byte n'a ete ecrase.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hal.h"
+#include "utils.h"
+#include "uart.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief plus longue attente aleatoire entre deux interruptions, en tours de boucle
+*/
+#define STRESS_MAX_DELAY 64
+
+/**
+    \brief plus longue attente de main sans vider le fifo de reception, en tours de boucle
+*/
+#define STRESS_MAX_BUSY 8192
+
+/**
+    \brief bytes envoyes sur la ligne d'avance sur le dernier byte lu par main, moins que la moitie
+    des numeros pour qu'un trou ne soit pas pris pour un retour en arriere
+*/
+#define STRESS_MAX_AHEAD 96
+
+/**
+    \brief nombre maximal de bytes d'une rafale de uart_put_string
+*/
+#define STRESS_MAX_BURST 24
+
+/**
+    \brief verification des bytes recus dans une direction
+*/
+typedef struct
+{
+    const char* name;
+    uint16_t modulo;            // 256 en reception, 255 en transmission
+    uint8_t first;              // numero du byte 0, 0 en reception, 1 en transmission
+    uint32_t expected;          // position du prochain byte attendu depuis le debut
+    uint32_t received;
+    uint32_t overwritten;       // bytes ecrases par un debordement rapporte
+    uint32_t lost;
+    uint32_t duplicated;
+    uint32_t reordered;
+}stream_t;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static volatile uint8_t regs8[HAL_NB_REGS8];
+static volatile uint16_t regs16[HAL_NB_REGS16];
+
+// masques de USART_RXC_vect et USART_UDRE_vect
+static pthread_mutex_t rx_mask = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t udre_mask = PTHREAD_MUTEX_INITIALIZER;
+
+// mutex gardes par main, seulement lus et modifies par main
+static bool rx_masked;
+static bool udre_masked;
+
+// vrai dans le thread des interruptions, et dans main quand elle vide le fifo de transmission
+static __thread bool in_interrupt;
+
+static stream_t rx_stream;
+static stream_t tx_stream;
+
+// bytes recus sur la ligne, modifie seulement par le thread des interruptions
+static uint32_t rx_sent;
+// copie de rx_stream.expected pour le thread des interruptions
+static uint32_t rx_seen;
+// bytes envoyes par main
+static uint32_t tx_sent;
+
+// rx_sent au dernier debordement rapporte, les bytes ecrases avant cette position sont expliques
+static uint32_t overflow_until;
+
+static uint32_t nb_interrupts;
+// arret du thread des interruptions
+static int running;
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static uint32_t random_next(uint32_t* state)
+{
+    // xorshift32
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+static void random_delay(uint32_t* state, uint32_t max)
+{
+    volatile uint32_t i;
+    uint32_t length = random_next(state) % max;
+
+    for(i = 0; i < length; i++);
+}
+
+static double now_s(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/**
+    \brief main prend les deux masques, l'interruption en cours se termine d'abord
+*/
+static void mask_all(void)
+{
+    // toujours rx_mask avant udre_mask; UDRIE est a 0 si main ne garde que udre_mask, relacher
+    // udre_mask un instant ne permet donc pas d'interruption
+    if(!rx_masked && udre_masked)
+    {
+        udre_masked = FALSE;
+        pthread_mutex_unlock(&udre_mask);
+    }
+
+    if(!rx_masked)
+    {
+        pthread_mutex_lock(&rx_mask);
+        rx_masked = TRUE;
+    }
+
+    if(!udre_masked)
+    {
+        pthread_mutex_lock(&udre_mask);
+        udre_masked = TRUE;
+    }
+}
+
+/**
+    \brief main relache le masque de chaque interruption permise par SREG et UCSRB
+*/
+static void unmask_enabled(void)
+{
+    mask_all();
+
+    if(!(regs8[HAL_SREG] & (1 << SREG_I)))
+    {
+        return;
+    }
+
+    if(regs8[HAL_UCSRB] & (1 << RXCIE))
+    {
+        rx_masked = FALSE;
+        pthread_mutex_unlock(&rx_mask);
+    }
+
+    if(regs8[HAL_UCSRB] & (1 << UDRIE))
+    {
+        udre_masked = FALSE;
+        pthread_mutex_unlock(&udre_mask);
+    }
+}
+
+/**
+    \brief main relache les deux masques, pour que le thread des interruptions puisse s'arreter
+*/
+static void unmask_all(void)
+{
+    if(rx_masked)
+    {
+        rx_masked = FALSE;
+        pthread_mutex_unlock(&rx_mask);
+    }
+
+    if(udre_masked)
+    {
+        udre_masked = FALSE;
+        pthread_mutex_unlock(&udre_mask);
+    }
+}
+
+/**
+    \brief numero du byte a une position d'une direction
+*/
+static uint8_t byte_at(const stream_t* stream, uint32_t position)
+{
+    return (uint8_t)(position % stream->modulo + stream->first);
+}
+
+/**
+    \brief retient la position de la ligne au moment d'un debordement rapporte
+*/
+static void main_check_overflow(void)
+{
+    if(uart_is_rx_overflowed() == TRUE)
+    {
+        overflow_until = __atomic_load_n(&rx_sent, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+    \brief compare le numero d'un byte a celui attendu, sans compter de byte recu
+    \return l'ecart entre la position du byte et celle attendue
+*/
+static int16_t check_sequence(stream_t* stream, uint8_t byte)
+{
+    int16_t difference = ((int16_t)(byte - stream->first) - (int16_t)(stream->expected % stream->modulo) +
+                          stream->modulo) % stream->modulo;
+
+    if(difference >= stream->modulo / 2)
+    {
+        difference -= stream->modulo;
+    }
+
+    if(difference > 0)
+    {
+        // le premier byte du trou a ete ecrase avant un debordement rapporte, uart.c a pu
+        // rapporter le debordement avant que main ne voie le trou
+        if(stream == &rx_stream && overflow_until <= stream->expected)
+        {
+            main_check_overflow();
+        }
+
+        if(stream == &rx_stream && overflow_until > stream->expected)
+        {
+            stream->overwritten += difference;
+        }
+        else
+        {
+            stream->lost += difference;
+        }
+    }
+    else if(difference == -1)
+    {
+        stream->duplicated++;
+    }
+    else if(difference < 0)
+    {
+        stream->reordered++;
+    }
+
+    return difference;
+}
+
+/**
+    \brief verifie un byte recu, le numero attendu suit le dernier byte recu
+*/
+static void check_byte(stream_t* stream, uint8_t byte)
+{
+    stream->received++;
+    stream->expected += check_sequence(stream, byte) + 1;
+
+    if(stream == &rx_stream)
+    {
+        __atomic_store_n(&rx_seen, stream->expected, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+    \brief USART_RXC_vect: un byte arrive de la ligne
+*/
+static void rx_interrupt(void)
+{
+    regs8[HAL_UDR] = byte_at(&rx_stream, rx_sent);
+    USART_RXC_vect();
+
+    __atomic_store_n(&rx_sent, rx_sent + 1, __ATOMIC_RELAXED);
+}
+
+/**
+    \brief USART_UDRE_vect: le UART peut transmettre un autre byte
+*/
+static void udre_interrupt(void)
+{
+    USART_UDRE_vect();
+    check_byte(&tx_stream, regs8[HAL_UDR]);
+}
+
+/**
+    \brief les interruptions, une seule a la fois comme sur l'ATmega32
+*/
+static void* interrupts(void* argument)
+{
+    uint32_t state = *(uint32_t*)argument;
+
+    in_interrupt = TRUE;
+
+    while(__atomic_load_n(&running, __ATOMIC_RELAXED))
+    {
+        random_delay(&state, STRESS_MAX_DELAY);
+
+        if(random_next(&state) & 1)
+        {
+            // sur un seul coeur, le thread peut s'executer longtemps sans que main lise un byte
+            if(rx_sent - __atomic_load_n(&rx_seen, __ATOMIC_RELAXED) >= STRESS_MAX_AHEAD)
+            {
+                sched_yield();
+                continue;
+            }
+
+            pthread_mutex_lock(&rx_mask);
+
+            if((regs8[HAL_SREG] & (1 << SREG_I)) && (regs8[HAL_UCSRB] & (1 << RXCIE)))
+            {
+                rx_interrupt();
+                nb_interrupts++;
+            }
+
+            pthread_mutex_unlock(&rx_mask);
+        }
+        else
+        {
+            pthread_mutex_lock(&udre_mask);
+
+            if((regs8[HAL_SREG] & (1 << SREG_I)) && (regs8[HAL_UCSRB] & (1 << UDRIE)))
+            {
+                udre_interrupt();
+                nb_interrupts++;
+            }
+
+            pthread_mutex_unlock(&udre_mask);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+    \brief uart_get_byte tant que uart_is_rx_buffer_empty est faux
+
+    Au plus un fifo plein par appel: le thread des interruptions recoit plus vite que la ligne
+    a 9600 bauds et main ne sortirait jamais de la boucle.
+*/
+static void main_receive(void)
+{
+    uint8_t i = 0;
+
+    while(i++ < UART_RX_BUFFER_SIZE && uart_is_rx_buffer_empty() == FALSE)
+    {
+        check_byte(&rx_stream, uart_get_byte());
+        hal_spin();
+    }
+}
+
+/**
+    \brief uart_put_string avec une rafale de bytes numerotes
+*/
+static void main_transmit(uint8_t length)
+{
+    char string[STRESS_MAX_BURST + 1];
+    uint8_t i;
+
+    for(i = 0; i < length; i++)
+    {
+        string[i] = (char)byte_at(&tx_stream, tx_sent++);
+    }
+
+    string[length] = '\0';
+
+    uart_put_string(string);
+}
+
+/**
+    \brief execute le stress avec une politique de debordement
+    \return le nombre d'operations (interruptions et appels de l'API du UART)
+*/
+static uint32_t run(uart_overflow_policy_e policy, uint32_t* state, double duration)
+{
+    pthread_t thread;
+    uint32_t interrupt_state = *state * 2654435761UL | 1;
+    uint32_t nb_operations = 0;
+    uint32_t choice;
+    double start = now_s();
+
+    rx_sent = 0;
+    rx_seen = 0;
+    tx_sent = 0;
+    overflow_until = 0;
+    nb_interrupts = 0;
+
+    uart_init();
+    uart_set_rx_overflow_policy(policy);
+    sei();
+
+    __atomic_store_n(&running, 1, __ATOMIC_RELAXED);
+    pthread_create(&thread, NULL, interrupts, &interrupt_state);
+
+    do
+    {
+        choice = random_next(state) % 4;
+
+        if(choice == 0)
+        {
+            main_receive();
+        }
+        else if(choice == 1)
+        {
+            main_transmit(1 + random_next(state) % STRESS_MAX_BURST);
+        }
+        else if(choice == 2)
+        {
+            main_check_overflow();
+        }
+        else
+        {
+            // main est occupee ailleurs (lcd, calculs), le fifo de reception peut deborder
+            random_delay(state, STRESS_MAX_BUSY);
+        }
+
+        // chaque appel du UART commence avec les masques que uart.c a laisses
+        hal_spin();
+        nb_operations++;
+    }while(now_s() - start < duration);
+
+    __atomic_store_n(&running, 0, __ATOMIC_RELAXED);
+    unmask_all();
+    pthread_join(thread, NULL);
+
+    // les bytes encore dans les fifos ne sont pas des pertes
+    main_receive();
+
+    in_interrupt = TRUE;
+
+    while(uart_is_tx_buffer_empty() == FALSE)
+    {
+        udre_interrupt();
+    }
+
+    in_interrupt = FALSE;
+
+    // les derniers bytes envoyes doivent aussi etre arrives
+    check_sequence(&rx_stream, byte_at(&rx_stream, rx_sent));
+    check_sequence(&tx_stream, byte_at(&tx_stream, tx_sent));
+
+    return nb_operations + nb_interrupts;
+}
+
+static void print_stream(const char* policy, const stream_t* stream)
+{
+    printf("%-12s %-4s %10u %8u %8u %8u %11u\n", policy, stream->name, stream->received,
+           stream->overwritten, stream->lost, stream->duplicated, stream->reordered);
+}
+
+static bool has_errors(const stream_t* stream)
+{
+    return stream->lost || stream->duplicated || stream->reordered;
+}
+
+/******************************************************************************
+Fonctions du HAL (voir host/hal_host.h)
+******************************************************************************/
+volatile uint8_t* hal_host_reg8(hal_reg8_enum reg)
+{
+    if(!in_interrupt)
+    {
+        if(reg == HAL_UCSRB || reg == HAL_SREG)
+        {
+            mask_all();
+        }
+        else
+        {
+            unmask_enabled();
+        }
+    }
+
+    return &regs8[reg];
+}
+
+volatile uint16_t* hal_host_reg16(hal_reg16_enum reg)
+{
+    if(!in_interrupt)
+    {
+        unmask_enabled();
+    }
+
+    return &regs16[reg];
+}
+
+void hal_host_sei(void)
+{
+    mask_all();
+    regs8[HAL_SREG] |= (1 << SREG_I);
+    unmask_enabled();
+}
+
+void hal_host_cli(void)
+{
+    mask_all();
+    regs8[HAL_SREG] &= ~(1 << SREG_I);
+}
+
+void hal_host_spin(void)
+{
+    if(!in_interrupt)
+    {
+        unmask_enabled();
+    }
+
+    sched_yield();
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    static const char* names[] = {"drop newest", "drop oldest"};
+    static const uart_overflow_policy_e policies[] = {UART_OVERFLOW_DROP_NEWEST,
+                                                      UART_OVERFLOW_DROP_OLDEST};
+    stream_t rx_results[2];
+    stream_t tx_results[2];
+    uint32_t state = 1;
+    uint32_t nb_operations = 0;
+    double duration = 5.0;
+    double start;
+    double elapsed;
+    int errors = 0;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+        {
+            duration = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            state = strtoul(argv[++i], NULL, 0) | 1;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-d secondes] [-s graine]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    start = now_s();
+
+    for(i = 0; i < 2; i++)
+    {
+        memset(&rx_stream, 0, sizeof(rx_stream));
+        memset(&tx_stream, 0, sizeof(tx_stream));
+        rx_stream.name = "rx";
+        rx_stream.modulo = 256;
+        rx_stream.first = 0;
+        tx_stream.name = "tx";
+        tx_stream.modulo = 255;
+        tx_stream.first = 1;
+
+        nb_operations += run(policies[i], &state, duration / 2);
+
+        rx_results[i] = rx_stream;
+        tx_results[i] = tx_stream;
+    }
+
+    elapsed = now_s() - start;
+
+    printf("%-12s %-4s %10s %8s %8s %8s %11s\n", "politique", "fifo", "bytes", "ecrases", "perdus",
+           "doubles", "desordonnes");
+
+    for(i = 0; i < 2; i++)
+    {
+        print_stream(names[i], &rx_results[i]);
+        print_stream(names[i], &tx_results[i]);
+
+        // un debordement qui n'arrive jamais ne teste pas la politique
+        if(has_errors(&rx_results[i]) || has_errors(&tx_results[i]) ||
+           rx_results[i].overwritten == 0)
+        {
+            errors++;
+        }
+    }
+
+    printf("%.0f operations/s (interruptions et appels du UART) en %.1f s\n",
+           nb_operations / elapsed, elapsed);
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,594 @@
+/**
+	\file fuzz_frame.c
+	\brief harnais de fuzzing du decodeur de trames, compatible libFuzzer et AFL
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage:
+        make fuzz_check                          rejoue le corpus, fuzz 10 s et mesure le debit
+        host/fuzz_frame [fichier|dossier ...]    rejoue des entrees (corpus, crash)
+        host/fuzz_frame < entree                 une entree sur l'entree standard (AFL)
+        host/fuzz_frame -r secondes [-s graine] dossier ...
+                                                 mutations aleatoires du corpus, sans outil externe
+        host/fuzz_frame_bench -b secondes        debit du decodeur en Mo/s, sans sanitizers
+        make fuzz                                libFuzzer (clang) sur host/corpus/frame
+
+    Avec AFL: afl-gcc ou afl-clang-fast, puis afl-fuzz -i host/corpus/frame -o sortie -- host/fuzz_frame
+
+    Chaque entree est donnee byte par byte a frame_decoder_push, comme le ferait la boucle
+    principale en vidant le rx buffer. Le harnais verifie:
+
+    - que le decodeur reste dans un etat valide (etat connu, index <= FRAME_MAX_LENGTH);
+    - que chaque trame deposee est identique a celle du modele de reference ci-dessous, ecrit a
+      partir de la description du protocole dans frame.h et non du code de frame.c;
+    - que la longueur de frame ne change jamais sans qu'une trame soit complete (les bytes d'une
+      trame partielle sont ecrits directement dans frame);
+    - que chaque trame reencodee avec frame_encode tient dans FRAME_ENCODED_MAX_LENGTH, ne
+      contient aucun 0 et redonne exactement la meme trame une fois decodee.
+
+    Une erreur appelle abort(), ce que libFuzzer et AFL comptent comme un crash. Les sanitizers
+    (address, undefined) detectent en plus toute ecriture hors de la trame.
+
+    Le debit est mesure sur deux flux: des trames de commande valides a la suite et des bytes
+    aleatoires. Le compte est en Mo (10^6 bytes) de flux donnes au decodeur par seconde.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "utils.h"
+#include "frame.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief taille maximale d'une entree, le reste est ignore
+*/
+#define FUZZ_MAX_INPUT 4096
+
+/**
+    \brief taille des flux de la mesure de debit
+*/
+#define FUZZ_BENCH_LENGTH (1024UL * 1024UL)
+
+#define FUZZ_CHECK(condition)                                                       \
+    do                                                                              \
+    {                                                                               \
+        if(!(condition))                                                            \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition);         \
+            abort();                                                                \
+        }                                                                           \
+    }while(0)
+
+/**
+    \brief modele de reference du decodeur
+*/
+typedef struct
+{
+    int in_frame;
+    int escaped;
+    uint8_t length;
+    uint8_t data[FRAME_MAX_LENGTH];
+}reference_t;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static uint32_t random_state = 1;
+
+// empeche le compilateur de retirer le decodage de la mesure de debit
+static volatile uint32_t sink;
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static uint32_t random_next(void)
+{
+    // xorshift32
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+
+    return random_state;
+}
+
+static double now_s(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void reference_add(reference_t* reference, uint8_t byte)
+{
+    // une trame trop longue est jetee au complet
+    if(reference->length == FRAME_MAX_LENGTH)
+    {
+        reference->in_frame = 0;
+    }
+    else
+    {
+        reference->data[reference->length++] = byte;
+    }
+}
+
+/**
+    \brief donne un byte au modele de reference
+    \return 1 si une trame vient de se terminer
+
+    Le protocole: hors d'une trame, tout est ignore jusqu'a "AB". Dans une trame, "AB" recommence
+    une trame, "AC" la termine, "AA" donne 'A', "AD" donne 0 et un escape byte suivi d'autre
+    chose abandonne la trame. Hors d'une trame, le byte qui suit un escape byte est consomme avec
+    lui, "AAB" n'ouvre donc pas de trame.
+*/
+static int reference_push(reference_t* reference, uint8_t byte)
+{
+    if(!reference->escaped)
+    {
+        if(byte == FRAME_ESCAPE)
+        {
+            reference->escaped = 1;
+        }
+        else if(reference->in_frame)
+        {
+            reference_add(reference, byte);
+        }
+
+        return 0;
+    }
+
+    reference->escaped = 0;
+
+    if(byte == FRAME_BEGIN)
+    {
+        reference->in_frame = 1;
+        reference->length = 0;
+    }
+    else if(!reference->in_frame)
+    {
+        // escape byte hors d'une trame: le byte suivant est jete
+    }
+    else if(byte == FRAME_END)
+    {
+        reference->in_frame = 0;
+
+        return 1;
+    }
+    else if(byte == FRAME_VALUE)
+    {
+        reference_add(reference, FRAME_ESCAPE);
+    }
+    else if(byte == FRAME_ZERO_VALUE)
+    {
+        reference_add(reference, 0);
+    }
+    else
+    {
+        reference->in_frame = 0;
+    }
+
+    return 0;
+}
+
+static void check_round_trip(const frame_t* frame)
+{
+    char encoded[FRAME_ENCODED_MAX_LENGTH];
+    uint8_t length;
+    uint8_t i;
+    uint8_t nb_frames = 0;
+    frame_decoder_t decoder;
+    frame_t decoded;
+
+    length = frame_encode(encoded, frame->data, frame->length);
+
+    FUZZ_CHECK(length < FRAME_ENCODED_MAX_LENGTH);
+    FUZZ_CHECK(encoded[length] == '\0');
+    FUZZ_CHECK(strlen(encoded) == length);
+
+    frame_decoder_init(&decoder);
+
+    for(i = 0; i < length; i++)
+    {
+        if(frame_decoder_push(&decoder, (uint8_t)encoded[i], &decoded))
+        {
+            nb_frames++;
+            FUZZ_CHECK(i == length - 1);
+        }
+    }
+
+    FUZZ_CHECK(nb_frames == 1);
+    FUZZ_CHECK(decoded.length == frame->length);
+    FUZZ_CHECK(memcmp(decoded.data, frame->data, frame->length) == 0);
+}
+
+/**
+    \brief remplit un flux de trames de commande a la suite, comme celui de la manette
+*/
+static void fill_commands(uint8_t* stream, size_t size)
+{
+    size_t used = 0;
+    uint8_t seq = 0;
+    uint8_t command[5];
+    char encoded[FRAME_ENCODED_MAX_LENGTH];
+    uint8_t length;
+
+    while(used < size)
+    {
+        command[0] = FRAME_TYPE_COMMAND;
+        command[1] = random_next();
+        command[2] = random_next();
+        command[3] = random_next();
+        command[4] = seq++;
+        length = frame_encode(encoded, command, sizeof(command));
+
+        if(length > size - used)
+        {
+            length = size - used;
+        }
+
+        memcpy(&stream[used], encoded, length);
+        used += length;
+    }
+}
+
+static void bench_stream(const char* name, const uint8_t* stream, size_t size, double duration)
+{
+    frame_decoder_t decoder;
+    frame_t frame;
+    size_t i;
+    uint32_t nb_frames = 0;
+    uint32_t nb_passes = 0;
+    double start = now_s();
+    double elapsed;
+
+    frame_decoder_init(&decoder);
+
+    do
+    {
+        for(i = 0; i < size; i++)
+        {
+            nb_frames += frame_decoder_push(&decoder, stream[i], &frame);
+        }
+
+        nb_passes++;
+        elapsed = now_s() - start;
+    }while(elapsed < duration);
+
+    sink += nb_frames;
+
+    printf("%-12s %10.1f Mo/s %10.1f ns/byte %12.0f trames/s\n", name,
+           size * (double)nb_passes / elapsed / 1e6, elapsed * 1e9 / (size * (double)nb_passes),
+           nb_frames / elapsed);
+}
+
+static int bench(double duration)
+{
+    uint8_t* stream = malloc(FUZZ_BENCH_LENGTH);
+    size_t i;
+
+    if(stream == NULL)
+    {
+        return 1;
+    }
+
+    printf("%-12s %15s %18s %19s\n", "flux", "debit", "temps", "trames");
+
+    fill_commands(stream, FUZZ_BENCH_LENGTH);
+    bench_stream("commandes", stream, FUZZ_BENCH_LENGTH, duration);
+
+    for(i = 0; i < FUZZ_BENCH_LENGTH; i++)
+    {
+        stream[i] = random_next();
+    }
+    bench_stream("aleatoire", stream, FUZZ_BENCH_LENGTH, duration);
+
+    free(stream);
+
+    return 0;
+}
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    frame_decoder_t decoder;
+    frame_t frame;
+    frame_t previous;
+    reference_t reference = {0};
+    bool complete;
+    size_t i;
+
+    // un motif connu permet de voir si une trame partielle change la longueur de la trame
+    memset(&frame, 0x5A, sizeof(frame));
+    previous = frame;
+
+    frame_decoder_init(&decoder);
+
+    for(i = 0; i < size; i++)
+    {
+        complete = frame_decoder_push(&decoder, data[i], &frame);
+
+        FUZZ_CHECK(complete == TRUE || complete == FALSE);
+        FUZZ_CHECK(decoder.state == FRAME_REJECT_STATE || decoder.state == FRAME_ESCAPE_STATE ||
+                   decoder.state == FRAME_ACCEPT_STATE);
+        FUZZ_CHECK(decoder.in_data_write == TRUE || decoder.in_data_write == FALSE);
+        FUZZ_CHECK(decoder.index <= FRAME_MAX_LENGTH);
+        FUZZ_CHECK(complete == reference_push(&reference, data[i]));
+
+        if(complete)
+        {
+            FUZZ_CHECK(frame.length <= FRAME_MAX_LENGTH);
+            FUZZ_CHECK(frame.length == reference.length);
+            FUZZ_CHECK(memcmp(frame.data, reference.data, frame.length) == 0);
+            check_round_trip(&frame);
+            previous = frame;
+        }
+        else
+        {
+            FUZZ_CHECK(frame.length == previous.length);
+        }
+    }
+
+    return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+
+/******************************************************************************
+Static functions du programme autonome
+******************************************************************************/
+static size_t read_file(const char* path, uint8_t* data)
+{
+    FILE* file = (path == NULL) ? stdin : fopen(path, "rb");
+    size_t size;
+
+    if(file == NULL)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    size = fread(data, 1, FUZZ_MAX_INPUT, file);
+
+    if(file != stdin)
+    {
+        fclose(file);
+    }
+
+    return size;
+}
+
+/**
+    \brief rejoue un fichier, ou chaque fichier d'un dossier
+    \return le nombre d'entrees rejouees
+*/
+static uint32_t replay(const char* path, uint8_t* data)
+{
+    struct stat info;
+    DIR* directory;
+    struct dirent* entry;
+    char child[1024];
+    uint32_t nb_inputs = 0;
+
+    if(stat(path, &info) != 0)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    if(!S_ISDIR(info.st_mode))
+    {
+        LLVMFuzzerTestOneInput(data, read_file(path, data));
+
+        return 1;
+    }
+
+    directory = opendir(path);
+
+    while((entry = readdir(directory)) != NULL)
+    {
+        if(entry->d_name[0] != '.')
+        {
+            snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+            nb_inputs += replay(child, data);
+        }
+    }
+
+    closedir(directory);
+
+    return nb_inputs;
+}
+
+/**
+    \brief modifie une entree au hasard, en favorisant les bytes du protocole
+*/
+static size_t mutate(uint8_t* data, size_t size)
+{
+    static const uint8_t interesting[] = {FRAME_ESCAPE, FRAME_BEGIN, FRAME_END, FRAME_ZERO_VALUE,
+                                          0, 0xFF, FRAME_TYPE_COMMAND, FRAME_TYPE_STATUS};
+    uint32_t nb_mutations = 1 + random_next() % 8;
+    uint32_t i;
+    size_t position;
+    size_t length;
+
+    for(i = 0; i < nb_mutations; i++)
+    {
+        position = size ? random_next() % size : 0;
+
+        switch(random_next() % 6)
+        {
+            // remplace un byte
+            case 0:
+                if(size)
+                {
+                    data[position] = random_next();
+                }
+                break;
+
+            // remplace un byte par un byte du protocole
+            case 1:
+                if(size)
+                {
+                    data[position] = interesting[random_next() % sizeof(interesting)];
+                }
+                break;
+
+            // insere un byte du protocole
+            case 2:
+                if(size < FUZZ_MAX_INPUT)
+                {
+                    memmove(&data[position + 1], &data[position], size - position);
+                    data[position] = interesting[random_next() % sizeof(interesting)];
+                    size++;
+                }
+                break;
+
+            // retire des bytes
+            case 3:
+                length = random_next() % 4;
+                if(position + length <= size)
+                {
+                    memmove(&data[position], &data[position + length], size - position - length);
+                    size -= length;
+                }
+                break;
+
+            // repete un bloc, pour depasser FRAME_MAX_LENGTH
+            case 4:
+                length = random_next() % 48;
+                if(position + length <= size && size + length <= FUZZ_MAX_INPUT)
+                {
+                    memmove(&data[position + length], &data[position], size - position);
+                    size += length;
+                }
+                break;
+
+            // coupe l'entree
+            default:
+                size = position;
+                break;
+        }
+    }
+
+    return size;
+}
+
+/**
+    \brief fuzzing sans outil externe: mutations aleatoires des entrees du corpus
+*/
+static int random_fuzz(double duration, uint8_t* data, int nb_seeds, char** seeds)
+{
+    static uint8_t corpus[64][FUZZ_MAX_INPUT];
+    static size_t corpus_sizes[64];
+    uint32_t nb_corpus = 0;
+    uint32_t nb_inputs = 0;
+    size_t size;
+    double start = now_s();
+    DIR* directory;
+    struct dirent* entry;
+    char child[1024];
+    int i;
+
+    for(i = 0; i < nb_seeds; i++)
+    {
+        directory = opendir(seeds[i]);
+
+        while(directory != NULL && (entry = readdir(directory)) != NULL && nb_corpus < 64)
+        {
+            if(entry->d_name[0] != '.')
+            {
+                snprintf(child, sizeof(child), "%s/%s", seeds[i], entry->d_name);
+                corpus_sizes[nb_corpus] = read_file(child, corpus[nb_corpus]);
+                nb_corpus++;
+            }
+        }
+
+        if(directory != NULL)
+        {
+            closedir(directory);
+        }
+    }
+
+    while(now_s() - start < duration)
+    {
+        if(nb_corpus)
+        {
+            i = random_next() % nb_corpus;
+            size = corpus_sizes[i];
+            memcpy(data, corpus[i], size);
+        }
+        else
+        {
+            size = random_next() % 128;
+            memset(data, FRAME_ESCAPE, size);
+        }
+
+        size = mutate(data, size);
+        LLVMFuzzerTestOneInput(data, size);
+        nb_inputs++;
+    }
+
+    printf("%u entrees aleatoires a partir de %u germes, aucune erreur\n", nb_inputs, nb_corpus);
+
+    return 0;
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    static uint8_t data[FUZZ_MAX_INPUT];
+    uint32_t nb_inputs = 0;
+    int i;
+
+    if(argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+        return bench(argc > 2 ? atof(argv[2]) : 1.0);
+    }
+
+    if(argc > 1 && strcmp(argv[1], "-r") == 0)
+    {
+        i = 3;
+
+        if(argc > 4 && strcmp(argv[3], "-s") == 0)
+        {
+            random_state = strtoul(argv[4], NULL, 0) | 1;
+            i = 5;
+        }
+
+        return random_fuzz(argc > 2 ? atof(argv[2]) : 10.0, data, argc - i, &argv[i]);
+    }
+
+    // AFL donne l'entree sur l'entree standard
+    if(argc == 1)
+    {
+        LLVMFuzzerTestOneInput(data, read_file(NULL, data));
+
+        return 0;
+    }
+
+    for(i = 1; i < argc; i++)
+    {
+        nb_inputs += replay(argv[i], data);
+    }
+
+    printf("%u entrees rejouees, aucune erreur\n", nb_inputs);
+
+    return 0;
+}
+
+#endif
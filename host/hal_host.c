@@ -0,0 +1,303 @@
+/**
+	\file hal_host.c
+	\brief registres de l'ATmega32 simules en memoire pour compiler les modules sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stddef.h>
+
+#include "hal.h"
+
+/******************************************************************************
+Variables
+******************************************************************************/
+uint8_t hal_host_free_ram[HAL_HOST_FREE_RAM_LENGTH];
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static volatile uint8_t regs8[HAL_NB_REGS8];
+static volatile uint16_t regs16[HAL_NB_REGS16];
+
+// derniere valeur connue de chaque registre, pour detecter les ecritures
+static uint8_t shadows8[HAL_NB_REGS8];
+static uint16_t shadows16[HAL_NB_REGS16];
+
+static uint32_t accesses8[HAL_NB_REGS8];
+static uint32_t accesses16[HAL_NB_REGS16];
+static uint32_t writes8[HAL_NB_REGS8];
+static uint32_t writes16[HAL_NB_REGS16];
+static uint32_t total_accesses;
+static uint32_t total_delay_us;
+
+static hal_host_observer_t observer;
+static hal_host_delay_hook_t delay_hook;
+static hal_host_access_hook_t access_hook;
+
+// empeche l'observateur de declencher une autre detection s'il utilise les registres
+static int committing;
+
+// empeche le hook des acces de s'appeler lui-meme
+static int in_access_hook;
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static void call_access_hook(void);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+volatile uint8_t* hal_host_reg8(hal_reg8_enum reg)
+{
+    call_access_hook();
+    hal_host_commit();
+
+    accesses8[reg]++;
+    total_accesses++;
+
+    return &regs8[reg];
+}
+
+volatile uint16_t* hal_host_reg16(hal_reg16_enum reg)
+{
+    call_access_hook();
+    hal_host_commit();
+
+    accesses16[reg]++;
+    total_accesses++;
+
+    return &regs16[reg];
+}
+
+void hal_host_reset(void)
+{
+    int i;
+
+    for(i = 0; i < HAL_NB_REGS8; i++)
+    {
+        regs8[i] = 0;
+        shadows8[i] = 0;
+        accesses8[i] = 0;
+        writes8[i] = 0;
+    }
+
+    for(i = 0; i < HAL_NB_REGS16; i++)
+    {
+        regs16[i] = 0;
+        shadows16[i] = 0;
+        accesses16[i] = 0;
+        writes16[i] = 0;
+    }
+
+    // la pile commence a la fin de la RAM, comme apres un reset
+    regs16[HAL_SP] = RAMEND;
+    shadows16[HAL_SP] = RAMEND;
+
+    total_accesses = 0;
+    total_delay_us = 0;
+    observer = NULL;
+    delay_hook = NULL;
+    access_hook = NULL;
+    committing = 0;
+    in_access_hook = 0;
+}
+
+void hal_host_commit(void)
+{
+    int i;
+    uint8_t changed[HAL_NB_REGS8];
+    uint8_t old_values[HAL_NB_REGS8];
+
+    if(committing)
+    {
+        return;
+    }
+
+    committing = 1;
+
+    // toutes les ecritures du code sont relevees avant que l'observateur ne modifie les registres
+    for(i = 0; i < HAL_NB_REGS8; i++)
+    {
+        changed[i] = (regs8[i] != shadows8[i]);
+        old_values[i] = shadows8[i];
+
+        if(changed[i])
+        {
+            writes8[i]++;
+            shadows8[i] = regs8[i];
+        }
+    }
+
+    for(i = 0; i < HAL_NB_REGS16; i++)
+    {
+        if(regs16[i] != shadows16[i])
+        {
+            writes16[i]++;
+            shadows16[i] = regs16[i];
+        }
+    }
+
+    if(observer != NULL)
+    {
+        for(i = 0; i < HAL_NB_REGS8; i++)
+        {
+            if(changed[i])
+            {
+                observer((hal_reg8_enum)i, old_values[i], regs8[i]);
+            }
+        }
+
+        // les modifications de l'observateur ne sont pas des ecritures du code
+        for(i = 0; i < HAL_NB_REGS8; i++)
+        {
+            shadows8[i] = regs8[i];
+        }
+
+        for(i = 0; i < HAL_NB_REGS16; i++)
+        {
+            shadows16[i] = regs16[i];
+        }
+    }
+
+    committing = 0;
+}
+
+uint8_t hal_host_peek8(hal_reg8_enum reg)
+{
+    return regs8[reg];
+}
+
+void hal_host_poke8(hal_reg8_enum reg, uint8_t value)
+{
+    hal_host_commit();
+
+    regs8[reg] = value;
+    shadows8[reg] = value;
+}
+
+uint16_t hal_host_peek16(hal_reg16_enum reg)
+{
+    return regs16[reg];
+}
+
+void hal_host_poke16(hal_reg16_enum reg, uint16_t value)
+{
+    hal_host_commit();
+
+    regs16[reg] = value;
+    shadows16[reg] = value;
+}
+
+void hal_host_run_isr(void (*vector)(void))
+{
+    uint8_t sreg;
+
+    hal_host_commit();
+
+    sreg = regs8[HAL_SREG];
+    hal_host_poke8(HAL_SREG, sreg & ~(1 << SREG_I));
+
+    vector();
+
+    hal_host_poke8(HAL_SREG, sreg);
+}
+
+void hal_host_set_observer(hal_host_observer_t new_observer)
+{
+    hal_host_commit();
+
+    observer = new_observer;
+}
+
+void hal_host_set_delay_hook(hal_host_delay_hook_t hook)
+{
+    delay_hook = hook;
+}
+
+void hal_host_set_access_hook(hal_host_access_hook_t hook)
+{
+    access_hook = hook;
+}
+
+uint32_t hal_host_get_accesses8(hal_reg8_enum reg)
+{
+    return accesses8[reg];
+}
+
+uint32_t hal_host_get_accesses16(hal_reg16_enum reg)
+{
+    return accesses16[reg];
+}
+
+uint32_t hal_host_get_writes8(hal_reg8_enum reg)
+{
+    hal_host_commit();
+
+    return writes8[reg];
+}
+
+uint32_t hal_host_get_total_accesses(void)
+{
+    return total_accesses;
+}
+
+uint32_t hal_host_get_delay_us(void)
+{
+    return total_delay_us;
+}
+
+void hal_host_sei(void)
+{
+    hal_host_commit();
+
+    regs8[HAL_SREG] |= (1 << SREG_I);
+    shadows8[HAL_SREG] = regs8[HAL_SREG];
+}
+
+void hal_host_cli(void)
+{
+    hal_host_commit();
+
+    regs8[HAL_SREG] &= ~(1 << SREG_I);
+    shadows8[HAL_SREG] = regs8[HAL_SREG];
+}
+
+void hal_host_delay_us(uint32_t us)
+{
+    hal_host_commit();
+
+    total_delay_us += us;
+
+    if(delay_hook != NULL)
+    {
+        delay_hook(us);
+    }
+}
+
+void hal_host_spin(void)
+{
+    hal_host_commit();
+    call_access_hook();
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static void call_access_hook(void)
+{
+    // l'observateur et le hook lui-meme peuvent utiliser les registres
+    if(access_hook == NULL || committing || in_access_hook)
+    {
+        return;
+    }
+
+    in_access_hook = 1;
+    access_hook();
+    in_access_hook = 0;
+}
@@ -0,0 +1,445 @@
+#ifndef HAL_HOST_H_INCLUDED
+#define HAL_HOST_H_INCLUDED
+
+/**
+	\file hal_host.h
+	\brief registres de l'ATmega32 simules en memoire pour compiler les modules sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Inclus par hal.h quand HAL_HOST est defini. Chaque registre (PORTC, OCR1A, UDR, ...) devient
+    une case d'un tableau en memoire, donc le code des modules compile sans changement.
+
+    Chaque acces a un registre passe par hal_host_reg8 ou hal_host_reg16, qui compte les acces.
+    Une ecriture ne peut pas etre vue au moment ou elle se produit, elle est detectee au prochain
+    acces a un registre (ou a la prochaine attente, sei, cli ou hal_host_commit) en comparant le
+    registre avec sa derniere valeur connue. L'observateur installe avec hal_host_set_observer
+    est alors appele avec l'ancienne et la nouvelle valeur, ce qui permet de simuler un
+    peripherique (fin de conversion de l'ADC, broche E du LCD, ...). Une ecriture qui ne change
+    pas la valeur du registre n'est pas vue.
+
+    Les interruptions deviennent des fonctions ordinaires (USART_RXC_vect(), ...) que le test
+    appelle lui-meme. Les attentes (_delay_ms, _delay_us) appellent le hook installe avec
+    hal_host_set_delay_hook au lieu d'attendre.
+
+    Le hook installe avec hal_host_set_access_hook est appele avant chaque acces du code a un
+    registre. Un simulateur peut y faire avancer le temps et y executer les interruptions, comme
+    le microcontroleur le ferait entre deux instructions (voir host/mcu_sim.c). Les acces faits
+    pendant le hook (par une interruption, par exemple) n'appellent pas le hook de nouveau.
+    Les boucles qui attendent une interruption sans toucher aux registres appellent hal_spin()
+    a chaque tour, qui appelle aussi ce hook.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief registres de 8 bits simules
+*/
+typedef enum
+{
+    HAL_PINA, HAL_DDRA, HAL_PORTA,
+    HAL_PINB, HAL_DDRB, HAL_PORTB,
+    HAL_PINC, HAL_DDRC, HAL_PORTC,
+    HAL_PIND, HAL_DDRD, HAL_PORTD,
+    HAL_ADMUX, HAL_ADCSRA, HAL_ADCL, HAL_ADCH,
+    HAL_TCCR0, HAL_TCNT0, HAL_OCR0,
+    HAL_TCCR1A, HAL_TCCR1B,
+    HAL_TCCR2, HAL_TCNT2, HAL_OCR2, HAL_ASSR,
+    HAL_TIMSK, HAL_TIFR,
+    HAL_UCSRA, HAL_UCSRB, HAL_UCSRC, HAL_UBRRL, HAL_UBRRH, HAL_UDR,
+    HAL_EECR, HAL_EEDR,
+    HAL_OSCCAL, HAL_MCUCSR, HAL_SREG,
+    HAL_NB_REGS8
+}hal_reg8_enum;
+
+/**
+    \brief registres de 16 bits simules
+*/
+typedef enum
+{
+    HAL_TCNT1, HAL_OCR1A, HAL_OCR1B, HAL_ICR1,
+    HAL_EEAR, HAL_SP,
+    HAL_NB_REGS16
+}hal_reg16_enum;
+
+/**
+    \brief appele quand une ecriture a change un registre de 8 bits
+    \param[in] reg le registre
+    \param[in] old_value la valeur avant l'ecriture
+    \param[in] new_value la valeur apres l'ecriture, le registre peut encore etre modifie
+*/
+typedef void (*hal_host_observer_t)(hal_reg8_enum reg, uint8_t old_value, uint8_t new_value);
+
+/**
+    \brief appele a la place de _delay_ms et _delay_us
+    \param[in] us la duree demandee
+*/
+typedef void (*hal_host_delay_hook_t)(uint32_t us);
+
+/**
+    \brief appele avant chaque acces du code a un registre
+*/
+typedef void (*hal_host_access_hook_t)(void);
+
+/******************************************************************************
+Registres
+******************************************************************************/
+#define PINA    (*hal_host_reg8(HAL_PINA))
+#define DDRA    (*hal_host_reg8(HAL_DDRA))
+#define PORTA   (*hal_host_reg8(HAL_PORTA))
+#define PINB    (*hal_host_reg8(HAL_PINB))
+#define DDRB    (*hal_host_reg8(HAL_DDRB))
+#define PORTB   (*hal_host_reg8(HAL_PORTB))
+#define PINC    (*hal_host_reg8(HAL_PINC))
+#define DDRC    (*hal_host_reg8(HAL_DDRC))
+#define PORTC   (*hal_host_reg8(HAL_PORTC))
+#define PIND    (*hal_host_reg8(HAL_PIND))
+#define DDRD    (*hal_host_reg8(HAL_DDRD))
+#define PORTD   (*hal_host_reg8(HAL_PORTD))
+#define ADMUX   (*hal_host_reg8(HAL_ADMUX))
+#define ADCSRA  (*hal_host_reg8(HAL_ADCSRA))
+#define ADCL    (*hal_host_reg8(HAL_ADCL))
+#define ADCH    (*hal_host_reg8(HAL_ADCH))
+#define TCCR0   (*hal_host_reg8(HAL_TCCR0))
+#define TCNT0   (*hal_host_reg8(HAL_TCNT0))
+#define OCR0    (*hal_host_reg8(HAL_OCR0))
+#define TCCR1A  (*hal_host_reg8(HAL_TCCR1A))
+#define TCCR1B  (*hal_host_reg8(HAL_TCCR1B))
+#define TCCR2   (*hal_host_reg8(HAL_TCCR2))
+#define TCNT2   (*hal_host_reg8(HAL_TCNT2))
+#define OCR2    (*hal_host_reg8(HAL_OCR2))
+#define ASSR    (*hal_host_reg8(HAL_ASSR))
+#define TIMSK   (*hal_host_reg8(HAL_TIMSK))
+#define TIFR    (*hal_host_reg8(HAL_TIFR))
+#define UCSRA   (*hal_host_reg8(HAL_UCSRA))
+#define UCSRB   (*hal_host_reg8(HAL_UCSRB))
+#define UCSRC   (*hal_host_reg8(HAL_UCSRC))
+#define UBRRL   (*hal_host_reg8(HAL_UBRRL))
+#define UBRRH   (*hal_host_reg8(HAL_UBRRH))
+#define UDR     (*hal_host_reg8(HAL_UDR))
+#define EECR    (*hal_host_reg8(HAL_EECR))
+#define EEDR    (*hal_host_reg8(HAL_EEDR))
+#define OSCCAL  (*hal_host_reg8(HAL_OSCCAL))
+#define MCUCSR  (*hal_host_reg8(HAL_MCUCSR))
+#define SREG    (*hal_host_reg8(HAL_SREG))
+
+#define TCNT1   (*hal_host_reg16(HAL_TCNT1))
+#define OCR1A   (*hal_host_reg16(HAL_OCR1A))
+#define OCR1B   (*hal_host_reg16(HAL_OCR1B))
+#define ICR1    (*hal_host_reg16(HAL_ICR1))
+#define EEAR    (*hal_host_reg16(HAL_EEAR))
+#define SP      (*hal_host_reg16(HAL_SP))
+
+#define RAMSTART    0x60
+#define RAMEND      0x85F
+
+/******************************************************************************
+Bits des registres (datasheet ATmega32)
+******************************************************************************/
+#define PA0 0
+#define PA1 1
+#define PA2 2
+#define PA3 3
+#define PA4 4
+#define PA5 5
+#define PA6 6
+#define PA7 7
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PC7 7
+
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+// ADMUX
+#define MUX0    0
+#define MUX1    1
+#define MUX2    2
+#define MUX3    3
+#define MUX4    4
+#define ADLAR   5
+#define REFS0   6
+#define REFS1   7
+
+// ADCSRA
+#define ADPS0   0
+#define ADPS1   1
+#define ADPS2   2
+#define ADIE    3
+#define ADIF    4
+#define ADATE   5
+#define ADSC    6
+#define ADEN    7
+
+// TCCR0
+#define CS00    0
+#define CS01    1
+#define CS02    2
+#define WGM01   3
+#define COM00   4
+#define COM01   5
+#define WGM00   6
+#define FOC0    7
+
+// TCCR1A
+#define WGM10   0
+#define WGM11   1
+#define FOC1B   2
+#define FOC1A   3
+#define COM1B0  4
+#define COM1B1  5
+#define COM1A0  6
+#define COM1A1  7
+
+// TCCR1B
+#define CS10    0
+#define CS11    1
+#define CS12    2
+#define WGM12   3
+#define WGM13   4
+#define ICES1   6
+#define ICNC1   7
+
+// TCCR2
+#define CS20    0
+#define CS21    1
+#define CS22    2
+#define WGM21   3
+#define COM20   4
+#define COM21   5
+#define WGM20   6
+#define FOC2    7
+
+// TIMSK
+#define TOIE0   0
+#define OCIE0   1
+#define TOIE1   2
+#define OCIE1B  3
+#define OCIE1A  4
+#define TICIE1  5
+#define TOIE2   6
+#define OCIE2   7
+
+// TIFR
+#define TOV0    0
+#define OCF0    1
+#define TOV1    2
+#define OCF1B   3
+#define OCF1A   4
+#define ICF1    5
+#define TOV2    6
+#define OCF2    7
+
+// UCSRA
+#define MPCM    0
+#define U2X     1
+#define PE      2
+#define DOR     3
+#define FE      4
+#define UDRE    5
+#define TXC     6
+#define RXC     7
+
+// UCSRB
+#define TXB8    0
+#define RXB8    1
+#define UCSZ2   2
+#define TXEN    3
+#define RXEN    4
+#define UDRIE   5
+#define TXCIE   6
+#define RXCIE   7
+
+// UCSRC
+#define UCPOL   0
+#define UCSZ0   1
+#define UCSZ1   2
+#define USBS    3
+#define UPM0    4
+#define UPM1    5
+#define UMSEL   6
+#define URSEL   7
+
+// EECR
+#define EERE    0
+#define EEWE    1
+#define EEMWE   2
+#define EERIE   3
+
+// SREG
+#define SREG_I  7
+
+/******************************************************************************
+Interruptions et attentes
+******************************************************************************/
+#define ISR(vector) void vector(void)
+
+#define sei() hal_host_sei()
+#define cli() hal_host_cli()
+
+#define _delay_ms(ms) hal_host_delay_us((uint32_t)((ms) * 1000UL))
+#define _delay_us(us) hal_host_delay_us((uint32_t)(us))
+
+#define hal_spin() hal_host_spin()
+
+/******************************************************************************
+Memoire programme
+******************************************************************************/
+// il n'y a qu'un espace d'adresses sur PC, les constantes "en flash" sont en memoire ordinaire
+#define PROGMEM
+#define PSTR(string) (string)
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+
+/******************************************************************************
+Memoire vive
+******************************************************************************/
+/**
+    \brief taille de la RAM libre simulee, entre les variables (_end) et le haut de la pile
+*/
+#define HAL_HOST_FREE_RAM_LENGTH 1024
+
+// la pile du PC n'est pas celle du firmware: stack.c peint et mesure ce tableau, que les tests
+// remplissent eux-memes pour simuler une pile
+extern uint8_t hal_host_free_ram[HAL_HOST_FREE_RAM_LENGTH];
+
+// interruptions utilisees par les modules, appelees directement par les tests
+void USART_RXC_vect(void);
+void USART_UDRE_vect(void);
+void TIMER1_OVF_vect(void);
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief acces a un registre de 8 bits, utilise par les macros de registres
+    \param[in] reg le registre
+    \return l'adresse du registre dans le fichier de registres
+*/
+volatile uint8_t* hal_host_reg8(hal_reg8_enum reg);
+
+/**
+    \brief acces a un registre de 16 bits, utilise par les macros de registres
+    \param[in] reg le registre
+    \return l'adresse du registre dans le fichier de registres
+*/
+volatile uint16_t* hal_host_reg16(hal_reg16_enum reg);
+
+/**
+    \brief met tous les registres et les compteurs a 0 et retire les hooks
+    \return void
+*/
+void hal_host_reset(void);
+
+/**
+    \brief detecte les ecritures qui n'ont pas encore ete vues et appelle l'observateur
+    \return void
+*/
+void hal_host_commit(void);
+
+/**
+    \brief lit un registre de 8 bits sans compter l'acces, pour les peripheriques simules
+*/
+uint8_t hal_host_peek8(hal_reg8_enum reg);
+
+/**
+    \brief ecrit un registre de 8 bits sans compter l'acces ni appeler l'observateur
+*/
+void hal_host_poke8(hal_reg8_enum reg, uint8_t value);
+
+/**
+    \brief lit un registre de 16 bits sans compter l'acces
+*/
+uint16_t hal_host_peek16(hal_reg16_enum reg);
+
+/**
+    \brief ecrit un registre de 16 bits sans compter l'acces
+*/
+void hal_host_poke16(hal_reg16_enum reg, uint16_t value);
+
+/**
+    \brief execute une interruption comme le ferait le microcontroleur
+    \param[in] vector l'interruption, par exemple USART_RXC_vect
+    \return void
+
+    les interruptions sont masquees pendant l'execution, puis SREG est restaure
+*/
+void hal_host_run_isr(void (*vector)(void));
+
+/**
+    \brief installe l'observateur des ecritures, NULL pour le retirer
+    \return void
+*/
+void hal_host_set_observer(hal_host_observer_t observer);
+
+/**
+    \brief installe le hook des attentes, NULL pour le retirer
+    \return void
+*/
+void hal_host_set_delay_hook(hal_host_delay_hook_t hook);
+
+/**
+    \brief installe le hook des acces aux registres, NULL pour le retirer
+    \return void
+*/
+void hal_host_set_access_hook(hal_host_access_hook_t hook);
+
+/**
+    \brief retourne le nombre d'acces (lectures et ecritures) a un registre de 8 bits
+*/
+uint32_t hal_host_get_accesses8(hal_reg8_enum reg);
+
+/**
+    \brief retourne le nombre d'acces (lectures et ecritures) a un registre de 16 bits
+*/
+uint32_t hal_host_get_accesses16(hal_reg16_enum reg);
+
+/**
+    \brief retourne le nombre d'ecritures qui ont change un registre de 8 bits
+*/
+uint32_t hal_host_get_writes8(hal_reg8_enum reg);
+
+/**
+    \brief retourne le nombre d'acces a tous les registres depuis hal_host_reset
+*/
+uint32_t hal_host_get_total_accesses(void);
+
+/**
+    \brief retourne la somme des durees demandees a _delay_ms et _delay_us, en us
+*/
+uint32_t hal_host_get_delay_us(void);
+
+void hal_host_sei(void);
+void hal_host_cli(void);
+void hal_host_delay_us(uint32_t us);
+void hal_host_spin(void);
+
+#endif
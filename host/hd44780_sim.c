@@ -0,0 +1,370 @@
+/**
+	\file hd44780_sim.c
+	\brief emulateur de l'afficheur HD44780 16x2 branche sur les registres simules, sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <string.h>
+
+#include "lcd.h"
+#include "host/hd44780_sim.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+// registres de lcd.h: DATA_PORT et CTRL_PORT
+#define SIM_DATA_PORT HAL_PORTC
+#define SIM_CTRL_PORT HAL_PORTA
+
+#define LINE_2_ADDRESS 0x40
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static uint8_t ddram[HD44780_SIM_DDRAM_LENGTH];
+static uint8_t cgram[HD44780_SIM_CGRAM_LENGTH];
+
+static uint8_t address;
+static bool in_cgram;
+static bool increment;
+static bool shift_display;
+static int8_t display_shift;
+static bool display_on;
+static bool cursor_on;
+static bool blink_on;
+static bool eight_bits;
+static bool two_lines;
+
+// heure a laquelle l'instruction en cours sera terminee
+static uint32_t busy_until;
+
+// heure du dernier changement de RS ou des donnees
+static uint32_t setup_at;
+
+static hd44780_sim_counters_t counters;
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static void move_address(bool forward);
+static uint32_t execute_command(uint8_t command);
+static void write_data(uint8_t data);
+static void transaction(uint8_t ctrl);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void hd44780_sim_init(void)
+{
+    // a la mise sous tension, le controleur fait lui-meme un clear display en mode 8 bits
+    memset(ddram, ' ', sizeof(ddram));
+    memset(cgram, 0, sizeof(cgram));
+
+    address = 0;
+    in_cgram = FALSE;
+    increment = TRUE;
+    shift_display = FALSE;
+    display_shift = 0;
+    display_on = FALSE;
+    cursor_on = FALSE;
+    blink_on = FALSE;
+    eight_bits = TRUE;
+    two_lines = FALSE;
+    busy_until = hal_host_get_delay_us();
+    setup_at = hal_host_get_delay_us();
+
+    hd44780_sim_reset_counters();
+    hal_host_set_observer(hd44780_sim_observe);
+}
+
+void hd44780_sim_observe(hal_reg8_enum reg, uint8_t old_value, uint8_t new_value)
+{
+    if(reg == SIM_DATA_PORT)
+    {
+        setup_at = hal_host_get_delay_us();
+    }
+    else if(reg == SIM_CTRL_PORT)
+    {
+        if(read_bit(old_value ^ new_value, RS_PIN) || read_bit(old_value ^ new_value, RW_PIN))
+        {
+            setup_at = hal_host_get_delay_us();
+        }
+
+        // le HD44780 lit le bus sur le front descendant de E
+        if(read_bit(old_value, E_PIN) && !read_bit(new_value, E_PIN))
+        {
+            transaction(new_value);
+        }
+    }
+}
+
+void hd44780_sim_reset_counters(void)
+{
+    memset(&counters, 0, sizeof(counters));
+    counters.bus_us = hal_host_get_delay_us();
+}
+
+void hd44780_sim_get_counters(hd44780_sim_counters_t* out)
+{
+    *out = counters;
+    out->bus_us = hal_host_get_delay_us() - counters.bus_us;
+}
+
+void hd44780_sim_get_row(uint8_t row, char* text)
+{
+    uint8_t col;
+    uint8_t base = row ? LINE_2_ADDRESS : 0;
+    int16_t offset;
+
+    for(col = 0; col < LCD_NB_COL; col++)
+    {
+        // un decalage de l'affichage deplace la fenetre sur les 40 caracteres de la ligne
+        offset = (col + display_shift) % HD44780_SIM_LINE_LENGTH;
+
+        if(offset < 0)
+        {
+            offset += HD44780_SIM_LINE_LENGTH;
+        }
+
+        text[col] = display_on ? (char)ddram[base + offset] : ' ';
+    }
+
+    text[LCD_NB_COL] = '\0';
+}
+
+bool hd44780_sim_get_cursor(uint8_t* col, uint8_t* row)
+{
+    int16_t offset;
+
+    if(in_cgram)
+    {
+        return FALSE;
+    }
+
+    *row = (address >= LINE_2_ADDRESS) ? 1 : 0;
+    offset = ((address - (*row ? LINE_2_ADDRESS : 0)) - display_shift) % HD44780_SIM_LINE_LENGTH;
+
+    if(offset < 0)
+    {
+        offset += HD44780_SIM_LINE_LENGTH;
+    }
+
+    *col = (uint8_t)offset;
+
+    return offset < LCD_NB_COL;
+}
+
+uint8_t hd44780_sim_get_address(void)
+{
+    return address;
+}
+
+bool hd44780_sim_is_increment(void)
+{
+    return increment;
+}
+
+bool hd44780_sim_is_display_on(void)
+{
+    return display_on;
+}
+
+bool hd44780_sim_is_cursor_on(void)
+{
+    return cursor_on;
+}
+
+bool hd44780_sim_is_blink_on(void)
+{
+    return blink_on;
+}
+
+bool hd44780_sim_is_configured(void)
+{
+    return eight_bits && two_lines;
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+/**
+    \brief avance ou recule le compteur d'adresse comme le controleur
+*/
+static void move_address(bool forward)
+{
+    if(in_cgram)
+    {
+        address = (address + (forward ? 1 : -1)) & (HD44780_SIM_CGRAM_LENGTH - 1);
+
+        return;
+    }
+
+    // en 2 lignes, la fin de la ligne 1 (0x27) continue au debut de la ligne 2 (0x40)
+    if(forward)
+    {
+        if(address == HD44780_SIM_LINE_LENGTH - 1)
+        {
+            address = LINE_2_ADDRESS;
+        }
+        else if(address == LINE_2_ADDRESS + HD44780_SIM_LINE_LENGTH - 1)
+        {
+            address = 0;
+        }
+        else
+        {
+            address++;
+        }
+    }
+    else
+    {
+        if(address == LINE_2_ADDRESS)
+        {
+            address = HD44780_SIM_LINE_LENGTH - 1;
+        }
+        else if(address == 0)
+        {
+            address = LINE_2_ADDRESS + HD44780_SIM_LINE_LENGTH - 1;
+        }
+        else
+        {
+            address--;
+        }
+    }
+}
+
+/**
+    \brief execute une instruction
+    \return sa duree d'execution
+*/
+static uint32_t execute_command(uint8_t command)
+{
+    // set DDRAM address
+    if(read_bit(command, 7))
+    {
+        address = command & 0x7F;
+        in_cgram = FALSE;
+    }
+    // set CGRAM address
+    else if(read_bit(command, 6))
+    {
+        address = command & 0x3F;
+        in_cgram = TRUE;
+    }
+    // function set
+    else if(read_bit(command, 5))
+    {
+        eight_bits = read_bit(command, 4);
+        two_lines = read_bit(command, 3);
+    }
+    // cursor or display shift
+    else if(read_bit(command, 4))
+    {
+        if(read_bit(command, 3))
+        {
+            display_shift += read_bit(command, 2) ? -1 : 1;
+            display_shift %= HD44780_SIM_LINE_LENGTH;
+        }
+        else
+        {
+            in_cgram = FALSE;
+            move_address(read_bit(command, 2));
+        }
+    }
+    // display on/off control
+    else if(read_bit(command, 3))
+    {
+        display_on = read_bit(command, 2);
+        cursor_on = read_bit(command, 1);
+        blink_on = read_bit(command, 0);
+    }
+    // entry mode set
+    else if(read_bit(command, 2))
+    {
+        increment = read_bit(command, 1);
+        shift_display = read_bit(command, 0);
+    }
+    // return home
+    else if(read_bit(command, 1))
+    {
+        address = 0;
+        in_cgram = FALSE;
+        display_shift = 0;
+
+        return HD44780_SIM_CLEAR_US;
+    }
+    // clear display
+    else if(read_bit(command, 0))
+    {
+        memset(ddram, ' ', sizeof(ddram));
+        address = 0;
+        in_cgram = FALSE;
+        increment = TRUE;
+        display_shift = 0;
+
+        return HD44780_SIM_CLEAR_US;
+    }
+
+    return HD44780_SIM_EXEC_US;
+}
+
+static void write_data(uint8_t data)
+{
+    if(in_cgram)
+    {
+        cgram[address] = data;
+    }
+    else if(address < HD44780_SIM_DDRAM_LENGTH)
+    {
+        ddram[address] = data;
+    }
+
+    move_address(increment);
+
+    // avec S, l'affichage suit le curseur
+    if(shift_display && !in_cgram)
+    {
+        display_shift += increment ? 1 : -1;
+        display_shift %= HD44780_SIM_LINE_LENGTH;
+    }
+}
+
+/**
+    \brief une transaction sur le front descendant de E
+*/
+static void transaction(uint8_t ctrl)
+{
+    uint32_t now = hal_host_get_delay_us();
+    uint8_t data = hal_host_peek8(SIM_DATA_PORT);
+
+    counters.nb_pulses++;
+
+    // le controleur ignore le bus tant qu'il execute l'instruction precedente
+    if((int32_t)(now - busy_until) < 0 || now == setup_at)
+    {
+        counters.nb_timing_errors++;
+    }
+
+    if(read_bit(ctrl, RW_PIN))
+    {
+        counters.nb_reads++;
+
+        return;
+    }
+
+    if(read_bit(ctrl, RS_PIN))
+    {
+        counters.nb_writes++;
+        write_data(data);
+        busy_until = now + HD44780_SIM_EXEC_US;
+    }
+    else
+    {
+        counters.nb_commands++;
+        busy_until = now + execute_command(data);
+    }
+}
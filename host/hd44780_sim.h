@@ -0,0 +1,125 @@
+#ifndef HD44780_SIM_H_INCLUDED
+#define HD44780_SIM_H_INCLUDED
+
+/**
+	\file hd44780_sim.h
+	\brief emulateur de l'afficheur HD44780 16x2 branche sur les registres simules, sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    L'emulateur observe les ecritures de lcd.c dans DATA_PORT (PORTC) et CTRL_PORT (PORTA, broches
+    E, RW et RS) et joue le HD44780 en mode 8 bits: chaque front descendant de E est une
+    transaction qui lit RS, RW et le port de donnees.
+
+    - Instructions: clear display, return home, entry mode (I/D, S), display control (D, C, B),
+      cursor/display shift, function set, adresse CGRAM et DDRAM.
+    - Donnees: ecriture en DDRAM (80 caracteres, lignes a 0x00 et 0x40) ou en CGRAM selon la
+      derniere adresse donnee, le compteur d'adresse suit I/D et passe d'une ligne a l'autre
+      comme le vrai controleur. Les lectures (RW = 1) sont comptees mais ne font rien.
+
+    Le temps est celui des attentes de lcd.c (_delay_ms, _delay_us, hal_host_get_delay_us): le
+    code entre deux attentes ne prend pas de temps. Une transaction est une violation de timing
+    si elle arrive avant la fin de l'execution de la precedente (HD44780_SIM_EXEC_US, ou
+    HD44780_SIM_CLEAR_US pour clear display et return home), ou si RS ou les donnees ont change
+    sans attente avant le front de E.
+
+    Les tests installent l'emulateur avec hd44780_sim_init, qui remplace l'observateur de la HAL.
+    Un test qui a besoin d'un autre observateur (ADC, ...) appelle hd44780_sim_observe dans le
+    sien.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stdint.h>
+
+#include "hal.h"
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define HD44780_SIM_DDRAM_LENGTH 0x68
+#define HD44780_SIM_CGRAM_LENGTH 64
+#define HD44780_SIM_LINE_LENGTH 40
+
+/**
+    \brief duree d'execution des instructions et des ecritures, 37 us + 4 us a 270 kHz
+*/
+#define HD44780_SIM_EXEC_US 41
+
+/**
+    \brief duree d'execution de clear display et de return home
+*/
+#define HD44780_SIM_CLEAR_US 1520
+
+/**
+    \brief compteurs du bus depuis hd44780_sim_init ou hd44780_sim_reset_counters
+*/
+typedef struct
+{
+    // fronts descendants de E
+    uint32_t nb_pulses;
+    uint32_t nb_commands;
+    uint32_t nb_writes;
+    uint32_t nb_reads;
+
+    // transactions trop rapprochees, ou donnees pas stables avant le front de E
+    uint32_t nb_timing_errors;
+
+    // temps passe dans les attentes de la HAL, en us
+    uint32_t bus_us;
+}hd44780_sim_counters_t;
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief met l'afficheur dans son etat de mise sous tension et installe l'observateur
+    \return void
+
+    a appeler apres hal_host_reset
+*/
+void hd44780_sim_init(void);
+
+/**
+    \brief observateur a appeler depuis un autre observateur de la HAL
+*/
+void hd44780_sim_observe(hal_reg8_enum reg, uint8_t old_value, uint8_t new_value);
+
+void hd44780_sim_reset_counters(void);
+void hd44780_sim_get_counters(hd44780_sim_counters_t* counters);
+
+/**
+    \brief copie une ligne visible de l'afficheur
+    \param[in] row 0 ou 1
+    \param[out] text LCD_NB_COL caracteres et le '\0'
+    \return void
+
+    un afficheur eteint (D = 0) donne des espaces
+*/
+void hd44780_sim_get_row(uint8_t row, char* text);
+
+/**
+    \brief position du curseur sur l'afficheur
+    \return FALSE si l'adresse courante est en CGRAM ou hors de la partie visible
+*/
+bool hd44780_sim_get_cursor(uint8_t* col, uint8_t* row);
+
+/**
+    \brief compteur d'adresse (DDRAM ou CGRAM)
+*/
+uint8_t hd44780_sim_get_address(void);
+
+bool hd44780_sim_is_increment(void);
+bool hd44780_sim_is_display_on(void);
+bool hd44780_sim_is_cursor_on(void);
+bool hd44780_sim_is_blink_on(void);
+
+/**
+    \brief TRUE si function set a mis le bus en 8 bits sur 2 lignes, comme lcd.c
+*/
+bool hd44780_sim_is_configured(void);
+
+#endif
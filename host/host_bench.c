@@ -0,0 +1,173 @@
+/**
+	\file host_bench.c
+	\brief mesure la vitesse des modules sur PC avec les registres simules
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: make host && host/host_bench [nombre d'iterations]
+
+    Affiche pour chaque fonction le temps moyen par appel sur le PC et le nombre moyen d'acces aux
+    registres par appel. Le temps sur PC ne dit pas combien de cycles la fonction prend sur
+    l'ATmega32, mais permet de comparer deux versions d'une fonction. Les temps incluent le cout
+    de la simulation des registres.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hal.h"
+#include "utils.h"
+#include "util_29.h"
+#include "fifo.h"
+#include "frame.h"
+#include "uart.h"
+#include "trace.h"
+#include "host/time_stub.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define DEFAULT_ITERATIONS 1000000UL
+
+typedef void (*bench_function_t)(uint32_t i);
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static fifo_t fifo;
+static uint8_t fifo_buffer[64];
+
+static frame_decoder_t decoder;
+static frame_t frame;
+static char encoded[FRAME_ENCODED_MAX_LENGTH];
+static uint8_t encoded_length;
+static uint8_t command[] = {FRAME_TYPE_COMMAND, 128, 'A', 0, 7};
+
+static char string[32];
+
+// empeche le compilateur de retirer les appels dont le resultat n'est pas utilise
+static volatile uint32_t sink;
+
+/******************************************************************************
+Fonctions mesurees
+******************************************************************************/
+static void bench_fifo(uint32_t i)
+{
+    fifo_push(&fifo, (uint8_t)i);
+    sink += fifo_pop(&fifo);
+}
+
+static void bench_frame_encode(uint32_t i)
+{
+    command[1] = (uint8_t)i;
+    sink += frame_encode(encoded, command, sizeof(command));
+}
+
+static void bench_frame_decode(uint32_t i)
+{
+    sink += frame_decoder_push(&decoder, (uint8_t)encoded[i % encoded_length], &frame);
+}
+
+static void bench_uint8_to_string(uint32_t i)
+{
+    sink += uint8_to_string(string, (uint8_t)i);
+}
+
+static void bench_string_concat(uint32_t i)
+{
+    string[0] = '\0';
+    string_concat(string, string, "H123/V045/S");
+    sink += string[0];
+}
+
+static void bench_trace_record(uint32_t i)
+{
+    trace_record(TRACE_ISR_RX, (uint8_t)i);
+}
+
+static void bench_uart_rx_isr(uint32_t i)
+{
+    hal_host_poke8(HAL_UDR, (uint8_t)i);
+    USART_RXC_vect();
+    sink += uart_get_byte();
+}
+
+static void bench_uart_udre_isr(uint32_t i)
+{
+    uart_put_byte((uint8_t)i);
+    USART_UDRE_vect();
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static double now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void run(const char* name, bench_function_t function, uint32_t iterations)
+{
+    uint32_t i;
+    uint32_t accesses;
+    double start;
+    double elapsed;
+
+    accesses = hal_host_get_total_accesses();
+    start = now_ns();
+
+    for(i = 0; i < iterations; i++)
+    {
+        function(i);
+    }
+
+    elapsed = now_ns() - start;
+    accesses = hal_host_get_total_accesses() - accesses;
+
+    printf("%-20s %10.1f %12.2f\n", name, elapsed / iterations, (double)accesses / iterations);
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    uint32_t iterations = DEFAULT_ITERATIONS;
+
+    if(argc > 1)
+    {
+        iterations = strtoul(argv[1], NULL, 0);
+    }
+
+    hal_host_reset();
+    time_init();
+    trace_init();
+    uart_init();
+    sei();
+
+    fifo_init(&fifo, fifo_buffer, sizeof(fifo_buffer));
+    frame_decoder_init(&decoder);
+    encoded_length = frame_encode(encoded, command, sizeof(command));
+
+    printf("%-20s %10s %12s\n", "fonction", "ns/appel", "acces/appel");
+
+    run("fifo_push+pop", bench_fifo, iterations);
+    run("frame_encode", bench_frame_encode, iterations);
+    run("frame_decoder_push", bench_frame_decode, iterations);
+    run("uint8_to_string", bench_uint8_to_string, iterations);
+    run("string_concat", bench_string_concat, iterations);
+    run("trace_record", bench_trace_record, iterations);
+    run("USART_RXC_vect", bench_uart_rx_isr, iterations);
+    run("USART_UDRE_vect", bench_uart_udre_isr, iterations);
+
+    return 0;
+}
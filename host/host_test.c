@@ -0,0 +1,1245 @@
+/**
+	\file host_test.c
+	\brief tests des modules sur PC avec les registres simules
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: make host && host/host_test
+
+    Chaque test remet les registres simules a 0 (hal_host_reset) avant de commencer. Le programme
+    affiche chaque verification qui echoue et retourne 1 si au moins une a echoue.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+#include "utils.h"
+#include "util_29.h"
+#include "fifo.h"
+#include "frame.h"
+#include "uart.h"
+#include "driver.h"
+#include "failsafe.h"
+#include "latency.h"
+#include "trace.h"
+#include "lcd.h"
+#include "stack.h"
+#include "packet.h"
+#include "config.h"
+#include "param.h"
+#include "profile.h"
+#include "launch.h"
+#include "slew.h"
+#include "ramp.h"
+#include "host/hd44780_sim.h"
+#include "host/eeprom_sim.h"
+#include "host/time_stub.h"
+#include "host/mcu_sim.h"
+
+// le vrai time.c, renomme a la compilation pour etre lie a cote de host/time_stub.c (voir Makefile)
+void time_hw_init(void);
+uint32_t time_hw_micros(void);
+uint16_t time_hw_micros16(void);
+void time_hw_overflow_vect(void);
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+/**
+    \brief nombre maximal de trames d'un scenario joue dans le firmware
+*/
+#define FIRMWARE_MAX_STEPS 8
+
+/**
+    \brief une trame envoyee au firmware (aero.c) a une heure donnee
+*/
+typedef struct
+{
+    uint32_t at_us;
+    uint8_t data[FRAME_MAX_LENGTH];
+    uint8_t length;
+}firmware_step_t;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static unsigned nb_checks;
+static unsigned nb_failures;
+
+// valeur convertie par l'ADC simule pour chaque canal
+static uint8_t adc_values[8];
+
+// scenario joue dans le firmware et reponses de celui-ci, par type de trame
+static const firmware_step_t* firmware_steps;
+static uint8_t firmware_nb_steps;
+static uint8_t firmware_next_step;
+static uint32_t firmware_end_us;
+static frame_decoder_t firmware_decoder;
+static frame_t firmware_reply;
+static uint16_t firmware_replies[256];
+
+// reponses de chaque type recues avant AT+CIPSEND, et partie de AT+CIPSEND deja recue
+static uint16_t firmware_replies_before_cipsend[256];
+static uint8_t firmware_cipsend_index;
+
+// reponses de chaque type recues avant l'envoi de chaque trame du scenario
+static uint16_t firmware_replies_before[FIRMWARE_MAX_STEPS][256];
+
+// PWM de aero.c pour les tests qui ne portent pas sur les timers 0 et 2
+static const pwm_config_t pwm_config = {
+    PWM_TIMER_CONFIG(PWM_MODE_FAST, 1),
+    PWM_TIMER_CONFIG(PWM_MODE_FAST, 1)
+};
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static void check(int condition, const char* text, const char* file, int line)
+{
+    nb_checks++;
+
+    if(!condition)
+    {
+        nb_failures++;
+        printf("%s:%d: echec: %s\n", file, line, text);
+    }
+}
+
+/**
+    \brief remet les registres, le temps et la trace a 0 entre les tests
+*/
+static void setup(void)
+{
+    hal_host_reset();
+    time_stub_reset();
+    time_init();
+    trace_init();
+}
+
+/**
+    \brief ADC simule: la conversion se termine des qu'elle est demarree
+*/
+static void adc_observer(hal_reg8_enum reg, uint8_t old_value, uint8_t new_value)
+{
+    if(reg == HAL_ADCSRA && read_bit(new_value, ADSC))
+    {
+        hal_host_poke8(HAL_ADCH, adc_values[hal_host_peek8(HAL_ADMUX) & 0x07]);
+        hal_host_poke8(HAL_ADCSRA, clear_bit(new_value, ADSC));
+    }
+}
+
+/**
+    \brief nombre de cycles a 1 de la sortie d'un timer de PWM 8 bits (0 ou 2) par periode, selon
+    ses registres comme le decrit la fiche technique, la periode est retournee dans period
+
+    les bits WGM et COM sont aux memes positions dans TCCR0 et TCCR2
+*/
+static uint16_t pwm_high_ticks(uint8_t tccr, uint8_t ocr, bool pin, uint16_t* period)
+{
+    bool fast = read_bit(tccr, WGM01);
+
+    *period = fast ? 256 : 510;
+
+    // comparateur deconnecte: la broche suit le port
+    if(!read_bit(tccr, COM01))
+    {
+        return pin ? *period : 0;
+    }
+
+    // fast PWM: a 1 de BOTTOM a la comparaison inclusivement, phase correct: autour de BOTTOM
+    return fast ? ocr + 1 : 2 * ocr;
+}
+
+/**
+    \brief la manette recoit les trames du firmware, les reponses AT sont ignorees
+*/
+static void firmware_transmit(uint8_t byte)
+{
+    static const char cipsend[] = "AT+CIPSEND\r\n";
+
+    if(firmware_cipsend_index < sizeof(cipsend) - 1)
+    {
+        firmware_cipsend_index = (byte == (uint8_t)cipsend[firmware_cipsend_index]) ? firmware_cipsend_index + 1 : 0;
+
+        if(firmware_cipsend_index == sizeof(cipsend) - 1)
+        {
+            memcpy(firmware_replies_before_cipsend, firmware_replies, sizeof(firmware_replies));
+        }
+    }
+
+    if(frame_decoder_push(&firmware_decoder, byte, &firmware_reply) == TRUE && firmware_reply.length >= 1)
+    {
+        firmware_replies[firmware_reply.data[0]]++;
+    }
+}
+
+/**
+    \brief envoie les trames du scenario a leur heure, puis arrete le firmware
+*/
+static void firmware_service(void)
+{
+    char encoded[FRAME_ENCODED_MAX_LENGTH];
+    const firmware_step_t* step;
+    uint32_t at;
+    uint8_t length;
+    uint8_t i;
+
+    while(firmware_next_step < firmware_nb_steps &&
+          (int32_t)(time_micros() - firmware_steps[firmware_next_step].at_us) >= 0)
+    {
+        step = &firmware_steps[firmware_next_step];
+        memcpy(firmware_replies_before[firmware_next_step], firmware_replies, sizeof(firmware_replies));
+
+        length = frame_encode(encoded, step->data, step->length);
+        at = time_micros();
+
+        for(i = 0; i < length; i++)
+        {
+            if((int32_t)(mcu_sim_get_line_free_at() - at) > 0)
+            {
+                at = mcu_sim_get_line_free_at();
+            }
+
+            at += MCU_SIM_BYTE_US;
+            mcu_sim_receive(at, (uint8_t)encoded[i]);
+        }
+
+        firmware_next_step++;
+    }
+
+    if((int32_t)(time_micros() - firmware_end_us) >= 0)
+    {
+        mcu_sim_stop();
+    }
+
+    mcu_sim_wake_at((firmware_next_step < firmware_nb_steps) ? firmware_steps[firmware_next_step].at_us : firmware_end_us);
+}
+
+/**
+    \brief demarre le firmware avec une EEPROM vide et lui envoie les trames jusqu'a end_us
+*/
+static void firmware_run(const firmware_step_t* steps, uint8_t nb_steps, uint32_t end_us)
+{
+    firmware_steps = steps;
+    firmware_nb_steps = nb_steps;
+    firmware_next_step = 0;
+    firmware_end_us = end_us;
+    frame_decoder_init(&firmware_decoder);
+    memset(firmware_replies, 0, sizeof(firmware_replies));
+    memset(firmware_replies_before, 0, sizeof(firmware_replies_before));
+
+    mcu_sim_init();
+    mcu_sim_set_service(firmware_service);
+    mcu_sim_set_transmit(firmware_transmit);
+    mcu_sim_run();
+}
+
+/**
+    \brief recoit un byte comme le ferait le UART
+*/
+static void uart_receive(uint8_t byte)
+{
+    hal_host_poke8(HAL_UDR, byte);
+    hal_host_run_isr(USART_RXC_vect);
+}
+
+/**
+    \brief vide le buffer de transmission du UART comme le ferait le materiel
+    \return le nombre de bytes transmis, copies dans out
+*/
+static uint8_t uart_transmit_all(uint8_t* out, uint8_t max)
+{
+    uint8_t length = 0;
+
+    hal_host_commit();
+
+    while(read_bit(hal_host_peek8(HAL_UCSRB), UDRIE) && length < max)
+    {
+        hal_host_run_isr(USART_UDRE_vect);
+        out[length] = hal_host_peek8(HAL_UDR);
+        length++;
+    }
+
+    return length;
+}
+
+/******************************************************************************
+Tests
+******************************************************************************/
+static void test_fifo(void)
+{
+    fifo_t fifo;
+    uint8_t buffer[4];
+    uint8_t i;
+
+    fifo_init(&fifo, buffer, sizeof(buffer));
+    CHECK(fifo_is_empty(&fifo) == TRUE);
+
+    for(i = 0; i < 4; i++)
+    {
+        fifo_push(&fifo, i);
+    }
+
+    CHECK(fifo_is_full(&fifo) == TRUE);
+
+    // pousser dans un fifo plein perd le nouveau byte
+    fifo_push(&fifo, 9);
+    CHECK(fifo_pop(&fifo) == 0);
+
+    // fifo_push_overwrite perd le plus vieux
+    fifo_push(&fifo, 4);
+    fifo_push_overwrite(&fifo, 5);
+
+    for(i = 2; i <= 5; i++)
+    {
+        CHECK(fifo_pop(&fifo) == i);
+    }
+
+    CHECK(fifo_is_empty(&fifo) == TRUE);
+}
+
+static void test_frame(void)
+{
+    const uint8_t data[] = {FRAME_TYPE_COMMAND, 'A', 0, 255, 'B'};
+    char encoded[FRAME_ENCODED_MAX_LENGTH];
+    frame_decoder_t decoder;
+    frame_t frame;
+    uint8_t length;
+    uint8_t i;
+    uint8_t nb_frames = 0;
+
+    length = frame_encode(encoded, data, sizeof(data));
+    CHECK(length == strlen(encoded));
+    CHECK(strcmp(encoded, "ABKAAAD\xff" "BAC") == 0);
+
+    // une trame interrompue par un nouveau debut est abandonnee
+    frame_decoder_init(&decoder);
+    frame_decoder_push(&decoder, 'A', &frame);
+    frame_decoder_push(&decoder, 'B', &frame);
+    frame_decoder_push(&decoder, 'x', &frame);
+
+    for(i = 0; i < length; i++)
+    {
+        if(frame_decoder_push(&decoder, (uint8_t)encoded[i], &frame) == TRUE)
+        {
+            nb_frames++;
+        }
+    }
+
+    CHECK(nb_frames == 1);
+    CHECK(frame.length == sizeof(data));
+    CHECK(memcmp(frame.data, data, sizeof(data)) == 0);
+
+    // les bytes d'une trame partielle sont ecrits directement dans frame, la longueur attend la fin
+    frame_decoder_push(&decoder, 'A', &frame);
+    frame_decoder_push(&decoder, 'B', &frame);
+    frame_decoder_push(&decoder, 'S', &frame);
+    CHECK(frame.length == sizeof(data));
+    CHECK(frame.data[0] == 'S');
+}
+
+static void test_utils(void)
+{
+    char string[16] = {0};
+    char result[16] = {0};
+
+    CHECK(uint8_to_string(string, 7) == 3);
+    CHECK(strcmp(string, "007") == 0);
+
+    uint16_to_string(string, 1234);
+    CHECK(strcmp(string, "01234") == 0);
+
+    string_concat(result, "H", "042");
+    CHECK(strcmp(result, "H042") == 0);
+
+    string_concat_P(result, result, PSTR("/V"));
+    CHECK(strcmp(result, "H042/V") == 0);
+}
+
+static void test_uart(void)
+{
+    uint8_t sent[16];
+    uint32_t first;
+    uint32_t last;
+
+    setup();
+    uart_init();
+    sei();
+
+    // 9600 bauds a 8 MHz
+    CHECK(hal_host_peek8(HAL_UBRRL) == 51);
+    CHECK(read_bit(hal_host_peek8(HAL_UCSRB), RXCIE));
+
+    uart_put_string("AT\r\n");
+    CHECK(read_bit(hal_host_peek8(HAL_UCSRB), UDRIE));
+    CHECK(uart_transmit_all(sent, sizeof(sent)) == 4);
+    CHECK(memcmp(sent, "AT\r\n", 4) == 0);
+    CHECK(uart_is_tx_buffer_empty() == TRUE);
+
+    uart_put_string_P(PSTR("AT+CIPSEND\r\n"));
+    CHECK(uart_transmit_all(sent, sizeof(sent)) == 12);
+    CHECK(memcmp(sent, "AT+CIPSEND\r\n", 12) == 0);
+
+    // reception de deux rafales separees par un silence
+    time_stub_advance(10000);
+    uart_receive('a');
+    time_stub_advance(1000);
+    uart_receive('b');
+    time_stub_advance(10000);
+    uart_receive('c');
+    time_stub_advance(1000);
+    uart_receive('d');
+
+    uart_get_rx_timestamps(&first, &last);
+    CHECK(first == 21000);
+    CHECK(last == 22000);
+
+    CHECK(uart_get_byte() == 'a');
+    uart_clean_rx_buffer();
+
+    // debordement avec la politique par defaut: les nouveaux bytes sont perdus
+    for(sent[0] = 0; sent[0] < UART_RX_BUFFER_SIZE + 2; sent[0]++)
+    {
+        uart_receive(sent[0]);
+    }
+
+    CHECK(uart_is_rx_overflowed() == TRUE);
+    CHECK(uart_is_rx_overflowed() == FALSE);
+    CHECK(uart_get_byte() == 0);
+    uart_clean_rx_buffer();
+
+    // avec UART_OVERFLOW_DROP_OLDEST, les plus vieux sont ecrases
+    uart_set_rx_overflow_policy(UART_OVERFLOW_DROP_OLDEST);
+
+    for(sent[0] = 0; sent[0] < UART_RX_BUFFER_SIZE + 2; sent[0]++)
+    {
+        uart_receive(sent[0]);
+    }
+
+    CHECK(uart_get_byte() == 2);
+}
+
+static void test_driver(void)
+{
+    setup();
+    hal_host_set_observer(adc_observer);
+
+    adc_init();
+    adc_values[PA2] = 200;
+    CHECK(adc_read(PA2) == 200);
+
+    servo_init();
+    CHECK(hal_host_peek16(HAL_ICR1) == 20000);
+    servo_set_a(1580);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1580);
+
+    pwm_init(&pwm_config);
+    pwm_set_a(100);
+    CHECK(hal_host_peek8(HAL_OCR0) == 100);
+    CHECK(read_bit(hal_host_peek8(HAL_TCCR0), COM01));
+
+    // un duty de 0 deconnecte la sortie du comparateur
+    pwm_set_a(0);
+    CHECK(!read_bit(hal_host_peek8(HAL_TCCR0), COM01));
+    CHECK(!read_bit(hal_host_peek8(HAL_PORTB), PB3));
+}
+
+static void test_pwm(void)
+{
+    static const pwm_config_t configs[] = {
+        {PWM_TIMER_CONFIG(PWM_MODE_FAST, 1), PWM_TIMER_CONFIG(PWM_MODE_FAST, 1)},
+        {PWM_TIMER_CONFIG(PWM_MODE_FAST, 8), PWM_TIMER_CONFIG(PWM_MODE_FAST, 8)},
+        {PWM_TIMER_CONFIG(PWM_MODE_FAST, 64), PWM_TIMER_CONFIG(PWM_MODE_FAST, 64)},
+        {PWM_TIMER_CONFIG(PWM_MODE_PHASE_CORRECT, 1), PWM_TIMER_CONFIG(PWM_MODE_PHASE_CORRECT, 1)},
+        {PWM_TIMER_CONFIG(PWM_MODE_PHASE_CORRECT, 8), PWM_TIMER_CONFIG(PWM_MODE_PHASE_CORRECT, 8)},
+        {PWM_TIMER_CONFIG(PWM_MODE_PHASE_CORRECT, 64), PWM_TIMER_CONFIG(PWM_MODE_PHASE_CORRECT, 64)}
+    };
+
+    // TCCR0 et TCCR2 attendus selon les tableaux de la fiche technique de l'ATmega32
+    static const uint8_t tccr0[] = {0x49, 0x4A, 0x4B, 0x41, 0x42, 0x43};
+    static const uint8_t tccr2[] = {0x49, 0x4A, 0x4C, 0x41, 0x42, 0x44};
+    static const uint32_t frequency[] = {31250, 3906, 488, 15686, 1960, 245};
+
+    pwm_config_t mixed = {PWM_TIMER_CONFIG(PWM_MODE_FAST, 1), PWM_TIMER_CONFIG(PWM_MODE_PHASE_CORRECT, 64)};
+    pwm_config_t invalid = {{PWM_MODE_FAST, 1}, {PWM_MODE_FAST, 128}};
+    bool linear = TRUE;
+    uint16_t previous;
+    uint16_t high;
+    uint16_t period;
+    uint8_t i;
+    uint16_t duty;
+
+    for(i = 0; i < sizeof(configs) / sizeof(configs[0]); i++)
+    {
+        setup();
+        pwm_init(&configs[i]);
+
+        CHECK(hal_host_peek8(HAL_TCCR0) == tccr0[i]);
+        CHECK(hal_host_peek8(HAL_TCCR2) == tccr2[i]);
+        CHECK(PWM_FREQUENCY_HZ(configs[i].a.mode, configs[i].a.prescaler) == frequency[i]);
+
+        // sorties a 0 jusqu'au premier duty non nul
+        CHECK(read_bit(hal_host_peek8(HAL_DDRB), PB3) && read_bit(hal_host_peek8(HAL_DDRD), PD7));
+        CHECK(pwm_high_ticks(hal_host_peek8(HAL_TCCR0), hal_host_peek8(HAL_OCR0), read_bit(hal_host_peek8(HAL_PORTB), PB3), &period) == 0);
+
+        // le rapport cyclique suit le duty a un cycle pres, sans saut, jusqu'a 100% a 255
+        previous = 0;
+
+        for(duty = 1; duty <= 255; duty++)
+        {
+            pwm_set_a(duty);
+            pwm_set_b(duty);
+            high = pwm_high_ticks(hal_host_peek8(HAL_TCCR0), hal_host_peek8(HAL_OCR0), FALSE, &period);
+
+            linear = linear && high > previous && high * 255UL <= duty * period + 255UL && duty * period <= high * 255UL + 255UL;
+            linear = linear && pwm_high_ticks(hal_host_peek8(HAL_TCCR2), hal_host_peek8(HAL_OCR2), FALSE, &period) == high;
+            previous = high;
+        }
+
+        CHECK(linear);
+        CHECK(high == period);
+
+        // le mode et le facteur de division ne sont pas touches par pwm_set_a et pwm_set_b
+        CHECK((hal_host_peek8(HAL_TCCR0) & ~(1 << COM01)) == tccr0[i]);
+        CHECK((hal_host_peek8(HAL_TCCR2) & ~(1 << COM21)) == tccr2[i]);
+
+        // un duty de 0 force les broches a 0, meme si le port etait a 1
+        hal_host_poke8(HAL_PORTB, set_bit(hal_host_peek8(HAL_PORTB), PB3));
+        hal_host_poke8(HAL_PORTD, set_bit(hal_host_peek8(HAL_PORTD), PD7));
+        pwm_set_a(0);
+        pwm_set_b(0);
+        CHECK(pwm_high_ticks(hal_host_peek8(HAL_TCCR0), hal_host_peek8(HAL_OCR0), read_bit(hal_host_peek8(HAL_PORTB), PB3), &period) == 0);
+        CHECK(pwm_high_ticks(hal_host_peek8(HAL_TCCR2), hal_host_peek8(HAL_OCR2), read_bit(hal_host_peek8(HAL_PORTD), PD7), &period) == 0);
+    }
+
+    // chaque timer a sa configuration
+    setup();
+    pwm_init(&mixed);
+    CHECK(hal_host_peek8(HAL_TCCR0) == tccr0[0]);
+    CHECK(hal_host_peek8(HAL_TCCR2) == tccr2[5]);
+
+    // un facteur de division refuse laisse le timer arrete
+    setup();
+    pwm_init(&invalid);
+    CHECK(hal_host_peek8(HAL_TCCR0) == tccr0[0]);
+    CHECK(hal_host_peek8(HAL_TCCR2) == 0);
+}
+
+static void test_failsafe(void)
+{
+    static const uint8_t curve[] = {128};
+    failsafe_config_t config = {100, 40, curve, sizeof(curve), 1580};
+
+    setup();
+    servo_init();
+    pwm_init(&pwm_config);
+    sei();
+
+    CHECK(failsafe_init(&config) == TRUE);
+
+    // pas de coupure avant la premiere commande
+    time_stub_advance(1000000);
+    CHECK(failsafe_is_tripped() == FALSE);
+
+    failsafe_feed(200, 100);
+    servo_set_a(1000);
+    time_stub_advance(80000);
+    CHECK(failsafe_is_tripped() == FALSE);
+
+    time_stub_advance(40000);
+    CHECK(failsafe_is_tripped() == TRUE);
+    CHECK(failsafe_get_trip_count() == 1);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1580);
+    CHECK(hal_host_peek8(HAL_OCR0) == (200 * 128) / 255);
+
+    // apres la courbe, les moteurs sont arretes
+    time_stub_advance(100000);
+    CHECK(!read_bit(hal_host_peek8(HAL_TCCR0), COM01));
+    CHECK(!read_bit(hal_host_peek8(HAL_TCCR2), COM21));
+
+    failsafe_feed(10, 10);
+    CHECK(failsafe_is_tripped() == FALSE);
+}
+
+static void test_packet(void)
+{
+    frame_t* packets[PACKET_POOL_SIZE];
+    frame_decoder_t decoder;
+    uint8_t i;
+
+    packet_init();
+    CHECK(packet_get_nb_free() == PACKET_POOL_SIZE);
+
+    for(i = 0; i < PACKET_POOL_SIZE; i++)
+    {
+        packets[i] = packet_alloc();
+        CHECK(packets[i] != NULL && packets[i]->length == 0);
+    }
+
+    CHECK(packet_alloc() == NULL);
+    CHECK(packets[0] != packets[1]);
+    CHECK(packet_get_min_free() == 0);
+
+    // la derniere trame rendue est la premiere reprise
+    packet_free(packets[1]);
+    packet_free(NULL);
+    CHECK(packet_get_nb_free() == 1);
+    CHECK(packet_alloc() == packets[1]);
+
+    // le decodeur remplit directement une trame de la reserve
+    frame_decoder_init(&decoder);
+    CHECK(frame_decoder_push(&decoder, 'A', packets[1]) == FALSE);
+    CHECK(frame_decoder_push(&decoder, 'B', packets[1]) == FALSE);
+    CHECK(frame_decoder_push(&decoder, 'S', packets[1]) == FALSE);
+    CHECK(frame_decoder_push(&decoder, 'A', packets[1]) == FALSE);
+    CHECK(frame_decoder_push(&decoder, 'C', packets[1]) == TRUE);
+    CHECK(packets[1]->length == 1 && packets[1]->data[0] == 'S');
+
+    for(i = 0; i < PACKET_POOL_SIZE; i++)
+    {
+        packet_free(packets[i]);
+    }
+
+    CHECK(packet_get_nb_free() == PACKET_POOL_SIZE);
+    CHECK(packet_get_min_free() == 0);
+}
+
+static void test_config(void)
+{
+    static const config_t defaults PROGMEM = {{1580, 400, 440, 107, 26, 6, 0, 1, PROFILE_RACE}, {"THING", "f8aa2328679b"}};
+    uint32_t writes;
+    uint8_t slot;
+
+    setup();
+    eeprom_sim_init();
+    eeprom_sim_erase();
+
+    // une EEPROM neuve donne les valeurs par defaut
+    CHECK(config_init(&defaults) == FALSE);
+    CHECK(config_get(CONFIG_SERVO_RIGHT) == 400);
+    CHECK(strcmp(config_get_string(CONFIG_WIFI_SSID), "THING") == 0);
+    CHECK(config_get_slot() == CONFIG_NB_SLOTS);
+
+    config_set(CONFIG_SERVO_RIGHT, 100);
+    config_set_string(CONFIG_WIFI_SSID, "un nom beaucoup trop long");
+    config_save();
+    CHECK(config_get_slot() == 0);
+    CHECK(strcmp(config_get_string(CONFIG_WIFI_SSID), "un nom beaucoup") == 0);
+
+    // apres un reset, la configuration revient de l'EEPROM
+    CHECK(config_init(&defaults) == TRUE);
+    CHECK(config_get(CONFIG_SERVO_RIGHT) == 100);
+    CHECK(config_get(CONFIG_SERVO_LEFT) == 440);
+    CHECK(strcmp(config_get_string(CONFIG_WIFI_SSID), "un nom beaucoup") == 0);
+
+    // chaque sauvegarde prend l'emplacement suivant et le tour revient au premier
+    for(slot = 1; slot <= CONFIG_NB_SLOTS; slot++)
+    {
+        config_set(CONFIG_SERVO_CENTER, 1500 + slot);
+        config_save();
+    }
+
+    CHECK(config_get_slot() == 0);
+    CHECK(config_init(&defaults) == TRUE);
+    CHECK(config_get(CONFIG_SERVO_CENTER) == 1500 + CONFIG_NB_SLOTS);
+
+    // 17 sauvegardes, le premier byte de l'emplacement 0 n'a ete ecrit qu'une fois (la version)
+    CHECK(eeprom_sim_get_writes(0) == 1);
+    CHECK(eeprom_sim_get_writes(CONFIG_SLOT_SIZE) == 1);
+
+    // une coupure pendant la sauvegarde laisse la configuration precedente
+    writes = eeprom_sim_get_total_writes();
+    config_set(CONFIG_SERVO_CENTER, 1234);
+    eeprom_sim_cut_after(3);
+    config_save();
+    eeprom_sim_cut_after(-1);
+    CHECK(eeprom_sim_get_total_writes() == writes + 3);
+    CHECK(config_init(&defaults) == TRUE);
+    CHECK(config_get(CONFIG_SERVO_CENTER) == 1500 + CONFIG_NB_SLOTS);
+    CHECK(config_get_slot() == 0);
+
+    // un byte corrompu invalide l'enregistrement, le plus recent des autres est pris
+    eeprom_sim_poke(CONFIG_SLOT_SIZE * 0 + 5, eeprom_sim_peek(5) ^ 0x01);
+    CHECK(config_init(&defaults) == TRUE);
+    CHECK(config_get_slot() == CONFIG_NB_SLOTS - 1);
+    CHECK(config_get(CONFIG_SERVO_CENTER) == 1500 + CONFIG_NB_SLOTS - 1);
+}
+
+static uint8_t nb_applied;
+
+static void count_applied(config_value_enum key, uint16_t value)
+{
+    nb_applied++;
+}
+
+static void test_param(void)
+{
+    static const config_t defaults PROGMEM = {{1580, 400, 440, 107, 26, 6, 0, 1, PROFILE_RACE}, {"THING", "f8aa2328679b"}};
+    frame_t request;
+    frame_t reply;
+
+    setup();
+    eeprom_sim_init();
+    eeprom_sim_erase();
+    config_init(&defaults);
+    param_init(count_applied);
+    nb_applied = 0;
+
+    // centre a 1500 et gauche a 100, sans sauvegarde
+    memcpy(request.data, (uint8_t[]){FRAME_TYPE_PARAM_SET, 0, CONFIG_SERVO_CENTER, 0xDC, 0x05,
+                                     CONFIG_SERVO_LEFT, 100, 0}, 8);
+    request.length = 8;
+    CHECK(param_handle(&request, &reply) == PARAM_OK);
+    CHECK(config_get(CONFIG_SERVO_CENTER) == 1500 && config_get(CONFIG_SERVO_LEFT) == 100);
+    CHECK(nb_applied == 2);
+    CHECK(reply.data[0] == FRAME_TYPE_PARAM_VALUES && reply.data[1] == PARAM_OK && reply.length == 8);
+    CHECK(reply.data[2] == CONFIG_SERVO_CENTER && reply.data[3] == 0xDC && reply.data[4] == 0x05);
+    CHECK(eeprom_sim_get_total_writes() == 0);
+
+    // une seule valeur hors limite et rien n'est applique, la reponse donne les valeurs courantes
+    request.data[6] = 0xFF;
+    request.data[7] = 0x01;
+    request.data[3] = 0xD0;
+    CHECK(param_handle(&request, &reply) == PARAM_OUT_OF_RANGE);
+    CHECK(config_get(CONFIG_SERVO_CENTER) == 1500 && config_get(CONFIG_SERVO_LEFT) == 100);
+    CHECK(nb_applied == 2);
+    CHECK(reply.data[1] == PARAM_OUT_OF_RANGE && reply.data[3] == 0xDC);
+
+    // cle inconnue, longueur invalide
+    request.data[2] = CONFIG_NB_VALUES;
+    CHECK(param_handle(&request, &reply) == PARAM_UNKNOWN_KEY);
+    request.length = 7;
+    CHECK(param_handle(&request, &reply) == PARAM_MALFORMED);
+
+    // correction de l'oscillateur negative, conservee dans l'EEPROM
+    memcpy(request.data, (uint8_t[]){FRAME_TYPE_PARAM_SET, PARAM_PERSIST, CONFIG_OSCCAL_OFFSET, 0xFD, 0xFF}, 5);
+    request.length = 5;
+    CHECK(param_handle(&request, &reply) == PARAM_OK);
+    CHECK(config_init(&defaults) == TRUE);
+    CHECK((int8_t)config_get(CONFIG_OSCCAL_OFFSET) == -3);
+    CHECK(config_get(CONFIG_SERVO_CENTER) == 1500);
+
+    // lecture de toutes les cles
+    request.data[0] = FRAME_TYPE_PARAM_GET;
+    request.length = 1;
+    CHECK(param_handle(&request, &reply) == PARAM_OK);
+    CHECK(reply.length == 2 + 3 * CONFIG_NB_VALUES);
+    CHECK(reply.data[2 + 3 * CONFIG_TELEMETRY_DIVIDER] == CONFIG_TELEMETRY_DIVIDER);
+    CHECK(reply.data[3 + 3 * CONFIG_TELEMETRY_DIVIDER] == 1);
+}
+
+/**
+    \brief comme apply_parameter de aero.c pour le profil et les debattements
+*/
+static void select_applied_profile(config_value_enum key, uint16_t value)
+{
+    if(key == CONFIG_PROFILE)
+    {
+        profile_select(value);
+    }
+    else
+    {
+        profile_update();
+    }
+}
+
+static void test_profile(void)
+{
+    static const config_t defaults PROGMEM = {{1580, 400, 440, 107, 26, 6, 0, 1, PROFILE_RACE}, {"THING", "f8aa2328679b"}};
+    static const profile_t profiles[PROFILE_NB] PROGMEM = {{400, 440, 255, 1}, {100, 150, 200, 2}};
+    uint32_t angle;
+    uint16_t hor;
+    uint16_t nb_errors = 0;
+    frame_t request;
+    frame_t reply;
+
+    setup();
+    eeprom_sim_init();
+    eeprom_sim_erase();
+    config_init(&defaults);
+    profile_init(profiles);
+
+    // la table donne la meme valeur que l'equation de droite d'avant, pour chaque commande
+    for(hor = 0; hor <= 255; hor++)
+    {
+        angle = (hor > 126) ? 400 : 440;
+
+        if(profile_get_servo(hor) != ((hor * (angle * 2UL)) / 255UL) + (1580 - angle))
+        {
+            nb_errors++;
+        }
+    }
+
+    CHECK(nb_errors == 0);
+    CHECK(profile_get_servo(0) == 1140 && profile_get_servo(255) == 1980);
+    CHECK(profile_get_thrust(255) == 255);
+
+    // le profil drag remplace les debattements, la poussee maximale et la telemetrie
+    profile_select(PROFILE_DRAG);
+    CHECK(config_get(CONFIG_PROFILE) == PROFILE_DRAG);
+    CHECK(config_get(CONFIG_SERVO_RIGHT) == 100 && config_get(CONFIG_SERVO_LEFT) == 150);
+    CHECK(config_get(CONFIG_TELEMETRY_DIVIDER) == 2);
+    CHECK(profile_get_servo(0) == 1430 && profile_get_servo(255) == 1680);
+    CHECK(profile_get_thrust(255) == 200 && profile_get_thrust(100) == 100);
+
+    // une retouche du centre est prise en compte apres profile_update
+    config_set(CONFIG_SERVO_CENTER, 1500);
+    profile_update();
+    CHECK(profile_get_servo(0) == 1350);
+
+    // le profil choisi revient de l'EEPROM, un profil inconnu est refuse
+    config_save();
+    CHECK(config_init(&defaults) == TRUE);
+    profile_init(profiles);
+    CHECK(profile_get_thrust(255) == 200 && profile_get_servo(255) == 1600);
+    CHECK(config_is_valid(CONFIG_PROFILE, PROFILE_NB) == FALSE);
+
+    // le profil d'une trame passe avant la retouche placee devant lui, qui est gardee
+    param_init(select_applied_profile);
+    memcpy(request.data, (uint8_t[]){FRAME_TYPE_PARAM_SET, 0, CONFIG_SERVO_LEFT, 0x2C, 0x01,
+                                     CONFIG_PROFILE, PROFILE_RACE, 0}, 8);
+    request.length = 8;
+    CHECK(param_handle(&request, &reply) == PARAM_OK);
+    CHECK(config_get(CONFIG_PROFILE) == PROFILE_RACE && config_get(CONFIG_SERVO_RIGHT) == 400);
+    CHECK(config_get(CONFIG_SERVO_LEFT) == 300 && profile_get_servo(0) == 1200);
+    CHECK(reply.data[2] == CONFIG_SERVO_LEFT && reply.data[3] == 0x2C && reply.data[4] == 0x01);
+    CHECK(profile_get_thrust(255) == 255);
+}
+
+static void test_launch(void)
+{
+    static const config_t defaults PROGMEM = {{1580, 100, 150, 107, 26, 6, 0, 1, PROFILE_DRAG}, {"THING", "f8aa2328679b"}};
+    static const launch_point_t points[] PROGMEM = {{0, 200, 0, 0}, {40, 200, 0, 0}, {100, 200, 90, -30}, {140, 255, 90, -30}};
+    static const launch_curve_t curves[] = {{points, 4}, {points, 1}};
+    static const uint8_t curve[] = {128};
+    failsafe_config_t failsafe = {1000, 40, curve, sizeof(curve), 1580};
+    launch_config_t config = {curves, 2, 20, 30};
+    frame_t request = {{FRAME_TYPE_LAUNCH, LAUNCH_GO}, 2};
+
+    setup();
+    eeprom_sim_init();
+    eeprom_sim_erase();
+    config_init(&defaults);
+    servo_init();
+    pwm_init(&pwm_config);
+    sei();
+
+    CHECK(failsafe_init(&failsafe) == TRUE);
+    CHECK(launch_init(&config) == TRUE);
+
+    // depart sans courbe armee, courbe inconnue, courbe d'un seul point
+    CHECK(launch_handle(&request) == FALSE);
+    request.data[1] = LAUNCH_ARM;
+    request.data[2] = 2;
+    request.length = 3;
+    CHECK(launch_handle(&request) == FALSE);
+    request.data[2] = 1;
+    CHECK(launch_handle(&request) == FALSE);
+    request.data[2] = 0;
+    CHECK(launch_handle(&request) == TRUE);
+    CHECK(launch_get_state() == LAUNCH_ARMED);
+
+    // pas de depart tant que le failsafe n'est pas arme par une commande
+    request.data[1] = LAUNCH_GO;
+    CHECK(launch_handle(&request) == FALSE);
+    CHECK(launch_get_state() == LAUNCH_ARMED);
+
+    failsafe_feed(0, 0);
+    CHECK(launch_handle(&request) == TRUE);
+    CHECK(launch_get_state() == LAUNCH_RUNNING);
+
+    // manettes au neutre, la courbe garde la main
+    CHECK(launch_feed(127, 0) == TRUE);
+
+    // 0 et 20 ms: premier point, 40 ms: deuxieme point
+    time_stub_advance(3 * TIME_PERIOD_US);
+    CHECK(hal_host_peek8(HAL_OCR0) == 200);
+    CHECK(!read_bit(hal_host_peek8(HAL_TCCR2), COM21));
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1580);
+
+    // 60 ms: un tiers du chemin vers le troisieme point
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(hal_host_peek8(HAL_OCR2) == 30);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1570);
+
+    // 120 ms: a mi-chemin du dernier point
+    time_stub_advance(3 * TIME_PERIOD_US);
+    CHECK(hal_host_peek8(HAL_OCR0) == 227 && hal_host_peek8(HAL_OCR2) == 90);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1550);
+
+    // 140 ms: fin de la courbe, moteurs coupes et servomoteur centre
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(launch_get_state() == LAUNCH_IDLE);
+    CHECK(!read_bit(hal_host_peek8(HAL_TCCR0), COM01));
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1580);
+    CHECK(launch_feed(127, 0) == FALSE);
+
+    // le pilote reprend la main en poussant
+    request.data[1] = LAUNCH_ARM;
+    launch_handle(&request);
+    request.data[1] = LAUNCH_GO;
+    launch_handle(&request);
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(launch_feed(127, 21) == FALSE);
+    CHECK(launch_get_state() == LAUNCH_IDLE);
+
+    // la perte du lien arrete la courbe
+    request.data[1] = LAUNCH_ARM;
+    launch_handle(&request);
+    request.data[1] = LAUNCH_GO;
+    launch_handle(&request);
+    time_stub_advance(1000000);
+    CHECK(failsafe_is_tripped() == TRUE);
+    CHECK(launch_get_state() == LAUNCH_IDLE);
+}
+
+/**
+    \brief place le timer 1 a une valeur, avec ou sans l'interruption de fin de periode en attente
+*/
+static void time_hw_set(uint16_t count, bool pending)
+{
+    uint8_t tifr = hal_host_peek8(HAL_TIFR);
+
+    hal_host_poke16(HAL_TCNT1, count);
+    hal_host_poke8(HAL_TIFR, pending ? set_bit(tifr, TOV1) : clear_bit(tifr, TOV1));
+}
+
+static void test_time(void)
+{
+    setup();
+    time_hw_init();
+    CHECK(hal_host_peek16(HAL_ICR1) == TIME_TOP && read_bit(hal_host_peek8(HAL_TIMSK), TOIE1));
+
+    // TOV1 monte a TOP: TOP est le debut de la periode suivante, avant et apres l'interruption
+    time_hw_set(TIME_TOP - 1, FALSE);
+    CHECK(time_hw_micros() == TIME_TOP - 1);
+    time_hw_set(TIME_TOP, TRUE);
+    CHECK(time_hw_micros() == TIME_PERIOD_US && time_hw_micros16() == (uint16_t)TIME_PERIOD_US);
+    hal_host_run_isr(time_hw_overflow_vect);
+    time_hw_set(TIME_TOP, FALSE);
+    CHECK(time_hw_micros() == TIME_PERIOD_US && time_hw_micros16() == (uint16_t)TIME_PERIOD_US);
+    time_hw_set(0, FALSE);
+    CHECK(time_hw_micros() == TIME_PERIOD_US);
+    time_hw_set(1, FALSE);
+    CHECK(time_hw_micros() == TIME_PERIOD_US + 1 && time_hw_micros16() == (uint16_t)(TIME_PERIOD_US + 1));
+
+    // interruption masquee jusqu'apres BOTTOM: la periode en attente est comptee
+    time_hw_set(TIME_TOP, TRUE);
+    CHECK(time_hw_micros() == 2 * TIME_PERIOD_US);
+    time_hw_set(0, TRUE);
+    CHECK(time_hw_micros() == 2 * TIME_PERIOD_US);
+    time_hw_set(5, TRUE);
+    CHECK(time_hw_micros() == 2 * TIME_PERIOD_US + 5 && time_hw_micros16() == (uint16_t)(2 * TIME_PERIOD_US + 5));
+
+    // TOV1 monte entre la lecture de TCNT1 et celle de TIFR: la periode n'est pas encore finie
+    time_hw_set(TIME_TOP - 1, TRUE);
+    CHECK(time_hw_micros() == 2 * TIME_PERIOD_US - 2);
+
+    hal_host_run_isr(time_hw_overflow_vect);
+    time_hw_set(6, FALSE);
+    CHECK(time_hw_micros() == 2 * TIME_PERIOD_US + 6 && time_hw_micros16() == (uint16_t)(2 * TIME_PERIOD_US + 6));
+}
+
+static void test_slew(void)
+{
+    slew_config_t config = {100, FALSE};
+    uint32_t applied_at;
+
+    setup();
+    servo_init();
+    sei();
+
+    // avant l'initialisation, la cible est ecrite tout de suite
+    slew_set_target(1500);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1500);
+
+    CHECK(slew_init(&config, 1580) == TRUE);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1580);
+
+    // la nouvelle cible n'est appliquee qu'a la fin de la periode, au plus 100 us a la fois;
+    // l'heure d'application est celle de la premiere ecriture, pas de l'arrivee a la cible
+    time_stub_advance(5000);
+    slew_set_target(1980);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1580);
+    CHECK(slew_get_applied_at(&applied_at) == FALSE);
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1680);
+    CHECK(slew_get_applied_at(&applied_at) == TRUE && applied_at == TIME_PERIOD_US);
+    time_stub_advance(3 * TIME_PERIOD_US);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1980 && slew_get_position() == 1980);
+    CHECK(slew_get_applied_at(&applied_at) == TRUE && applied_at == TIME_PERIOD_US);
+
+    // OCR1A contient deja la cible, elle est appliquee au tick suivant sans ecriture
+    slew_set_target(1980);
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(slew_get_applied_at(&applied_at) == TRUE && applied_at == 5 * TIME_PERIOD_US);
+
+    // le dernier pas est plus court
+    slew_set_target(1930);
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1930);
+
+    // interpolation: deux periodes entre les cibles, le deplacement suivant prend deux periodes
+    config.interpolate = TRUE;
+    config.max_step_us = 0;
+    setup();
+    servo_init();
+    CHECK(slew_init(&config, 1580) == TRUE);
+    time_stub_advance(2 * TIME_PERIOD_US);
+    slew_set_target(1600);
+    time_stub_advance(2 * TIME_PERIOD_US);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1600);
+    slew_set_target(1700);
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1650);
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(hal_host_peek16(HAL_OCR1A) == 1700);
+}
+
+/**
+    \brief tick qui ne fait rien, remplit la base de temps
+*/
+static void ramp_noop_tick(void)
+{
+}
+
+static void test_ramp(void)
+{
+    ramp_config_t config = {{{100, 0}, {60, 50}}};
+    uint32_t applied_at;
+
+    setup();
+    pwm_init(&pwm_config);
+    sei();
+
+    // avant l'initialisation, la cible est ecrite tout de suite
+    ramp_set_target(RAMP_THRUST, 90);
+    CHECK(hal_host_peek8(HAL_OCR2) == 90);
+
+    CHECK(ramp_init(&config) == TRUE);
+    CHECK(!read_bit(hal_host_peek8(HAL_TCCR0), COM01) && !read_bit(hal_host_peek8(HAL_TCCR2), COM21));
+
+    // les cibles ne sont appliquees qu'a la fin de la periode, chaque canal a sa limite; l'heure
+    // d'application est celle de la premiere ecriture, pas de l'arrivee a la cible
+    ramp_set_target(RAMP_LIFT, 255);
+    ramp_set_target(RAMP_THRUST, 255);
+    CHECK(!read_bit(hal_host_peek8(HAL_TCCR0), COM01));
+    CHECK(ramp_get_applied_at(&applied_at) == FALSE);
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(hal_host_peek8(HAL_OCR0) == 100 && hal_host_peek8(HAL_OCR2) == 60);
+    CHECK(ramp_get_saturation() == ((1 << RAMP_LIFT) | (1 << RAMP_THRUST)));
+    CHECK(ramp_get_applied_at(&applied_at) == TRUE && applied_at == TIME_PERIOD_US);
+
+    // la sustentation arrive la premiere, le dernier pas est plus court
+    time_stub_advance(2 * TIME_PERIOD_US);
+    CHECK(ramp_get_duty(RAMP_LIFT) == 255 && hal_host_peek8(HAL_OCR2) == 180);
+    CHECK(ramp_get_saturation() == (1 << RAMP_THRUST));
+    time_stub_advance(2 * TIME_PERIOD_US);
+    CHECK(hal_host_peek8(HAL_OCR2) == 255 && ramp_get_saturation() == 0);
+    CHECK(ramp_get_applied_at(&applied_at) == TRUE && applied_at == TIME_PERIOD_US);
+
+    // les canaux sont deja a leur cible, elle est appliquee au tick suivant sans ecriture
+    ramp_set_target(RAMP_THRUST, 255);
+    CHECK(ramp_get_applied_at(&applied_at) == FALSE);
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(ramp_get_applied_at(&applied_at) == TRUE && applied_at == 6 * TIME_PERIOD_US);
+
+    // descente: sans limite pour la sustentation, 50 par periode pour la poussee jusqu'a 0
+    ramp_set_target(RAMP_LIFT, 0);
+    ramp_set_target(RAMP_THRUST, 0);
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(!read_bit(hal_host_peek8(HAL_TCCR0), COM01) && !read_bit(hal_host_peek8(HAL_PORTB), PB3));
+    CHECK(hal_host_peek8(HAL_OCR2) == 205 && ramp_get_saturation() == (1 << RAMP_THRUST));
+    time_stub_advance(4 * TIME_PERIOD_US);
+    CHECK(ramp_get_duty(RAMP_THRUST) == 5 && read_bit(hal_host_peek8(HAL_TCCR2), COM21));
+    CHECK(ramp_get_applied_at(&applied_at) == TRUE && applied_at == 7 * TIME_PERIOD_US);
+    time_stub_advance(TIME_PERIOD_US);
+    CHECK(!read_bit(hal_host_peek8(HAL_TCCR2), COM21) && !read_bit(hal_host_peek8(HAL_PORTD), PD7));
+    CHECK(ramp_get_saturation() == 0);
+
+    // la base de temps pleine est signalee au lieu d'oublier le tick
+    setup();
+
+    while(time_add_tick_callback(ramp_noop_tick) == TRUE);
+
+    CHECK(ramp_init(&config) == FALSE);
+}
+
+static void test_stack(void)
+{
+    uint8_t* top = &hal_host_free_ram[HAL_HOST_FREE_RAM_LENGTH - 1];
+
+    stack_paint();
+    CHECK(stack_get_max_used() == 0);
+    CHECK(stack_get_min_free() == HAL_HOST_FREE_RAM_LENGTH);
+
+    // une pile de 100 bytes, dont un byte egal au motif qui ne doit pas couper la mesure
+    memset(top - 99, 0, 100);
+    top[-50] = STACK_CANARY;
+    CHECK(stack_get_max_used() == 100);
+    CHECK(stack_get_min_free() == HAL_HOST_FREE_RAM_LENGTH - 100);
+
+    // la pile remonte et reecrit le haut: le maximum reste
+    memset(top - 39, 0x55, 40);
+    CHECK(stack_get_max_used() == 100);
+
+    // un buffer de 32 bytes dont seul le dernier byte est ecrit compte a partir de ce byte
+    top[-131] = 0;
+    CHECK(stack_get_max_used() == 132);
+}
+
+static void test_latency(void)
+{
+    latency_remote_t remote = {1000, 200, 30, 5000};
+    uint32_t i;
+
+    latency_init();
+
+    for(i = 0; i < 100; i++)
+    {
+        latency_record(LATENCY_TOTAL, (i + 1) * 1000);
+    }
+
+    CHECK(latency_get_count(LATENCY_TOTAL) == 100);
+    CHECK(latency_get_min(LATENCY_TOTAL) == 1000);
+    CHECK(latency_get_percentile(LATENCY_TOTAL, 99) == 100000);
+
+    // l'aller simple est la moitie de l'aller-retour moins le traitement de l'aeroglisseur
+    latency_start(3, 100, 50000, 4000);
+    CHECK(latency_complete(4, 70000, &remote) == FALSE);
+    CHECK(latency_complete(3, 70000, &remote) == TRUE);
+    CHECK(latency_complete(3, 70000, &remote) == FALSE);
+    CHECK(latency_get_min(LATENCY_WIFI) == 7500);
+}
+
+static void test_lcd(void)
+{
+    hd44780_sim_counters_t counters;
+    char row[LCD_NB_COL + 1];
+    uint8_t col;
+    uint8_t line;
+
+    setup();
+    hd44780_sim_init();
+
+    // deux function set (le premier front de E n'en est pas un), entry mode, display control, clear
+    lcd_init();
+    hd44780_sim_get_counters(&counters);
+    CHECK(hd44780_sim_is_configured() == TRUE);
+    CHECK(hd44780_sim_is_display_on() == TRUE && hd44780_sim_is_cursor_on() == TRUE);
+    CHECK(hd44780_sim_is_increment() == TRUE);
+    CHECK(counters.nb_commands == 5);
+    CHECK(counters.nb_timing_errors == 0);
+    CHECK(counters.nb_pulses == 5);
+    CHECK(counters.bus_us == 23268);
+
+    // ecran de la boucle principale de aero.c: clear, puis deux lignes separees par \r\n
+    hd44780_sim_reset_counters();
+    lcd_clear_display();
+    lcd_write_string("H128/V000/S220\r\nA:100%");
+    hd44780_sim_get_row(0, row);
+    CHECK(strcmp(row, "H128/V000/S220  ") == 0);
+    hd44780_sim_get_row(1, row);
+    CHECK(strcmp(row, "A:100%          ") == 0);
+
+    // 2 ms pour clear display, puis 100 us par transaction (clock_data): clear, \r, \n et 20 caracteres
+    hd44780_sim_get_counters(&counters);
+    CHECK(counters.nb_pulses == 23);
+    CHECK(counters.nb_commands == 3);
+    CHECK(counters.nb_writes == 20);
+    CHECK(counters.bus_us == 4300);
+    CHECK(counters.nb_timing_errors == 0);
+
+    // une ligne pleine continue sur la suivante, la fin de l'ecran revient au debut
+    lcd_clear_display();
+    lcd_write_string("0123456789abcdefghijklmnopqrstuvw");
+    hd44780_sim_get_row(0, row);
+    CHECK(strcmp(row, "w123456789abcdef") == 0);
+    hd44780_sim_get_row(1, row);
+    CHECK(strcmp(row, "ghijklmnopqrstuv") == 0);
+    CHECK(hd44780_sim_get_cursor(&col, &line) == TRUE && col == 1 && line == 0);
+
+    // \n sur la derniere ligne: l'ecriture suivante efface l'ecran et garde la colonne
+    lcd_clear_display();
+    lcd_write_string("a\nb\nc");
+    hd44780_sim_get_row(0, row);
+    CHECK(strcmp(row, "  c             ") == 0);
+    hd44780_sim_get_row(1, row);
+    CHECK(strcmp(row, "                ") == 0);
+    CHECK(hd44780_sim_get_cursor(&col, &line) == TRUE && col == 3 && line == 0);
+
+    // la version en flash donne le meme ecran
+    lcd_clear_display();
+    lcd_write_string_P(PSTR("waiting for data"));
+    hd44780_sim_get_row(0, row);
+    CHECK(strcmp(row, "waiting for data") == 0);
+
+    hd44780_sim_get_counters(&counters);
+    CHECK(counters.nb_timing_errors == 0);
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+static void test_firmware_frames(void)
+{
+    // avant la premiere commande, le ESP n'est pas en mode transparent: les reponses attendent
+    // AT+CIPSEND. Ensuite, une trame vide ne rejoue pas la trame precedente decodee dans le meme
+    // paquet.
+    static const firmware_step_t steps[] = {
+        {1500000, {FRAME_TYPE_PARAM_GET}, 1},
+        {2000000, {FRAME_TYPE_TRACE_REQUEST}, 1},
+        {3000000, {FRAME_TYPE_COMMAND, 127, 0, 0, 1}, 5},
+        {5000000, {FRAME_TYPE_PARAM_GET}, 1},
+        {6000000, {0}, 0}
+    };
+
+    firmware_run(steps, sizeof(steps) / sizeof(steps[0]), 7000000);
+
+    CHECK(firmware_cipsend_index == sizeof("AT+CIPSEND\r\n") - 1);
+    CHECK(firmware_replies_before_cipsend[FRAME_TYPE_PARAM_VALUES] == 0);
+    CHECK(firmware_replies_before_cipsend[FRAME_TYPE_TRACE_RECORD] == 0);
+    CHECK(firmware_replies_before[2][FRAME_TYPE_PARAM_VALUES] == 0);
+    CHECK(firmware_replies_before[3][FRAME_TYPE_PARAM_VALUES] == 1);
+    CHECK(firmware_replies_before[3][FRAME_TYPE_TRACE_RECORD] > 0);
+    CHECK(firmware_replies_before[3][FRAME_TYPE_TRACE_RECORD] <= TRACE_SIZE);
+    CHECK(firmware_replies_before[4][FRAME_TYPE_PARAM_VALUES] == 2);
+    CHECK(firmware_replies[FRAME_TYPE_PARAM_VALUES] == 2);
+    CHECK(firmware_replies[FRAME_TYPE_TRACE_RECORD] == firmware_replies_before[3][FRAME_TYPE_TRACE_RECORD]);
+}
+
+int main(void)
+{
+    test_fifo();
+    test_frame();
+    test_utils();
+    test_uart();
+    test_driver();
+    test_pwm();
+    test_failsafe();
+    test_packet();
+    test_config();
+    test_param();
+    test_profile();
+    test_launch();
+    test_time();
+    test_slew();
+    test_ramp();
+    test_stack();
+    test_latency();
+    test_lcd();
+
+    // le firmware garde son etat, il est execute en dernier
+    test_firmware_frames();
+
+    printf("%u verifications, %u echecs\n", nb_checks, nb_failures);
+
+    return (nb_failures == 0) ? 0 : 1;
+}
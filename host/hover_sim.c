@@ -0,0 +1,925 @@
+/**
+	\file hover_sim.c
+	\brief simulateur 2D de l'aeroglisseur pilote par le vrai firmware, sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: make sim, ou
+        host/hover_sim_race [-t ovale|drag] [options]
+        host/hover_sim_drag [-t ovale|drag] [options]
+
+        -t piste         ovale (tours, defaut) ou drag (ligne droite de -L metres)
+        -n tours         nombre de tours de l'ovale (defaut 3)
+        -L metres        longueur du drag (defaut 20)
+        -d secondes      temps simule maximal apres le depart (defaut 90)
+        -l ms            latence du lien manette -> aeroglisseur (defaut 5)
+        -j ms            gigue ajoutee a la latence, uniforme entre 0 et j (defaut 0)
+        -p pourcent      paquets perdus (defaut 0)
+        -P ms            periode des commandes de la manette (defaut 55)
+        -v 0..255        poussee maximale demandee par le pilote (defaut 255)
+        -s 0..255        sustentation demandee par le pilote (defaut 220)
+        -c us            impulsion du servo qui met le gouvernail droit sur l'aeroglisseur (defaut 1580)
+        -o fichier       trajectoire en CSV, un point aux 20 ms
+        -C fichier       capture (.ucap, host/capture.h) des bytes donnes au UART par le module wifi
+        -r graine        graine de la gigue et des pertes
+        -G courbe        depart joue par l'aeroglisseur (launch.h, profil drag): la courbe est
+                         armee SIM_ARM_US avant le depart, le "go" est envoye au depart et le
+                         pilote garde les manettes au neutre
+
+    Le programme compile aero.c sans changement avec la HAL de PC, son main() est renomme
+    firmware_main; hover_sim_race et hover_sim_drag demarrent avec le profil correspondant.
+    host/mcu_sim.c execute le firmware (temps, interruptions du UART, ADC) et le simulateur joue
+    ce qui entoure le microcontroleur:
+
+    - la manette envoie une commande [K, hor, ver, sus, seq] a chaque periode, le lien ajoute la
+      latence, la gigue et les pertes, puis le module wifi donne les bytes au UART a 9600 bauds;
+    - le pilote de la manette voit la position reelle de l'aeroglisseur au moment de l'envoi et
+      vise un point a SIM_LOOKAHEAD metres devant lui sur la ligne centrale de la piste;
+    - la physique lit les registres a chaque milliseconde: OCR2 (pwm_set_b, poussee), OCR0
+      (pwm_set_a, sustentation) et OCR1A (servo_set_a, gouvernail).
+
+    Modele physique (plan, SI):
+
+    - poussee = SIM_THRUST_MAX * (duty/255)^2 le long de l'axe de l'aeroglisseur;
+    - le gouvernail dans le souffle de l'helice devie la poussee: SIM_RUDDER_DEG_PER_US degres par
+      us d'impulsion a partir de -c, force laterale et couple de lacet a SIM_RUDDER_ARM de
+      l'axe de rotation;
+    - sans sustentation, le frottement sec SIM_GROUND_FRICTION * m * g empeche l'aeroglisseur de
+      bouger; il diminue lineairement entre SIM_LIFT_MIN et SIM_LIFT_FULL de sustentation;
+    - frottement visqueux (jupe) et trainee de l'air dans toutes les directions: l'aeroglisseur
+      glisse de cote dans les virages, comme le vrai;
+    - amortissement du lacet proportionnel a la vitesse de rotation.
+
+    Les constantes ne sont pas mesurees sur l'aeroglisseur, elles donnent un ordre de grandeur
+    plausible (vitesse maximale d'environ 4 m/s). Le simulateur sert a comparer deux reglages
+    (ANGLE_D/ANGLE_G/CENTER, courbe de poussee, latence, periode), pas a predire un temps au
+    dixieme pres.
+
+    Le resultat donne les temps de tour (ou le temps du drag), la vitesse maximale, les sorties
+    de piste, les trames de statut recues et le nombre de coupures du failsafe vu par la manette.
+    Les temps sont comptes a partir de l'envoi de la premiere commande de depart, SIM_LAUNCH_US
+    apres le demarrage du firmware (la configuration du wifi et le AT+CIPSEND prennent ~2.5 s).
+    Avec -G, ils sont comptes a partir de l'envoi du "go", ce qui permet de comparer les courbes
+    de depart entre elles et avec le pilote:
+
+        host/hover_sim_drag -t drag -G 0
+        host/hover_sim_drag -t drag -G 1
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hal.h"
+#include "utils.h"
+#include "frame.h"
+#include "launch.h"
+#include "host/capture.h"
+#include "host/mcu_sim.h"
+#include "host/time_stub.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// temps
+#define SIM_STEP_US 1000UL
+#define SIM_LOG_US 20000UL
+#define SIM_LAUNCH_US 3000000UL
+#define SIM_ARM_US 500000UL
+
+// lien
+#define SIM_MAX_PACKETS 64
+
+// aeroglisseur
+#define SIM_MASS 1.5
+#define SIM_INERTIA 0.05
+#define SIM_THRUST_MAX 5.0
+#define SIM_RUDDER_DEG_PER_US 0.09
+#define SIM_RUDDER_ARM 0.3
+#define SIM_LIFT_MIN 60.0
+#define SIM_LIFT_FULL 180.0
+#define SIM_GROUND_FRICTION 0.5
+#define SIM_LINEAR_DRAG 0.8
+#define SIM_QUADRATIC_DRAG 0.1
+#define SIM_YAW_DAMPING 0.08
+#define SIM_GRAVITY 9.81
+
+// pistes
+#define SIM_OVAL_STRAIGHT 10.0
+#define SIM_OVAL_RADIUS 4.0
+#define SIM_TRACK_HALF_WIDTH 1.2
+#define SIM_MAX_LAPS 16
+
+// pilote
+#define SIM_LOOKAHEAD 1.5
+#define SIM_BRAKE_LOOKAHEAD 4.0
+#define SIM_STEER_GAIN 160.0
+#define SIM_STEER_DAMPING 40.0
+#define SIM_SLOW_DOWN 0.6
+
+typedef enum
+{
+    TRACK_OVAL,
+    TRACK_DRAG
+}track_enum;
+
+/**
+    \brief etat de l'aeroglisseur, repere de la piste
+*/
+typedef struct
+{
+    double x;
+    double y;
+    double heading;
+    double vx;
+    double vy;
+    double yaw_rate;
+}craft_t;
+
+/**
+    \brief paquet UDP en route vers le module wifi de l'aeroglisseur
+*/
+typedef struct
+{
+    uint32_t arrival;
+    uint8_t length;
+    char data[FRAME_ENCODED_MAX_LENGTH];
+}packet_t;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+// options
+static track_enum track = TRACK_OVAL;
+static uint8_t nb_laps = 3;
+static double drag_length = 20.0;
+static double duration = 90.0;
+static uint32_t latency_us = 5000;
+static uint32_t jitter_us = 0;
+static double loss = 0.0;
+static uint32_t command_period_us = 55000;
+static uint8_t max_thrust = 255;
+static uint8_t lift = 220;
+static double servo_trim_us = 1580.0;
+static int launch_curve = -1;
+static FILE* output;
+static capture_t capture;
+
+static craft_t craft;
+
+// echeances, en temps de time_micros
+static uint32_t next_step;
+static uint32_t next_log;
+static uint32_t next_command;
+static uint32_t end_time;
+
+// lien
+static packet_t packets[SIM_MAX_PACKETS];
+static uint8_t nb_packets;
+static uint8_t seq;
+static bool launch_armed;
+static bool launch_started;
+
+// bytes envoyes par le firmware
+static frame_decoder_t status_decoder;
+static frame_t status;
+
+// resultats
+static uint32_t launch_time;
+static uint32_t nb_commands;
+static uint32_t nb_lost_packets;
+static uint32_t nb_status;
+static uint8_t trips;
+static double max_speed;
+static uint32_t nb_off_track;
+static uint32_t off_track_us;
+static bool off_track;
+static double max_lateral;
+static double laps[SIM_MAX_LAPS];
+static uint8_t nb_laps_done;
+static bool halfway;
+static double previous_progress;
+static double finish_time = -1.0;
+
+/******************************************************************************
+Static functions: piste
+******************************************************************************/
+static double wrap_angle(double angle)
+{
+    while(angle > M_PI)
+    {
+        angle -= 2.0 * M_PI;
+    }
+
+    while(angle < -M_PI)
+    {
+        angle += 2.0 * M_PI;
+    }
+
+    return angle;
+}
+
+static double oval_length(void)
+{
+    return 2.0 * SIM_OVAL_STRAIGHT + 2.0 * M_PI * SIM_OVAL_RADIUS;
+}
+
+/**
+    \brief point de la ligne centrale de l'ovale, parcourue dans le sens anti-horaire
+
+    s = 0 est la ligne de depart, au debut du droit du bas (0, -R) en direction de +x
+*/
+static void oval_point(double s, double* x, double* y)
+{
+    double length = oval_length();
+    double arc = M_PI * SIM_OVAL_RADIUS;
+
+    s = fmod(s, length);
+
+    if(s < 0)
+    {
+        s += length;
+    }
+
+    if(s < SIM_OVAL_STRAIGHT)
+    {
+        *x = s;
+        *y = -SIM_OVAL_RADIUS;
+    }
+    else if(s < SIM_OVAL_STRAIGHT + arc)
+    {
+        double angle = -M_PI / 2.0 + (s - SIM_OVAL_STRAIGHT) / SIM_OVAL_RADIUS;
+
+        *x = SIM_OVAL_STRAIGHT + SIM_OVAL_RADIUS * cos(angle);
+        *y = SIM_OVAL_RADIUS * sin(angle);
+    }
+    else if(s < 2.0 * SIM_OVAL_STRAIGHT + arc)
+    {
+        *x = SIM_OVAL_STRAIGHT - (s - SIM_OVAL_STRAIGHT - arc);
+        *y = SIM_OVAL_RADIUS;
+    }
+    else
+    {
+        double angle = M_PI / 2.0 + (s - 2.0 * SIM_OVAL_STRAIGHT - arc) / SIM_OVAL_RADIUS;
+
+        *x = SIM_OVAL_RADIUS * cos(angle);
+        *y = SIM_OVAL_RADIUS * sin(angle);
+    }
+}
+
+/**
+    \brief projette une position sur la ligne centrale de l'ovale
+    \param[out] distance la distance a la ligne centrale
+    \return l'abscisse curviligne du point le plus proche
+*/
+static double oval_project(double x, double y, double* distance)
+{
+    double arc = M_PI * SIM_OVAL_RADIUS;
+    double angle;
+
+    // droit du bas
+    if(y < 0 && x >= 0 && x <= SIM_OVAL_STRAIGHT)
+    {
+        *distance = fabs(y + SIM_OVAL_RADIUS);
+
+        return x;
+    }
+
+    // droit du haut
+    if(y >= 0 && x >= 0 && x <= SIM_OVAL_STRAIGHT)
+    {
+        *distance = fabs(y - SIM_OVAL_RADIUS);
+
+        return SIM_OVAL_STRAIGHT + arc + (SIM_OVAL_STRAIGHT - x);
+    }
+
+    // virage de droite, centre (SIM_OVAL_STRAIGHT, 0)
+    if(x > SIM_OVAL_STRAIGHT)
+    {
+        angle = atan2(y, x - SIM_OVAL_STRAIGHT);
+        *distance = fabs(hypot(x - SIM_OVAL_STRAIGHT, y) - SIM_OVAL_RADIUS);
+
+        return SIM_OVAL_STRAIGHT + (angle + M_PI / 2.0) * SIM_OVAL_RADIUS;
+    }
+
+    // virage de gauche, centre (0, 0)
+    angle = atan2(y, x);
+
+    if(angle < 0)
+    {
+        angle += 2.0 * M_PI;
+    }
+
+    *distance = fabs(hypot(x, y) - SIM_OVAL_RADIUS);
+
+    return 2.0 * SIM_OVAL_STRAIGHT + arc + (angle - M_PI / 2.0) * SIM_OVAL_RADIUS;
+}
+
+static double seconds_since_launch(void)
+{
+    return (time_micros() - launch_time) / 1e6;
+}
+
+/**
+    \brief tours, sorties de piste et arrivee du drag, apres chaque pas de physique
+*/
+static void update_race(void)
+{
+    double distance;
+    double progress;
+    double length = oval_length();
+    double speed = hypot(craft.vx, craft.vy);
+    bool outside;
+
+    if(speed > max_speed)
+    {
+        max_speed = speed;
+    }
+
+    if(track == TRACK_DRAG)
+    {
+        distance = fabs(craft.y);
+
+        if(craft.x >= drag_length && finish_time < 0)
+        {
+            finish_time = seconds_since_launch();
+            mcu_sim_stop();
+        }
+    }
+    else
+    {
+        progress = oval_project(craft.x, craft.y, &distance);
+
+        if(progress > 0.4 * length && progress < 0.6 * length)
+        {
+            halfway = TRUE;
+        }
+
+        // la ligne de depart est franchie vers l'avant apres un passage de l'autre cote
+        if(halfway && previous_progress > 0.9 * length && progress < 0.1 * length)
+        {
+            laps[nb_laps_done] = seconds_since_launch();
+            nb_laps_done++;
+            halfway = FALSE;
+
+            if(nb_laps_done >= nb_laps)
+            {
+                mcu_sim_stop();
+            }
+        }
+
+        previous_progress = progress;
+    }
+
+    if(distance > max_lateral)
+    {
+        max_lateral = distance;
+    }
+
+    outside = (distance > SIM_TRACK_HALF_WIDTH);
+
+    if(outside && !off_track)
+    {
+        nb_off_track++;
+    }
+
+    if(outside)
+    {
+        off_track_us += SIM_STEP_US;
+    }
+
+    off_track = outside;
+}
+
+/******************************************************************************
+Static functions: physique
+******************************************************************************/
+/**
+    \brief un pas de physique avec les sorties du microcontroleur
+*/
+static void step_physics(double dt)
+{
+    // un duty de 0 coupe le comparateur, la sortie reste a 0
+    double thrust_duty = read_bit(hal_host_peek8(HAL_TCCR2), COM21) ? hal_host_peek8(HAL_OCR2) : 0;
+    double lift_duty = read_bit(hal_host_peek8(HAL_TCCR0), COM01) ? hal_host_peek8(HAL_OCR0) : 0;
+    double rudder = (hal_host_peek16(HAL_OCR1A) - servo_trim_us) * SIM_RUDDER_DEG_PER_US * M_PI / 180.0;
+
+    double thrust = SIM_THRUST_MAX * (thrust_duty / 255.0) * (thrust_duty / 255.0);
+    double lifted = (lift_duty - SIM_LIFT_MIN) / (SIM_LIFT_FULL - SIM_LIFT_MIN);
+    double cos_heading = cos(craft.heading);
+    double sin_heading = sin(craft.heading);
+    double forward;
+    double lateral;
+    double fx;
+    double fy;
+    double speed;
+    double drag;
+    double friction;
+    double torque;
+
+    if(lifted < 0)
+    {
+        lifted = 0;
+    }
+    else if(lifted > 1)
+    {
+        lifted = 1;
+    }
+
+    // une impulsion plus longue tourne vers la droite (sens horaire)
+    forward = thrust * cos(rudder);
+    lateral = -thrust * sin(rudder);
+    torque = lateral * SIM_RUDDER_ARM - SIM_YAW_DAMPING * craft.yaw_rate;
+
+    fx = forward * cos_heading - lateral * sin_heading;
+    fy = forward * sin_heading + lateral * cos_heading;
+
+    speed = hypot(craft.vx, craft.vy);
+    drag = SIM_LINEAR_DRAG + SIM_QUADRATIC_DRAG * speed;
+    fx -= drag * craft.vx;
+    fy -= drag * craft.vy;
+
+    craft.vx += fx / SIM_MASS * dt;
+    craft.vy += fy / SIM_MASS * dt;
+
+    // le frottement sec arrete l'aeroglisseur sans jamais l'accelerer dans l'autre sens
+    friction = SIM_GROUND_FRICTION * (1.0 - lifted) * SIM_GRAVITY * dt;
+    speed = hypot(craft.vx, craft.vy);
+
+    if(speed <= friction)
+    {
+        craft.vx = 0;
+        craft.vy = 0;
+    }
+    else
+    {
+        craft.vx -= craft.vx / speed * friction;
+        craft.vy -= craft.vy / speed * friction;
+    }
+
+    craft.yaw_rate += torque / SIM_INERTIA * dt;
+
+    // sans sustentation, la jupe empeche aussi la rotation
+    craft.yaw_rate *= lifted + (1.0 - lifted) * 0.9;
+
+    craft.x += craft.vx * dt;
+    craft.y += craft.vy * dt;
+    craft.heading = wrap_angle(craft.heading + craft.yaw_rate * dt);
+}
+
+static void log_point(void)
+{
+    if(output != NULL)
+    {
+        fprintf(output, "%.3f,%.3f,%.3f,%.1f,%.3f,%u,%u,%u\n",
+                ((int32_t)(time_micros() - launch_time)) / 1e6, craft.x, craft.y,
+                craft.heading * 180.0 / M_PI, hypot(craft.vx, craft.vy),
+                read_bit(hal_host_peek8(HAL_TCCR2), COM21) ? hal_host_peek8(HAL_OCR2) : 0,
+                read_bit(hal_host_peek8(HAL_TCCR0), COM01) ? hal_host_peek8(HAL_OCR0) : 0,
+                hal_host_peek16(HAL_OCR1A));
+    }
+}
+
+/******************************************************************************
+Static functions: manette et lien
+******************************************************************************/
+static uint8_t clamp_stick(double value)
+{
+    if(value < 0)
+    {
+        return 0;
+    }
+
+    if(value > 255)
+    {
+        return 255;
+    }
+
+    return (uint8_t)(value + 0.5);
+}
+
+/**
+    \brief le pilote choisit la commande a partir de la position reelle de l'aeroglisseur
+*/
+static void pilot(uint8_t* hor, uint8_t* ver, uint8_t* sus)
+{
+    double target_x;
+    double target_y;
+    double far_x;
+    double far_y;
+    double distance;
+    double progress;
+    double error;
+    double far_error;
+    double steer;
+
+    // attend le depart avec les moteurs coupes
+    if((int32_t)(time_micros() - launch_time) < 0)
+    {
+        *hor = 128;
+        *ver = 0;
+        *sus = 0;
+
+        return;
+    }
+
+    // la courbe de depart de l'aeroglisseur garde la main tant que les manettes sont au neutre
+    if(launch_curve >= 0)
+    {
+        *hor = 128;
+        *ver = 0;
+        *sus = lift;
+
+        return;
+    }
+
+    if(track == TRACK_DRAG)
+    {
+        target_x = craft.x + SIM_LOOKAHEAD;
+        target_y = 0;
+        far_x = craft.x + SIM_BRAKE_LOOKAHEAD;
+        far_y = 0;
+    }
+    else
+    {
+        progress = oval_project(craft.x, craft.y, &distance);
+        oval_point(progress + SIM_LOOKAHEAD, &target_x, &target_y);
+        oval_point(progress + SIM_BRAKE_LOOKAHEAD, &far_x, &far_y);
+    }
+
+    error = wrap_angle(atan2(target_y - craft.y, target_x - craft.x) - craft.heading);
+    far_error = wrap_angle(atan2(far_y - craft.y, far_x - craft.x) - craft.heading);
+
+    // une erreur positive demande de tourner a gauche, donc un hor plus petit
+    steer = SIM_STEER_GAIN * error - SIM_STEER_DAMPING * craft.yaw_rate;
+
+    *hor = clamp_stick(128.0 - steer);
+    // ralentit avant les virages, sans couper la poussee qui fait tourner le gouvernail
+    *ver = clamp_stick(max_thrust * (1.0 - SIM_SLOW_DOWN * fmin(1.0, fabs(far_error) / 0.6)));
+    *sus = lift;
+}
+
+static uint32_t random_below(uint32_t limit)
+{
+    return limit ? (uint32_t)(rand() % limit) : 0;
+}
+
+/**
+    \brief la manette envoie une trame, le lien la retarde ou la perd
+*/
+static void send_frame(const uint8_t* data, uint8_t length)
+{
+    packet_t* packet;
+
+    if(rand() < loss * RAND_MAX || nb_packets == SIM_MAX_PACKETS)
+    {
+        nb_lost_packets++;
+
+        return;
+    }
+
+    packet = &packets[nb_packets++];
+    packet->arrival = time_micros() + latency_us + random_below(jitter_us + 1);
+    packet->length = frame_encode(packet->data, data, length);
+}
+
+static void send_command(void)
+{
+    uint8_t command[5];
+
+    command[0] = FRAME_TYPE_COMMAND;
+    pilot(&command[1], &command[2], &command[3]);
+    command[4] = seq++;
+    nb_commands++;
+
+    send_frame(command, sizeof(command));
+}
+
+/**
+    \brief arme la courbe de depart avant le depart, puis envoie le "go" au depart
+*/
+static void send_launch(void)
+{
+    uint8_t request[3] = {FRAME_TYPE_LAUNCH, LAUNCH_ARM, (uint8_t)launch_curve};
+
+    if(!launch_armed && (int32_t)(time_micros() - (launch_time - SIM_ARM_US)) >= 0)
+    {
+        send_frame(request, sizeof(request));
+        launch_armed = TRUE;
+    }
+
+    if(!launch_started && (int32_t)(time_micros() - launch_time) >= 0)
+    {
+        request[1] = LAUNCH_GO;
+        send_frame(request, 2);
+        launch_started = TRUE;
+    }
+}
+
+/**
+    \brief le module wifi donne les paquets arrives au UART, dans l'ordre d'arrivee
+*/
+static void deliver_packets(void)
+{
+    uint32_t at;
+    uint8_t i;
+    uint8_t j;
+    uint8_t k;
+
+    for(i = 0; i < nb_packets;)
+    {
+        if((int32_t)(time_micros() - packets[i].arrival) < 0)
+        {
+            i++;
+            continue;
+        }
+
+        // le plus ancien des paquets arrives passe en premier
+        k = i;
+
+        for(j = i + 1; j < nb_packets; j++)
+        {
+            if((int32_t)(time_micros() - packets[j].arrival) >= 0 &&
+               (int32_t)(packets[j].arrival - packets[k].arrival) < 0)
+            {
+                k = j;
+            }
+        }
+
+        // les bytes se suivent sur la ligne a 9600 bauds
+        at = mcu_sim_get_line_free_at();
+
+        for(j = 0; j < packets[k].length; j++)
+        {
+            at += MCU_SIM_BYTE_US;
+
+            if(mcu_sim_receive(at, packets[k].data[j]) && capture.file != NULL)
+            {
+                capture_write(&capture, at, packets[k].data[j]);
+            }
+        }
+
+        packets[k] = packets[--nb_packets];
+    }
+}
+
+/**
+    \brief la manette recoit les trames de statut, les reponses AT sont ignorees
+*/
+static void receive_status(uint8_t byte)
+{
+    if(frame_decoder_push(&status_decoder, byte, &status) == TRUE &&
+       status.data[0] == FRAME_TYPE_STATUS && status.length >= 3)
+    {
+        nb_status++;
+        trips = status.data[2];
+    }
+}
+
+/**
+    \brief traite tout ce qui arrive au temps courant
+*/
+static void service(void)
+{
+    uint8_t i;
+
+    while((int32_t)(time_micros() - next_command) >= 0)
+    {
+        send_command();
+        next_command += command_period_us;
+    }
+
+    if(launch_curve >= 0)
+    {
+        send_launch();
+    }
+
+    deliver_packets();
+
+    while((int32_t)(time_micros() - next_step) >= 0)
+    {
+        step_physics(SIM_STEP_US / 1e6);
+        next_step += SIM_STEP_US;
+
+        if((int32_t)(time_micros() - launch_time) >= 0)
+        {
+            update_race();
+        }
+    }
+
+    while((int32_t)(time_micros() - next_log) >= 0)
+    {
+        log_point();
+        next_log += SIM_LOG_US;
+    }
+
+    if((int32_t)(time_micros() - end_time) >= 0)
+    {
+        mcu_sim_stop();
+    }
+
+    mcu_sim_wake_at(next_step);
+    mcu_sim_wake_at(next_command);
+
+    for(i = 0; i < nb_packets; i++)
+    {
+        mcu_sim_wake_at(packets[i].arrival);
+    }
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-t ovale|drag] [-n tours] [-L metres] [-d secondes] [-l ms] [-j ms]\n"
+                    "       [-p pourcent] [-P ms] [-v poussee] [-s sustentation] [-c us] [-o fichier]\n"
+                    "       [-C fichier] [-r graine] [-G courbe]\n", name);
+    exit(2);
+}
+
+static void print_results(double real_time)
+{
+    uint8_t i;
+    double best = 0;
+
+    printf("piste %s, latence %.1f ms + 0..%.1f ms, pertes %.1f%%, periode %.0f ms\n",
+           (track == TRACK_DRAG) ? "drag" : "ovale", latency_us / 1000.0, jitter_us / 1000.0,
+           loss * 100.0, command_period_us / 1000.0);
+
+    if(track == TRACK_DRAG)
+    {
+        if(finish_time >= 0)
+        {
+            printf("temps du drag (%.0f m)  %8.3f s\n", drag_length, finish_time);
+        }
+        else
+        {
+            printf("temps du drag (%.0f m)  non termine, x = %.2f m\n", drag_length, craft.x);
+        }
+    }
+    else
+    {
+        for(i = 0; i < nb_laps_done; i++)
+        {
+            double lap = laps[i] - (i ? laps[i - 1] : 0);
+
+            printf("tour %u                 %8.3f s\n", i + 1, lap);
+
+            if(i == 0 || lap < best)
+            {
+                best = lap;
+            }
+        }
+
+        if(nb_laps_done < nb_laps)
+        {
+            printf("tours termines          %u sur %u\n", nb_laps_done, nb_laps);
+        }
+        else
+        {
+            printf("total                  %8.3f s, meilleur tour %.3f s\n", laps[nb_laps_done - 1], best);
+        }
+    }
+
+    printf("vitesse max            %8.2f m/s\n", max_speed);
+    printf("ecart max              %8.2f m de la ligne centrale\n", max_lateral);
+    printf("sorties de piste       %8u (%.2f s hors piste)\n", nb_off_track, off_track_us / 1e6);
+    printf("commandes              %8u envoyees, %u perdues par le lien\n", nb_commands, nb_lost_packets);
+    printf("bytes ecrases (UART)   %8u\n", mcu_sim_get_overruns());
+    printf("statuts recus          %8u, coupures failsafe %u\n", nb_status, trips);
+    printf("temps simule           %8.3f s en %.3f s\n", time_micros() / 1e6, real_time);
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    struct timespec start;
+    struct timespec stop;
+    unsigned int seed = 1;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if(argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' || value == NULL)
+        {
+            usage(argv[0]);
+        }
+
+        switch(argv[i][1])
+        {
+            case 't':
+                if(strcmp(value, "drag") == 0)
+                {
+                    track = TRACK_DRAG;
+                }
+                else if(strcmp(value, "ovale") == 0)
+                {
+                    track = TRACK_OVAL;
+                }
+                else
+                {
+                    usage(argv[0]);
+                }
+                break;
+
+            case 'n':
+                nb_laps = atoi(value);
+                if(nb_laps < 1 || nb_laps > SIM_MAX_LAPS)
+                {
+                    usage(argv[0]);
+                }
+                break;
+
+            case 'L': drag_length = atof(value); break;
+            case 'd': duration = atof(value); break;
+            case 'l': latency_us = atof(value) * 1000.0; break;
+            case 'j': jitter_us = atof(value) * 1000.0; break;
+            case 'p': loss = atof(value) / 100.0; break;
+            case 'P': command_period_us = atof(value) * 1000.0; break;
+            case 'v': max_thrust = atoi(value); break;
+            case 's': lift = atoi(value); break;
+            case 'c': servo_trim_us = atof(value); break;
+            case 'r': seed = strtoul(value, NULL, 0); break;
+            case 'G': launch_curve = atoi(value); break;
+
+            case 'o':
+                output = fopen(value, "w");
+                if(output == NULL)
+                {
+                    perror(value);
+                    return 1;
+                }
+                fprintf(output, "t,x,y,cap,vitesse,poussee,sustentation,servo\n");
+                break;
+
+            case 'C':
+                if(capture_create(&capture, value) != 0)
+                {
+                    perror(value);
+                    return 1;
+                }
+                break;
+
+            default:
+                usage(argv[0]);
+        }
+
+        i++;
+    }
+
+    if(command_period_us == 0)
+    {
+        usage(argv[0]);
+    }
+
+    srand(seed);
+
+    // l'aeroglisseur attend sur la ligne de depart, dans l'axe de la piste
+    memset(&craft, 0, sizeof(craft));
+    if(track == TRACK_OVAL)
+    {
+        craft.y = -SIM_OVAL_RADIUS;
+    }
+
+    mcu_sim_init();
+    frame_decoder_init(&status_decoder);
+
+    launch_time = SIM_LAUNCH_US;
+    end_time = launch_time + (uint32_t)(duration * 1e6);
+    next_step = SIM_STEP_US;
+    next_log = launch_time;
+    next_command = 0;
+
+    mcu_sim_set_service(service);
+    mcu_sim_set_transmit(receive_status);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // le firmware ne retourne jamais, service() l'arrete a la fin de la course
+    mcu_sim_run();
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    print_results((stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) * 1e-9);
+
+    if(output != NULL)
+    {
+        fclose(output);
+    }
+
+    capture_close(&capture);
+
+    return 0;
+}
@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+"""
+    \file link_model.py
+    \brief modele du protocole manette/aeroglisseur sous chaque profil de udp_relay
+    \author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+    \date 19/10/26
+
+    Usage: make host/udp_relay && host/link_model.py [-d secondes] [-p profil] [-p profil ...] [-s graine]
+
+    Chaque -p ajoute un profil, tous les profils sont joues sans -p.
+
+    Pour chaque profil, le script demarre host/udp_relay entre deux extremites ecrites en Python
+    qui imitent le protocole des firmwares. Les firmwares eux-memes ne sont pas executes: le
+    tableau verifie le protocole (boite aux lettres, failsafe, seq), pas le code de aero.c ou de
+    manette.c. Le firmware de l'aeroglisseur est execute derriere un lien degrade par
+    host/hover_sim.c (options -l et -p, make sim) et avec des captures reelles par
+    make replay_check.
+
+    - la manette envoie une trame de commande [K, hor, ver, sus, seq] toutes les 55 ms (50 ms
+      d'attente plus la boucle) vers 127.0.0.1:1337 depuis le port 31337;
+    - l'aeroglisseur ecoute sur 127.0.0.2:1337, applique la derniere commande de chaque paquet
+      (boite aux lettres) et repond par une trame de statut qui renvoie seq.
+
+    Pour chaque profil, le tableau donne:
+
+    - perdues: commandes jamais appliquees par l'aeroglisseur
+    - perimees: commandes appliquees apres une commande plus recente (le firmware ne compare pas
+      seq, il applique donc une consigne plus vieille que celle deja en place)
+    - doubles: commandes appliquees deux fois
+    - coupures: silences plus longs que FAILSAFE_TIMEOUT_MS (750 ms), le failsafe coupe les moteurs
+    - retour max: plus long silence de commande apres une coupure, jusqu'a la commande suivante
+    - reponses: pourcentage des commandes dont la manette a recu la reponse
+    - rtt p50/p99: aller-retour vu par la manette
+"""
+
+import argparse
+import os
+import select
+import signal
+import socket
+import subprocess
+import sys
+import time
+
+ESCAPE = ord('A')
+BEGIN = ord('B')
+END = ord('C')
+VALUE = ord('A')
+ZERO_VALUE = ord('D')
+
+TYPE_COMMAND = ord('K')
+TYPE_STATUS = ord('S')
+
+COMMAND_PERIOD = 0.055
+FAILSAFE_TIMEOUT = 0.750
+
+RELAY_ADDRESS = ('127.0.0.1', 1337)
+HOVERCRAFT_ADDRESS = ('127.0.0.2', 1337)
+CONTROLLER_PORT = 31337
+
+PROFILES = ['clean', 'wifi', 'jitter', 'burst', 'congested', 'reorder', 'outage']
+
+
+def encode(data):
+    """meme encodage que frame_encode"""
+    out = bytearray([ESCAPE, BEGIN])
+
+    for byte in data:
+        if byte == ESCAPE:
+            out += bytes([ESCAPE, VALUE])
+        elif byte == 0:
+            out += bytes([ESCAPE, ZERO_VALUE])
+        else:
+            out.append(byte)
+
+    out += bytes([ESCAPE, END])
+
+    return bytes(out)
+
+
+def decode(packet):
+    """retourne les trames completes d'un paquet, dans l'ordre"""
+    frames = []
+    data = None
+    escaped = False
+
+    for byte in packet:
+        if escaped:
+            escaped = False
+
+            if byte == BEGIN:
+                data = bytearray()
+            elif data is None:
+                continue
+            elif byte == END:
+                frames.append(bytes(data))
+                data = None
+            elif byte == VALUE:
+                data.append(ESCAPE)
+            elif byte == ZERO_VALUE:
+                data.append(0)
+            else:
+                data = None
+        elif byte == ESCAPE:
+            escaped = True
+        elif data is not None:
+            data.append(byte)
+
+    return frames
+
+
+def percentile(values, percent):
+    if not values:
+        return float('nan')
+
+    values = sorted(values)
+
+    return values[min(len(values) - 1, int(len(values) * percent / 100))]
+
+
+def run_profile(relay, profile, duration, seed):
+    relay_process = subprocess.Popen([relay, '-l', '%s:%d' % RELAY_ADDRESS,
+                                      '-t', '%s:%d' % HOVERCRAFT_ADDRESS,
+                                      '-p', profile, '-s', str(seed)],
+                                     stderr=subprocess.PIPE)
+    time.sleep(0.2)
+
+    controller = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    controller.bind(('127.0.0.1', CONTROLLER_PORT))
+    hovercraft = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    hovercraft.bind(HOVERCRAFT_ADDRESS)
+
+    # les deux extremites sont dans ce processus: l'aeroglisseur retrouve l'envoi d'un seq
+    sent_at = {}
+    index_of_seq = {}
+    rtts = []
+    nb_sent = 0
+    nb_replies = 0
+
+    applied = set()
+    newest_applied = -1
+    last_applied_time = None
+    nb_stale = 0
+    nb_duplicated = 0
+    nb_trips = 0
+    recovery = 0.0
+
+    seq = 0
+    start = time.monotonic()
+    next_command = start
+
+    while time.monotonic() - start < duration:
+        now = time.monotonic()
+
+        if now >= next_command:
+            frame = encode(bytes([TYPE_COMMAND, 128, 200, 150, seq]))
+            controller.sendto(frame, RELAY_ADDRESS)
+            sent_at[nb_sent] = now
+            index_of_seq[seq] = nb_sent
+            nb_sent += 1
+            seq = (seq + 1) & 0xFF
+            next_command += COMMAND_PERIOD
+
+        readable, _, _ = select.select([controller, hovercraft], [], [],
+                                       max(0, next_command - time.monotonic()))
+
+        for sock in readable:
+            packet, sender = sock.recvfrom(2048)
+            now = time.monotonic()
+
+            if sock is hovercraft:
+                # boite aux lettres: seule la derniere commande du paquet est appliquee
+                commands = [f for f in decode(packet) if len(f) >= 5 and f[0] == TYPE_COMMAND]
+
+                if not commands:
+                    continue
+
+                command_seq = commands[-1][4]
+                index = index_of_seq[command_seq]
+
+                if last_applied_time is not None and now - last_applied_time > FAILSAFE_TIMEOUT:
+                    nb_trips += 1
+                    recovery = max(recovery, now - last_applied_time)
+
+                if index in applied:
+                    nb_duplicated += 1
+                elif index < newest_applied:
+                    nb_stale += 1
+
+                applied.add(index)
+                newest_applied = max(newest_applied, index)
+                last_applied_time = now
+                hovercraft.sendto(encode(bytes([TYPE_STATUS, 80, nb_trips & 0xFF, command_seq])),
+                                  sender)
+            else:
+                for status in decode(packet):
+                    if len(status) >= 4 and status[0] == TYPE_STATUS:
+                        index = index_of_seq.get(status[3])
+
+                        if index in sent_at:
+                            rtts.append(now - sent_at.pop(index))
+                            nb_replies += 1
+
+    controller.close()
+    hovercraft.close()
+    relay_process.send_signal(signal.SIGINT)
+    relay_process.wait()
+
+    # les commandes encore en route a la fin ne sont pas comptees comme perdues
+    nb_lost = max(0, newest_applied + 1 - len(applied))
+
+    return {
+        'profile': profile,
+        'sent': nb_sent,
+        'lost': nb_lost,
+        'stale': nb_stale,
+        'duplicated': nb_duplicated,
+        'trips': nb_trips,
+        'recovery': recovery,
+        'replies': 100.0 * nb_replies / max(1, nb_sent),
+        'rtt50': percentile(rtts, 50) * 1000,
+        'rtt99': percentile(rtts, 99) * 1000,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description='modele du protocole sous chaque profil de udp_relay')
+    parser.add_argument('-d', '--duration', type=float, default=15.0,
+                        help='duree de chaque profil en secondes')
+    parser.add_argument('-p', '--profile', action='append', choices=PROFILES,
+                        help='profil a jouer, repeter -p pour plusieurs profils (tous par defaut)')
+    parser.add_argument('-s', '--seed', type=int, default=1)
+    parser.add_argument('--relay', default=os.path.join(os.path.dirname(__file__), 'udp_relay'))
+    arguments = parser.parse_args()
+
+    if not os.access(arguments.relay, os.X_OK):
+        sys.exit('%s introuvable, lancer make host/udp_relay' % arguments.relay)
+
+    print('%-10s %7s %7s %8s %7s %8s %11s %9s %9s %9s' % (
+        'profil', 'envoyes', 'perdues', 'perimees', 'doubles', 'coupures', 'retour max',
+        'reponses', 'rtt p50', 'rtt p99'))
+
+    for profile in arguments.profile or PROFILES:
+        r = run_profile(arguments.relay, profile, arguments.duration, arguments.seed)
+        print('%-10s %7d %7d %8d %7d %8d %9.0f ms %8.1f%% %6.1f ms %6.1f ms' % (
+            r['profile'], r['sent'], r['lost'], r['stale'], r['duplicated'], r['trips'],
+            r['recovery'] * 1000, r['replies'], r['rtt50'], r['rtt99']))
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,324 @@
+/**
+	\file mcu_sim.c
+	\brief execute un firmware sur PC avec le temps, les interruptions et le UART simules
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <setjmp.h>
+#include <stddef.h>
+
+#include "hal.h"
+#include "stack.h"
+#include "host/eeprom_sim.h"
+#include "host/mcu_sim.h"
+#include "host/time_stub.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief byte en route sur la ligne RX
+*/
+typedef struct
+{
+    uint32_t at;
+    uint8_t byte;
+}line_byte_t;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static jmp_buf stopped;
+
+// les interruptions et le timer executes ici accedent aussi aux registres
+static bool advancing;
+
+static mcu_sim_service_t service;
+static mcu_sim_transmit_t transmit;
+
+static bool wake_requested;
+static uint32_t wake_at;
+
+static line_byte_t line[MCU_SIM_LINE_LENGTH];
+static uint16_t line_head;
+static uint16_t line_count;
+static uint32_t line_free_at;
+
+static bool rx_pending;
+static uint8_t rx_byte;
+static uint32_t tx_free_at;
+static uint32_t nb_overruns;
+
+static uint8_t adc_values[8];
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static bool is_reached(uint32_t at);
+static void service_uart(void);
+static void step(void);
+static void advance(uint32_t us);
+static void access_hook(void);
+static void delay_hook(uint32_t us);
+static void observer(hal_reg8_enum reg, uint8_t old_value, uint8_t new_value);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void mcu_sim_init(void)
+{
+    uint8_t i;
+
+    hal_host_reset();
+    time_stub_reset();
+
+    // comme le code de demarrage de l'ATmega32, la pile du firmware n'est pas simulee
+    stack_paint();
+
+    // une puce neuve: le firmware demarre avec ses reglages par defaut
+    eeprom_sim_erase();
+
+    advancing = FALSE;
+    service = NULL;
+    transmit = NULL;
+    wake_requested = FALSE;
+    line_head = 0;
+    line_count = 0;
+    line_free_at = 0;
+    rx_pending = FALSE;
+    tx_free_at = 0;
+    nb_overruns = 0;
+
+    // batterie pleine pour aero.c: ((133 - 107) * 100) / 26 = 100%
+    for(i = 0; i < 8; i++)
+    {
+        adc_values[i] = 133;
+    }
+
+    hal_host_set_observer(observer);
+    hal_host_set_delay_hook(delay_hook);
+    hal_host_set_access_hook(access_hook);
+}
+
+void mcu_sim_run(void)
+{
+    char* argv[] = {"firmware", NULL};
+
+    // le firmware ne retourne jamais, mcu_sim_stop revient ici
+    if(setjmp(stopped) == 0)
+    {
+        firmware_main(1, argv);
+    }
+
+    hal_host_set_access_hook(NULL);
+    hal_host_set_delay_hook(NULL);
+    advancing = FALSE;
+}
+
+void mcu_sim_stop(void)
+{
+    longjmp(stopped, 1);
+}
+
+void mcu_sim_set_service(mcu_sim_service_t new_service)
+{
+    service = new_service;
+}
+
+void mcu_sim_set_transmit(mcu_sim_transmit_t new_transmit)
+{
+    transmit = new_transmit;
+}
+
+void mcu_sim_wake_at(uint32_t at)
+{
+    if(!wake_requested || (int32_t)(at - wake_at) < 0)
+    {
+        wake_at = at;
+        wake_requested = TRUE;
+    }
+}
+
+bool mcu_sim_receive(uint32_t at, uint8_t byte)
+{
+    line_byte_t* entry;
+
+    if(line_count == MCU_SIM_LINE_LENGTH)
+    {
+        return FALSE;
+    }
+
+    entry = &line[(line_head + line_count) % MCU_SIM_LINE_LENGTH];
+    entry->at = at;
+    entry->byte = byte;
+    line_count++;
+    line_free_at = at;
+
+    return TRUE;
+}
+
+uint32_t mcu_sim_get_line_free_at(void)
+{
+    // la ligne est libre depuis le dernier byte, mais pas avant maintenant
+    if(line_count == 0 || is_reached(line_free_at))
+    {
+        return time_micros();
+    }
+
+    return line_free_at;
+}
+
+void mcu_sim_set_adc(uint8_t channel, uint8_t value)
+{
+    adc_values[channel & 0x07] = value;
+}
+
+uint32_t mcu_sim_get_overruns(void)
+{
+    return nb_overruns;
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static bool is_reached(uint32_t at)
+{
+    return (int32_t)(time_micros() - at) >= 0;
+}
+
+/**
+    \brief execute les interruptions du UART qui sont permises
+*/
+static void service_uart(void)
+{
+    bool enabled = read_bit(hal_host_peek8(HAL_SREG), SREG_I);
+
+    // chaque byte complet passe dans UDR, en ecrasant celui qui n'a pas encore ete lu
+    while(line_count > 0 && is_reached(line[line_head].at))
+    {
+        if(rx_pending)
+        {
+            nb_overruns++;
+        }
+
+        rx_byte = line[line_head].byte;
+        rx_pending = TRUE;
+        line_head = (line_head + 1) % MCU_SIM_LINE_LENGTH;
+        line_count--;
+
+        if(enabled && read_bit(hal_host_peek8(HAL_UCSRB), RXCIE))
+        {
+            rx_pending = FALSE;
+            hal_host_poke8(HAL_UDR, rx_byte);
+            hal_host_run_isr(USART_RXC_vect);
+        }
+    }
+
+    if(rx_pending && enabled && read_bit(hal_host_peek8(HAL_UCSRB), RXCIE))
+    {
+        rx_pending = FALSE;
+        hal_host_poke8(HAL_UDR, rx_byte);
+        hal_host_run_isr(USART_RXC_vect);
+    }
+
+    if(enabled && read_bit(hal_host_peek8(HAL_UCSRB), UDRIE) && is_reached(tx_free_at))
+    {
+        hal_host_run_isr(USART_UDRE_vect);
+        tx_free_at = time_micros() + MCU_SIM_BYTE_US;
+
+        if(transmit != NULL)
+        {
+            transmit(hal_host_peek8(HAL_UDR));
+        }
+    }
+}
+
+/**
+    \brief traite tout ce qui arrive au temps courant
+*/
+static void step(void)
+{
+    if(wake_requested && is_reached(wake_at))
+    {
+        wake_requested = FALSE;
+    }
+
+    service_uart();
+
+    if(service != NULL)
+    {
+        service();
+    }
+}
+
+/**
+    \brief fait avancer le temps jusqu'a chaque echeance en traitant celles-ci
+*/
+static void advance(uint32_t us)
+{
+    uint32_t target = time_micros() + us;
+    uint32_t next;
+
+    step();
+
+    while((int32_t)(target - time_micros()) > 0)
+    {
+        next = target;
+
+        if(wake_requested && (int32_t)(wake_at - next) < 0)
+        {
+            next = wake_at;
+        }
+
+        if(line_count > 0 && (int32_t)(line[line_head].at - next) < 0)
+        {
+            next = line[line_head].at;
+        }
+
+        if((int32_t)(next - time_micros()) > 0)
+        {
+            time_stub_advance(next - time_micros());
+        }
+
+        step();
+    }
+}
+
+static void access_hook(void)
+{
+    if(!advancing)
+    {
+        advancing = TRUE;
+        advance(MCU_SIM_ACCESS_US);
+        advancing = FALSE;
+    }
+}
+
+static void delay_hook(uint32_t us)
+{
+    if(!advancing)
+    {
+        advancing = TRUE;
+        advance(us);
+        advancing = FALSE;
+    }
+}
+
+/**
+    \brief ADC: la conversion se termine des qu'elle est demarree
+*/
+static void observer(hal_reg8_enum reg, uint8_t old_value, uint8_t new_value)
+{
+    eeprom_sim_observe(reg, old_value, new_value);
+
+    if(reg == HAL_ADCSRA && read_bit(new_value, ADSC))
+    {
+        hal_host_poke8(HAL_ADCH, adc_values[hal_host_peek8(HAL_ADMUX) & 0x07]);
+        hal_host_poke8(HAL_ADCSRA, clear_bit(new_value, ADSC));
+    }
+}
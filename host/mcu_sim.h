@@ -0,0 +1,128 @@
+#ifndef MCU_SIM_H_INCLUDED
+#define MCU_SIM_H_INCLUDED
+
+/**
+	\file mcu_sim.h
+	\brief execute un firmware sur PC avec le temps, les interruptions et le UART simules
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Le firmware (aero.c) est compile sans changement avec la HAL de PC, son
+    main() renomme firmware_main. mcu_sim_run l'execute jusqu'a ce que mcu_sim_stop soit appele.
+
+    - Le temps (time_micros, host/time_stub.c) avance de MCU_SIM_ACCESS_US a chaque acces a un
+      registre, environ 16 cycles de code par acces (ce que donne la boucle principale de
+      l'aeroglisseur au repos), et de la duree demandee a chaque _delay_ms/_delay_us. Le timer 1
+      et les callbacks de periode (failsafe) suivent ce temps.
+    - Les bytes donnes a mcu_sim_receive arrivent dans UDR a l'heure demandee. L'interruption RX
+      s'execute entre deux acces aux registres quand RXCIE et le bit I de SREG le permettent; un
+      byte qui arrive pendant qu'un autre attend encore l'ecrase, comme sur l'ATmega32.
+    - L'interruption UDRE s'execute au plus une fois par MCU_SIM_BYTE_US (9600 bauds) quand UDRIE
+      est actif, chaque byte transmis est donne au callback de mcu_sim_set_transmit.
+    - L'ADC termine chaque conversion des qu'elle est demarree avec la valeur de
+      mcu_sim_set_adc (batterie pleine par defaut).
+
+    Le simulateur appelle le callback de mcu_sim_set_service a chaque avance du temps, au moins a
+    chaque acces a un registre. Le callback demande avec mcu_sim_wake_at l'heure de sa prochaine
+    echeance, sinon il n'est rappele qu'au prochain acces. Une boucle qui attend une interruption
+    sans acceder aux registres doit appeler hal_spin() (voir hal.h), sinon elle bloque la
+    simulation.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stdint.h>
+
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief temps de code compte pour chaque acces a un registre
+*/
+#define MCU_SIM_ACCESS_US 2UL
+
+/**
+    \brief duree d'un byte a 9600 bauds (start, 8 bits, stop)
+*/
+#define MCU_SIM_BYTE_US 1042UL
+
+/**
+    \brief nombre de bytes qui peuvent attendre sur la ligne RX
+*/
+#define MCU_SIM_LINE_LENGTH 1024
+
+/**
+    \brief appele a chaque avance du temps
+*/
+typedef void (*mcu_sim_service_t)(void);
+
+/**
+    \brief appele pour chaque byte transmis par le firmware
+*/
+typedef void (*mcu_sim_transmit_t)(uint8_t byte);
+
+// main() du firmware, renomme a la compilation
+int firmware_main(int argc, char** argv);
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief remet les registres, le temps et la ligne a 0 et installe les hooks de la HAL
+    \return void
+*/
+void mcu_sim_init(void);
+
+/**
+    \brief execute le firmware jusqu'a mcu_sim_stop
+    \return void
+*/
+void mcu_sim_run(void);
+
+/**
+    \brief arrete le firmware, mcu_sim_run retourne
+    \return void
+
+    doit etre appele depuis le callback de service
+*/
+void mcu_sim_stop(void);
+
+void mcu_sim_set_service(mcu_sim_service_t service);
+void mcu_sim_set_transmit(mcu_sim_transmit_t transmit);
+
+/**
+    \brief demande un appel du callback de service a cette heure (time_micros)
+    \return void
+
+    la demande la plus proche est gardee, elle est oubliee quand elle est atteinte
+*/
+void mcu_sim_wake_at(uint32_t at);
+
+/**
+    \brief met un byte sur la ligne RX
+    \param[in] at l'heure ou le byte est completement recu, jamais avant celle du byte precedent
+    \param[in] byte le byte
+    \return FALSE si la ligne est pleine, le byte est alors perdu
+*/
+bool mcu_sim_receive(uint32_t at, uint8_t byte);
+
+/**
+    \brief heure a laquelle la ligne RX a fini de recevoir les bytes deja places
+*/
+uint32_t mcu_sim_get_line_free_at(void);
+
+/**
+    \brief valeur lue par adc_read sur un canal
+*/
+void mcu_sim_set_adc(uint8_t channel, uint8_t value);
+
+/**
+    \brief nombre de bytes ecrases dans UDR avant d'etre lus par l'interruption RX
+*/
+uint32_t mcu_sim_get_overruns(void);
+
+#endif
@@ -0,0 +1,99 @@
+/**
+	\file time_stub.c
+	\brief remplace time.c pour les tests sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "time_stub.h"
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static uint32_t current_micros;
+
+// temps ecoule depuis la derniere fin de periode
+static uint32_t period_micros;
+
+static time_tick_callback_t tick_callbacks[TIME_NB_TICK_CALLBACKS];
+static uint8_t nb_tick_callbacks;
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void time_init(void)
+{
+    current_micros = 0;
+    period_micros = 0;
+}
+
+uint32_t time_micros(void)
+{
+    return current_micros;
+}
+
+uint32_t time_millis(void)
+{
+    return current_micros / 1000UL;
+}
+
+uint16_t time_micros16(void)
+{
+    return (uint16_t)current_micros;
+}
+
+bool time_add_tick_callback(time_tick_callback_t callback)
+{
+    bool added = FALSE;
+
+    if(nb_tick_callbacks < TIME_NB_TICK_CALLBACKS)
+    {
+        tick_callbacks[nb_tick_callbacks] = callback;
+        nb_tick_callbacks++;
+        added = TRUE;
+    }
+
+    return added;
+}
+
+void time_stub_advance(uint32_t us)
+{
+    uint8_t i;
+    uint32_t step;
+
+    while(us > 0)
+    {
+        // avance jusqu'a la prochaine fin de periode au maximum
+        step = TIME_PERIOD_US - period_micros;
+
+        if(step > us)
+        {
+            step = us;
+        }
+
+        current_micros += step;
+        period_micros += step;
+        us -= step;
+
+        if(period_micros >= TIME_PERIOD_US)
+        {
+            period_micros = 0;
+
+            for(i = 0; i < nb_tick_callbacks; i++)
+            {
+                tick_callbacks[i]();
+            }
+        }
+    }
+}
+
+void time_stub_reset(void)
+{
+    current_micros = 0;
+    period_micros = 0;
+    nb_tick_callbacks = 0;
+}
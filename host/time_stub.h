@@ -0,0 +1,37 @@
+#ifndef TIME_STUB_H_INCLUDED
+#define TIME_STUB_H_INCLUDED
+
+/**
+	\file time_stub.h
+	\brief remplace time.c pour les tests sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Le temps n'avance que lorsque le test appelle time_stub_advance, ce qui rend les tests
+    deterministes. Les callbacks enregistres avec time_add_tick_callback sont appeles a chaque
+    fin de periode franchie, comme le ferait l'interruption du timer 1.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "time.h"
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief fait avancer le temps et appelle les callbacks des periodes franchies
+    \param[in] us le nombre de microsecondes a ajouter
+    \return void
+*/
+void time_stub_advance(uint32_t us);
+
+/**
+    \brief remet le temps a 0 et oublie les callbacks enregistres
+    \return void
+*/
+void time_stub_reset(void);
+
+#endif
@@ -0,0 +1,106 @@
+/**
+	\file trace_decode.c
+	\brief transforme une capture des trames de trace de l'aeroglisseur en ligne du temps
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: trace_decode [fichier]
+
+    Lit les bytes recus de l'aeroglisseur (fichier ou entree standard), garde seulement les trames
+    FRAME_TYPE_TRACE_RECORD et affiche une ligne par evenement avec le temps depuis le premier
+    evenement et le temps depuis l'evenement precedent, en microsecondes.
+
+    Les timestamps de 16 bits reviennent a 0 aux 524 ms, deux evenements consecutifs separes par
+    plus de temps que ca seront donc affiches trop rapproches.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stdio.h>
+
+#include "utils.h"
+#include "frame.h"
+#include "trace.h"
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static const char* event_names[TRACE_NB_EVENTS] = {
+    "?",
+    "FRAME_START",
+    "FRAME_END",
+    "SERVO_UPDATE",
+    "LCD_FLUSH",
+    "ISR_RX",
+    "ISR_UDRE",
+    "ISR_TICK",
+    "FAILSAFE",
+    "LAUNCH",
+    "RAMP",
+    "FRAME_RX",
+    "FRAME_TX"
+};
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    FILE* input = stdin;
+    frame_decoder_t decoder;
+    frame_t frame;
+    int byte;
+
+    uint8_t event;
+    uint16_t timestamp;
+    uint16_t previous = 0;
+    uint32_t delta;
+    uint32_t elapsed = 0;
+    uint32_t nb_records = 0;
+
+    if(argc > 1)
+    {
+        input = fopen(argv[1], "rb");
+
+        if(input == NULL)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    frame_decoder_init(&decoder);
+
+    printf("%10s %10s  %-14s %s\n", "t (us)", "dt (us)", "event", "arg");
+
+    while((byte = fgetc(input)) != EOF)
+    {
+        if(frame_decoder_push(&decoder, (uint8_t)byte, &frame) == TRUE &&
+           frame.data[0] == FRAME_TYPE_TRACE_RECORD && frame.length >= 5)
+        {
+            event = frame.data[1];
+            timestamp = frame.data[3] | (frame.data[4] << 8);
+
+            // la soustraction sur 16 bits absorbe le retour a 0 du timestamp
+            delta = (nb_records == 0) ? 0 : (uint16_t)(timestamp - previous);
+            delta <<= TRACE_TIMESTAMP_SHIFT;
+            elapsed += delta;
+            previous = timestamp;
+            nb_records++;
+
+            printf("%10u %10u  %-14s %u\n", (unsigned)elapsed, (unsigned)delta,
+                   (event < TRACE_NB_EVENTS) ? event_names[event] : "?", frame.data[2]);
+        }
+    }
+
+    if(input != stdin)
+    {
+        fclose(input);
+    }
+
+    fprintf(stderr, "%u events\n", (unsigned)nb_records);
+
+    return 0;
+}
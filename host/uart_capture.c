@@ -0,0 +1,220 @@
+/**
+	\file uart_capture.c
+	\brief capture les bytes d'une ligne serie avec leur heure, sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: uart_capture [-b bauds] peripherique fichier
+
+        -b bauds    vitesse de la ligne (9600 par defaut)
+
+    Le RX d'un adaptateur USB-serie est branche sur le TX du module wifi de l'aeroglisseur (la
+    broche RX du microcontroleur) avec la masse commune: le programme capture exactement ce que
+    recoit le firmware, dans le format de host/capture.h, jusqu'a Ctrl-C.
+
+    L'adaptateur regroupe les bytes et les donne au PC par paquets: les bytes d'une meme lecture
+    sont dates a reculons a partir de l'heure de la lecture, un byte par duree de byte, sans
+    jamais passer avant le byte precedent. La precision est celle de la latence de l'adaptateur
+    (1 a 16 ms selon le pilote, voir /sys/bus/usb-serial/devices/.../latency_timer).
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+
+#include "host/capture.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define READ_LENGTH 256
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static volatile sig_atomic_t running = 1;
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static uint64_t now_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+static void stop(int signal)
+{
+    running = 0;
+}
+
+static speed_t baud_constant(long baud)
+{
+    switch(baud)
+    {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        default: return B0;
+    }
+}
+
+/**
+    \brief ouvre la ligne en mode brut, 8N1
+    \return le descripteur, ou -1
+*/
+static int open_line(const char* path, speed_t speed)
+{
+    struct termios settings;
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+
+    if(fd < 0)
+    {
+        perror(path);
+
+        return -1;
+    }
+
+    if(tcgetattr(fd, &settings) != 0)
+    {
+        perror(path);
+        close(fd);
+
+        return -1;
+    }
+
+    cfmakeraw(&settings);
+    cfsetispeed(&settings, speed);
+    cfsetospeed(&settings, speed);
+    settings.c_cflag |= CLOCAL | CREAD;
+    settings.c_cflag &= ~(CSTOPB | PARENB);
+    settings.c_cc[VMIN] = 1;
+    settings.c_cc[VTIME] = 0;
+
+    if(tcsetattr(fd, TCSANOW, &settings) != 0)
+    {
+        perror(path);
+        close(fd);
+
+        return -1;
+    }
+
+    tcflush(fd, TCIFLUSH);
+
+    return fd;
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    uint8_t buffer[READ_LENGTH];
+    capture_t capture;
+    struct sigaction action = {0};
+    long baud = 9600;
+    uint64_t byte_us;
+    uint64_t start;
+    uint64_t at;
+    uint64_t last = 0;
+    uint64_t nb_bytes = 0;
+    ssize_t length;
+    ssize_t i;
+    int option;
+    int fd;
+
+    while((option = getopt(argc, argv, "b:")) != -1)
+    {
+        switch(option)
+        {
+            case 'b': baud = atol(optarg); break;
+
+            default:
+                fprintf(stderr, "usage: %s [-b bauds] peripherique fichier\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if(optind + 2 != argc || baud_constant(baud) == B0)
+    {
+        fprintf(stderr, "usage: %s [-b bauds] peripherique fichier\n", argv[0]);
+        return 2;
+    }
+
+    // start, 8 bits, stop
+    byte_us = (10ULL * 1000000ULL + baud / 2) / baud;
+
+    fd = open_line(argv[optind], baud_constant(baud));
+
+    if(fd < 0)
+    {
+        return 1;
+    }
+
+    if(capture_create(&capture, argv[optind + 1]) != 0)
+    {
+        perror(argv[optind + 1]);
+        close(fd);
+
+        return 1;
+    }
+
+    // sans SA_RESTART, Ctrl-C interrompt le read
+    action.sa_handler = stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    start = now_us();
+    fprintf(stderr, "capture de %s a %ld bauds dans %s, Ctrl-C pour terminer\n",
+            argv[optind], baud, argv[optind + 1]);
+
+    while(running)
+    {
+        length = read(fd, buffer, sizeof(buffer));
+
+        if(length <= 0)
+        {
+            continue;
+        }
+
+        at = now_us() - start;
+
+        for(i = 0; i < length; i++)
+        {
+            uint64_t back = (uint64_t)(length - 1 - i) * byte_us;
+            uint64_t byte_at = (at > back) ? at - back : 0;
+
+            if(nb_bytes > 0 && byte_at < last + byte_us)
+            {
+                byte_at = last + byte_us;
+            }
+
+            capture_write(&capture, byte_at, buffer[i]);
+            last = byte_at;
+            nb_bytes++;
+        }
+
+        fflush(capture.file);
+    }
+
+    capture_close(&capture);
+    close(fd);
+
+    fprintf(stderr, "%llu bytes en %.3f s\n", (unsigned long long)nb_bytes, last / 1e6);
+
+    return 0;
+}
@@ -0,0 +1,516 @@
+/**
+	\file uart_replay.c
+	\brief rejoue une capture UART dans le vrai firmware et verifie ses sorties, sur PC
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: make replay_check, ou
+        host/uart_replay_race [options] capture.ucap
+        host/uart_replay_drag [options] capture.ucap
+
+        -x facteur   accelere la capture, les delais entre les bytes sont divises par le facteur
+                     (1 par defaut); les bytes ne se suivent jamais plus vite que 9600 bauds
+        -d ms        temps simule apres le dernier byte (1000 par defaut)
+        -o fichier   trace des sorties, une ligne a chaque changement
+        -e fichier   trace attendue, meme format que -o: le programme echoue si les sorties
+                     different, ou si un changement arrive a plus de -T us de l'heure attendue
+        -T us        tolerance sur l'heure des changements (2000 par defaut)
+        -t us        echoue si le 99e percentile du decodage (DECODE) depasse cette duree
+
+    Le firmware (aero.c avec le profil race ou drag, main() renomme firmware_main) est execute par
+    host/mcu_sim.c. Chaque byte de la capture (host/capture.h) arrive dans UDR a son heure, le
+    debut de la capture etant le demarrage du firmware; l'interruption RX, les fifos, le decodeur
+    de trames et la boucle principale sont ceux du firmware.
+
+    Trace des sorties (-o, -e), une ligne par changement de OCR2 (poussee), OCR0 (sustentation,
+    0 quand le comparateur est coupe) ou OCR1A (servo, en us), lues a chaque acces aux registres:
+
+        # temps_us poussee sustentation servo
+        2512346 200 220 1580
+
+    Les trames de statut renvoyees par le firmware donnent les durees qu'il mesure lui-meme
+    (voir latency.h): reception (UART_RX), decodage (DECODE), application (APPLY) et reponse
+    (TOTAL, du premier byte recu a la reponse remise au UART). Le programme en affiche le
+    median, le 99e percentile et le maximum.
+
+    Avec -x, la trace attendue doit etre celle d'un rejeu au meme facteur: les heures changent.
+
+    Les captures de host/corpus/uart sont produites par le simulateur, pas par l'aeroglisseur:
+
+        host/hover_sim_race -d 10 -C host/corpus/uart/ovale_10s.ucap
+        host/hover_sim_race -d 5 -p 20 -j 30 -r 7 -C host/corpus/uart/pertes_gigue.ucap
+
+    make replay_check les rejoue dans les deux firmwares et compare les sorties aux traces
+    .race.txt et .drag.txt; make replay_update regenere ces traces apres un changement voulu.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hal.h"
+#include "utils.h"
+#include "frame.h"
+#include "host/capture.h"
+#include "host/mcu_sim.h"
+#include "host/time_stub.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief durees lues dans les trames de statut
+*/
+typedef enum
+{
+    STAGE_UART_RX,
+    STAGE_DECODE,
+    STAGE_APPLY,
+    STAGE_TOTAL,
+    NB_STAGES
+}stage_enum;
+
+/**
+    \brief etat des sorties du microcontroleur
+*/
+typedef struct
+{
+    uint32_t at;
+    uint8_t thrust;
+    uint8_t lift;
+    uint16_t servo;
+}outputs_t;
+
+/**
+    \brief tableau qui grandit au besoin
+*/
+typedef struct
+{
+    void* data;
+    size_t length;
+    size_t capacity;
+    size_t size;
+}array_t;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static const char* stage_names[NB_STAGES] = {"UART_RX", "DECODE", "APPLY", "TOTAL"};
+
+// options
+static double speed = 1.0;
+static uint32_t tail_us = 1000000;
+static uint32_t tolerance_us = 2000;
+static long decode_limit_us = -1;
+
+// capture
+static capture_t capture;
+static bool byte_waiting;
+static uint32_t byte_at;
+static uint8_t byte;
+static bool capture_done;
+static uint32_t last_at;
+static uint32_t end_time;
+static uint32_t nb_bytes;
+static uint32_t nb_commands;
+static frame_decoder_t command_decoder;
+static frame_t command;
+
+// sorties du firmware
+static array_t trace = {NULL, 0, 0, sizeof(outputs_t)};
+static frame_decoder_t status_decoder;
+static frame_t status;
+static array_t durations[NB_STAGES];
+static uint32_t nb_status;
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static void* array_add(array_t* array)
+{
+    if(array->length == array->capacity)
+    {
+        array->capacity = array->capacity ? array->capacity * 2 : 256;
+        array->data = realloc(array->data, array->capacity * array->size);
+
+        if(array->data == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+    }
+
+    return (char*)array->data + array->size * array->length++;
+}
+
+static void read_outputs(outputs_t* outputs)
+{
+    // un duty de 0 coupe le comparateur, la sortie reste a 0
+    outputs->at = time_micros();
+    outputs->thrust = read_bit(hal_host_peek8(HAL_TCCR2), COM21) ? hal_host_peek8(HAL_OCR2) : 0;
+    outputs->lift = read_bit(hal_host_peek8(HAL_TCCR0), COM01) ? hal_host_peek8(HAL_OCR0) : 0;
+    outputs->servo = hal_host_peek16(HAL_OCR1A);
+}
+
+static bool same_outputs(const outputs_t* a, const outputs_t* b)
+{
+    return a->thrust == b->thrust && a->lift == b->lift && a->servo == b->servo;
+}
+
+/**
+    \brief lit le prochain byte de la capture et calcule son heure de replay
+*/
+static void next_byte(void)
+{
+    uint64_t us;
+    uint64_t at;
+
+    if(capture_read(&capture, &us, &byte) == 0)
+    {
+        byte_waiting = FALSE;
+        capture_done = TRUE;
+        end_time = last_at + tail_us;
+        mcu_sim_wake_at(end_time);
+
+        return;
+    }
+
+    at = (uint64_t)(us / speed);
+
+    // la ligne est a 9600 bauds, meme si la capture est acceleree
+    if(nb_bytes > 0 && at < (uint64_t)last_at + MCU_SIM_BYTE_US)
+    {
+        at = (uint64_t)last_at + MCU_SIM_BYTE_US;
+    }
+
+    byte_at = (uint32_t)at;
+    byte_waiting = TRUE;
+}
+
+/**
+    \brief garde la ligne du simulateur remplie et note les changements des sorties
+*/
+static void service(void)
+{
+    outputs_t outputs;
+    outputs_t* last;
+
+    while(byte_waiting && mcu_sim_receive(byte_at, byte))
+    {
+        if(frame_decoder_push(&command_decoder, byte, &command) == TRUE &&
+           command.data[0] == FRAME_TYPE_COMMAND)
+        {
+            nb_commands++;
+        }
+
+        last_at = byte_at;
+        nb_bytes++;
+        next_byte();
+    }
+
+    read_outputs(&outputs);
+    last = trace.length ? (outputs_t*)trace.data + trace.length - 1 : NULL;
+
+    if(last == NULL || !same_outputs(last, &outputs))
+    {
+        *(outputs_t*)array_add(&trace) = outputs;
+    }
+
+    if(capture_done && (int32_t)(time_micros() - end_time) >= 0)
+    {
+        mcu_sim_stop();
+    }
+}
+
+static uint16_t get_duration(const uint8_t* data)
+{
+    return data[0] | ((uint16_t)data[1] << 8);
+}
+
+/**
+    \brief la manette recoit les trames de statut, les reponses AT sont ignorees
+*/
+static void receive_status(uint8_t transmitted)
+{
+    uint8_t i;
+
+    if(frame_decoder_push(&status_decoder, transmitted, &status) == TRUE &&
+       status.data[0] == FRAME_TYPE_STATUS && status.length >= 12)
+    {
+        nb_status++;
+
+        for(i = 0; i < NB_STAGES; i++)
+        {
+            *(uint16_t*)array_add(&durations[i]) = get_duration((uint8_t*)&status.data[4 + 2 * i]);
+        }
+    }
+}
+
+static int compare_durations(const void* a, const void* b)
+{
+    return (int)*(const uint16_t*)a - (int)*(const uint16_t*)b;
+}
+
+static uint16_t percentile(const array_t* array, double fraction)
+{
+    size_t index = (size_t)(fraction * (array->length - 1) + 0.5);
+
+    return ((const uint16_t*)array->data)[index];
+}
+
+static bool write_trace(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    const outputs_t* outputs = trace.data;
+    size_t i;
+
+    if(file == NULL)
+    {
+        perror(path);
+
+        return FALSE;
+    }
+
+    fprintf(file, "# temps_us poussee sustentation servo\n");
+
+    for(i = 0; i < trace.length; i++)
+    {
+        fprintf(file, "%u %u %u %u\n", outputs[i].at, outputs[i].thrust, outputs[i].lift, outputs[i].servo);
+    }
+
+    fclose(file);
+
+    return TRUE;
+}
+
+/**
+    \brief compare la trace a la trace attendue
+    \return le nombre de differences, ou -1 si le fichier ne peut pas etre lu
+*/
+static int check_trace(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    const outputs_t* outputs = trace.data;
+    char text[128];
+    unsigned int at;
+    unsigned int thrust;
+    unsigned int lift;
+    unsigned int servo;
+    size_t i = 0;
+    int nb_errors = 0;
+
+    if(file == NULL)
+    {
+        perror(path);
+
+        return -1;
+    }
+
+    while(fgets(text, sizeof(text), file) != NULL)
+    {
+        if(text[0] == '#' || text[0] == '\n')
+        {
+            continue;
+        }
+
+        if(sscanf(text, "%u %u %u %u", &at, &thrust, &lift, &servo) != 4)
+        {
+            fprintf(stderr, "%s: ligne invalide: %s", path, text);
+            fclose(file);
+
+            return -1;
+        }
+
+        if(i >= trace.length)
+        {
+            if(nb_errors++ == 0)
+            {
+                printf("ECHEC: attendu %u %u %u %u, la trace est terminee\n", at, thrust, lift, servo);
+            }
+        }
+        else if(outputs[i].thrust != thrust || outputs[i].lift != lift || outputs[i].servo != servo ||
+                labs((long)outputs[i].at - (long)at) > (long)tolerance_us)
+        {
+            if(nb_errors++ == 0)
+            {
+                printf("ECHEC: changement %zu, attendu %u %u %u %u, obtenu %u %u %u %u\n", i + 1,
+                       at, thrust, lift, servo,
+                       outputs[i].at, outputs[i].thrust, outputs[i].lift, outputs[i].servo);
+            }
+        }
+
+        i++;
+    }
+
+    fclose(file);
+
+    if(i < trace.length)
+    {
+        if(nb_errors == 0)
+        {
+            printf("ECHEC: changement %zu en trop: %u %u %u %u\n", i + 1, outputs[i].at,
+                   outputs[i].thrust, outputs[i].lift, outputs[i].servo);
+        }
+
+        nb_errors += trace.length - i;
+    }
+
+    return nb_errors;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-x facteur] [-d ms] [-o fichier] [-e fichier] [-T us] [-t us] capture.ucap\n", name);
+    exit(2);
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    const char* output_path = NULL;
+    const char* expected_path = NULL;
+    const char* capture_path = NULL;
+    struct timespec start;
+    struct timespec stop;
+    double real_time;
+    bool failed = FALSE;
+    int nb_errors;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if(argv[i][0] != '-')
+        {
+            if(capture_path != NULL)
+            {
+                usage(argv[0]);
+            }
+
+            capture_path = argv[i];
+            continue;
+        }
+
+        if(argv[i][1] == '\0' || argv[i][2] != '\0' || value == NULL)
+        {
+            usage(argv[0]);
+        }
+
+        switch(argv[i][1])
+        {
+            case 'x': speed = atof(value); break;
+            case 'd': tail_us = atof(value) * 1000.0; break;
+            case 'o': output_path = value; break;
+            case 'e': expected_path = value; break;
+            case 'T': tolerance_us = strtoul(value, NULL, 0); break;
+            case 't': decode_limit_us = strtol(value, NULL, 0); break;
+
+            default:
+                usage(argv[0]);
+        }
+
+        i++;
+    }
+
+    if(capture_path == NULL || speed <= 0)
+    {
+        usage(argv[0]);
+    }
+
+    if(capture_open(&capture, capture_path) != 0)
+    {
+        fprintf(stderr, "%s: capture illisible\n", capture_path);
+        return 1;
+    }
+
+    for(i = 0; i < NB_STAGES; i++)
+    {
+        durations[i].size = sizeof(uint16_t);
+    }
+
+    mcu_sim_init();
+    frame_decoder_init(&command_decoder);
+    frame_decoder_init(&status_decoder);
+    mcu_sim_set_service(service);
+    mcu_sim_set_transmit(receive_status);
+    next_byte();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // le firmware ne retourne jamais, service() l'arrete apres le dernier byte
+    mcu_sim_run();
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    real_time = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) * 1e-9;
+    capture_close(&capture);
+
+    printf("capture %s, facteur %g\n", capture_path, speed);
+    printf("bytes rejoues          %8u (%u commandes), %u ecrases (UART)\n", nb_bytes, nb_commands,
+           mcu_sim_get_overruns());
+    printf("changements des sorties %7zu\n", trace.length);
+    printf("statuts recus          %8u\n", nb_status);
+
+    if(nb_status > 0)
+    {
+        printf("%-8s %10s %10s %10s\n", "etape", "p50 (us)", "p99 (us)", "max (us)");
+
+        for(i = 0; i < NB_STAGES; i++)
+        {
+            qsort(durations[i].data, durations[i].length, sizeof(uint16_t), compare_durations);
+            printf("%-8s %10u %10u %10u\n", stage_names[i], percentile(&durations[i], 0.5),
+                   percentile(&durations[i], 0.99), percentile(&durations[i], 1.0));
+        }
+    }
+
+    printf("temps simule           %8.3f s en %.3f s\n", time_micros() / 1e6, real_time);
+
+    if(output_path != NULL && !write_trace(output_path))
+    {
+        return 1;
+    }
+
+    if(expected_path != NULL)
+    {
+        nb_errors = check_trace(expected_path);
+
+        if(nb_errors < 0)
+        {
+            return 1;
+        }
+
+        if(nb_errors > 0)
+        {
+            printf("sorties: %d differences avec %s\n", nb_errors, expected_path);
+            failed = TRUE;
+        }
+        else
+        {
+            printf("sorties: identiques a %s (tolerance %u us)\n", expected_path, tolerance_us);
+        }
+    }
+
+    if(decode_limit_us >= 0)
+    {
+        if(nb_status == 0)
+        {
+            printf("ECHEC: aucun statut recu, le decodage n'est pas mesure\n");
+            failed = TRUE;
+        }
+        else if(percentile(&durations[STAGE_DECODE], 0.99) > decode_limit_us)
+        {
+            printf("ECHEC: DECODE p99 %u us > %ld us\n", percentile(&durations[STAGE_DECODE], 0.99),
+                   decode_limit_us);
+            failed = TRUE;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+/**
+	\file udp_launch.c
+	\brief arme et declenche le depart du drag de l'aeroglisseur par UDP
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: udp_launch [-t adresse:port] [-n envois] arm courbe | go | abort
+
+        -t adresse:port  aeroglisseur (192.168.4.1:1337 par defaut, comme manette.c)
+        -n envois        nombre d'envois de la trame, contre les pertes du lien (3 par defaut)
+
+    Envoie une trame FRAME_TYPE_LAUNCH (voir launch.h). L'aeroglisseur doit etre en configuration
+    drag (host/udp_param profil=drag) et recevoir les commandes de la manette: "go" est refuse
+    tant que le failsafe n'est pas arme. Les envois en double sont sans effet: un "go" ne demarre
+    qu'une courbe armee et une courbe en cours ne peut pas etre rearmee. L'etat du depart est
+    affiche au LCD de l'aeroglisseur ("arme", "depart").
+
+    Par exemple, pour comparer les deux courbes de aero.c:
+
+        udp_launch arm 0 && udp_launch go
+        udp_launch arm 1 && udp_launch go
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "utils.h"
+#include "frame.h"
+#include "launch.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+// delai entre deux envois de la meme trame
+#define REPEAT_DELAY_US 20000
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static int parse_address(const char* text, struct sockaddr_in* address)
+{
+    char host[64];
+    const char* colon = strrchr(text, ':');
+
+    if(colon == NULL)
+    {
+        return 0;
+    }
+
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+    snprintf(host, sizeof(host), "%.*s", (int)(colon - text), text);
+    address->sin_port = htons(atoi(colon + 1));
+
+    return inet_pton(AF_INET, host, &address->sin_addr) == 1;
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-t adresse:port] [-n envois] arm courbe | go | abort\n", program);
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    struct sockaddr_in target;
+    uint8_t request[3];
+    uint8_t request_length = 2;
+    char encoded[FRAME_ENCODED_MAX_LENGTH];
+    uint8_t length;
+    int nb_sends = 3;
+    int option;
+    int fd;
+    int i;
+
+    parse_address("192.168.4.1:1337", &target);
+
+    while((option = getopt(argc, argv, "t:n:")) != -1)
+    {
+        switch(option)
+        {
+            case 'n': nb_sends = atoi(optarg); break;
+
+            case 't':
+                if(!parse_address(optarg, &target))
+                {
+                    usage(argv[0]);
+                    return 2;
+                }
+                break;
+
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    request[0] = FRAME_TYPE_LAUNCH;
+
+    if(optind + 2 == argc && strcmp(argv[optind], "arm") == 0)
+    {
+        request[1] = LAUNCH_ARM;
+        request[2] = (uint8_t)atoi(argv[optind + 1]);
+        request_length = 3;
+    }
+    else if(optind + 1 == argc && strcmp(argv[optind], "go") == 0)
+    {
+        request[1] = LAUNCH_GO;
+    }
+    else if(optind + 1 == argc && strcmp(argv[optind], "abort") == 0)
+    {
+        request[1] = LAUNCH_ABORT;
+    }
+    else
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if(fd < 0)
+    {
+        perror("socket");
+        return 1;
+    }
+
+    length = frame_encode(encoded, request, request_length);
+
+    for(i = 0; i < nb_sends; i++)
+    {
+        if(i > 0)
+        {
+            usleep(REPEAT_DELAY_US);
+        }
+
+        if(sendto(fd, encoded, length, 0, (struct sockaddr*)&target, sizeof(target)) != length)
+        {
+            perror("sendto");
+            close(fd);
+            return 1;
+        }
+    }
+
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,656 @@
+/**
+	\file udp_manette.c
+	\brief manette sur PC: envoie des commandes a l'aeroglisseur par UDP a une cadence choisie
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: udp_manette [options]
+
+        -t adresse:port  aeroglisseur (192.168.4.1:1337 par defaut, comme manette.c)
+        -l [adresse:]port port local (31337 par defaut, l'aeroglisseur repond a ce port)
+        -f hz            cadence des commandes, 1 a 1000 (20 par defaut)
+        -b debut:fin:pas balaie les cadences de debut a fin hz, -d secondes chacune
+        -d secondes      duree, ou duree de chaque cadence avec -b (10 par defaut)
+        -m mode          fixe, sinus, aleatoire (defaut) ou script
+        -s fichier       script pour -m script, une ligne "ms hor ver sus" par changement, la
+                         derniere ligne est gardee jusqu'a la fin
+        -v 0..255        poussee (ver) maximale des modes fixe, sinus et aleatoire (0 par defaut)
+        -u 0..255        sustentation (sus) des modes fixe, sinus et aleatoire (0 par defaut)
+        -o fichier       telemetrie en CSV, une ligne par trame de statut recue (la colonne
+                         rampe donne les moteurs limites par ramp.h: 1 sustentation, 2 poussee)
+        -r graine        graine du mode aleatoire
+
+    Chaque commande [K, hor, ver, sus, seq] est encodee par frame_encode et envoyee seule dans
+    un paquet, depuis le meme port que la vraie manette. Par defaut les moteurs restent coupes
+    (ver et sus a 0) et seul le gouvernail bouge: l'aeroglisseur decode et applique quand meme
+    chaque commande, ce qui suffit pour mesurer ce qu'il absorbe.
+
+    Les trames de statut renvoyees (voir FRAME_TYPE_STATUS) donnent, pour chaque cadence:
+
+    - statuts: trames de statut recues; l'aeroglisseur repond une fois par tour de boucle avec
+      la plus recente commande, plusieurs commandes peuvent donc partager une reponse;
+    - appliquees: numeros de sequence differents confirmes par l'aeroglisseur;
+    - debord.: debordements du fifo RX comptes par l'aeroglisseur pendant la cadence;
+    - coupures: coupures du failsafe pendant la cadence;
+    - rtt et TOTAL: aller-retour vu par ce programme et temps de traitement mesure par
+      l'aeroglisseur, median et 99e percentile.
+
+    Une cadence est soutenue si l'aeroglisseur repond, sans debordement ni coupure. Avec -b, le
+    programme affiche la plus grande cadence soutenue. A 9600 bauds, une commande de 9 bytes
+    encodes occupe la ligne pendant 9.4 ms: au-dela d'environ 100 hz, les bytes s'accumulent
+    dans le module wifi puis dans le fifo RX.
+
+    Avec host/esp_sim, l'aeroglisseur ecoute sur 127.0.0.1:1337:
+
+        udp_manette -t 127.0.0.1:1337 -b 10:200:10 -d 5
+
+    Ctrl-C termine la cadence en cours et affiche le resultat.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "utils.h"
+#include "frame.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define PACKET_MAX_LENGTH 2048
+#define MAX_RATE 1000
+#define MAX_SCRIPT_LINES 4096
+
+/**
+    \brief periode du gouvernail en mode sinus
+*/
+#define SINE_PERIOD_S 2.0
+
+typedef enum
+{
+    FIXED_MODE,
+    SINE_MODE,
+    RANDOM_MODE,
+    SCRIPT_MODE
+}stick_mode_enum;
+
+/**
+    \brief une ligne du script
+*/
+typedef struct
+{
+    double at_ms;
+    uint8_t hor;
+    uint8_t ver;
+    uint8_t sus;
+}script_line_t;
+
+/**
+    \brief resultat d'une cadence
+*/
+typedef struct
+{
+    double rate;
+    double achieved;
+    uint64_t sent;
+    uint64_t statuses;
+    uint64_t applied;
+    uint32_t overflows;
+    uint32_t trips;
+    double* rtt_ms;
+    uint16_t* total_us;
+    size_t nb_samples;
+    size_t capacity;
+}step_t;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+// options
+static struct sockaddr_in target;
+static stick_mode_enum mode = RANDOM_MODE;
+static uint8_t max_thrust = 0;
+static uint8_t lift = 0;
+static FILE* output = NULL;
+
+static script_line_t script[MAX_SCRIPT_LINES];
+static size_t nb_script_lines = 0;
+
+static int fd = -1;
+static double start_ms;
+static uint8_t seq = 0;
+
+// heure d'envoi de chaque numero de sequence
+static double sent_ms[256];
+static uint8_t sent_valid[256];
+
+// dernier numero confirme et compteurs du dernier statut, pour les differences
+static int last_applied_seq = -1;
+static int last_overflows = -1;
+static int last_trips = -1;
+
+static frame_decoder_t decoder;
+
+static volatile sig_atomic_t running = 1;
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static double now_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
+
+static void stop(int signal)
+{
+    running = 0;
+}
+
+static int parse_address(const char* text, struct sockaddr_in* address, int address_required)
+{
+    char host[64] = "0.0.0.0";
+    const char* colon = strrchr(text, ':');
+
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+
+    if(colon != NULL)
+    {
+        snprintf(host, sizeof(host), "%.*s", (int)(colon - text), text);
+        text = colon + 1;
+    }
+    else if(address_required)
+    {
+        return 0;
+    }
+
+    address->sin_port = htons(atoi(text));
+
+    return inet_pton(AF_INET, host, &address->sin_addr) == 1;
+}
+
+static int load_script(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    char text[128];
+    double at_ms;
+    unsigned int hor;
+    unsigned int ver;
+    unsigned int sus;
+
+    if(file == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+
+    while(fgets(text, sizeof(text), file) != NULL && nb_script_lines < MAX_SCRIPT_LINES)
+    {
+        if(text[0] == '#' || text[0] == '\n')
+        {
+            continue;
+        }
+
+        if(sscanf(text, "%lf %u %u %u", &at_ms, &hor, &ver, &sus) != 4 || hor > 255 || ver > 255 || sus > 255)
+        {
+            fprintf(stderr, "%s: ligne invalide: %s", path, text);
+            fclose(file);
+            return 0;
+        }
+
+        script[nb_script_lines].at_ms = at_ms;
+        script[nb_script_lines].hor = hor;
+        script[nb_script_lines].ver = ver;
+        script[nb_script_lines].sus = sus;
+        nb_script_lines++;
+    }
+
+    fclose(file);
+
+    return nb_script_lines > 0;
+}
+
+/**
+    \brief position des manettes a cette heure depuis le debut
+*/
+static void sticks(double elapsed_ms, uint8_t* hor, uint8_t* ver, uint8_t* sus)
+{
+    size_t i;
+
+    *hor = 128;
+    *ver = max_thrust;
+    *sus = lift;
+
+    switch(mode)
+    {
+        case FIXED_MODE:
+            break;
+
+        case SINE_MODE:
+            *hor = (uint8_t)lround(127.5 + 127.5 * sin(2.0 * M_PI * elapsed_ms / (SINE_PERIOD_S * 1000.0)));
+            break;
+
+        case RANDOM_MODE:
+            *hor = rand() & 0xFF;
+            *ver = max_thrust ? rand() % (max_thrust + 1) : 0;
+            break;
+
+        case SCRIPT_MODE:
+            for(i = 0; i + 1 < nb_script_lines && script[i + 1].at_ms <= elapsed_ms; i++);
+
+            *hor = script[i].hor;
+            *ver = script[i].ver;
+            *sus = script[i].sus;
+            break;
+    }
+}
+
+static void send_command(double elapsed_ms, step_t* step)
+{
+    uint8_t command[5];
+    char encoded[FRAME_ENCODED_MAX_LENGTH];
+    uint8_t length;
+
+    command[0] = FRAME_TYPE_COMMAND;
+    sticks(elapsed_ms, &command[1], &command[2], &command[3]);
+    command[4] = seq;
+
+    length = frame_encode(encoded, command, sizeof(command));
+
+    sent_ms[seq] = now_ms();
+    sent_valid[seq] = 1;
+    seq++;
+
+    if(sendto(fd, encoded, length, 0, (struct sockaddr*)&target, sizeof(target)) == length)
+    {
+        step->sent++;
+    }
+}
+
+static uint16_t get_duration(const uint8_t* data)
+{
+    return data[0] | ((uint16_t)data[1] << 8);
+}
+
+static void add_sample(step_t* step, double rtt_ms, uint16_t total_us)
+{
+    if(step->nb_samples == step->capacity)
+    {
+        step->capacity = step->capacity ? step->capacity * 2 : 1024;
+        step->rtt_ms = realloc(step->rtt_ms, step->capacity * sizeof(double));
+        step->total_us = realloc(step->total_us, step->capacity * sizeof(uint16_t));
+
+        if(step->rtt_ms == NULL || step->total_us == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+    }
+
+    step->rtt_ms[step->nb_samples] = rtt_ms;
+    step->total_us[step->nb_samples] = total_us;
+    step->nb_samples++;
+}
+
+static void receive_status(const frame_t* status, double received_ms, step_t* step)
+{
+    uint8_t applied = status->data[3];
+    double rtt_ms = -1;
+    int overflows = (status->length >= 13) ? status->data[12] : -1;
+    int stack_used = (status->length >= 15) ? get_duration(&status->data[13]) : -1;
+    int ramp_saturation = (status->length >= 16) ? status->data[15] : -1;
+
+    step->statuses++;
+
+    if(applied != last_applied_seq)
+    {
+        step->applied++;
+        last_applied_seq = applied;
+    }
+
+    if(sent_valid[applied])
+    {
+        rtt_ms = received_ms - sent_ms[applied];
+        add_sample(step, rtt_ms, get_duration(&status->data[10]));
+    }
+
+    // les compteurs de l'aeroglisseur sont sur 8 bits
+    if(overflows >= 0 && last_overflows >= 0)
+    {
+        step->overflows += (uint8_t)(overflows - last_overflows);
+    }
+
+    if(last_trips >= 0)
+    {
+        step->trips += (uint8_t)(status->data[2] - last_trips);
+    }
+
+    last_overflows = overflows;
+    last_trips = status->data[2];
+
+    if(output != NULL)
+    {
+        fprintf(output, "%.3f,%u,%.3f,%u,%u,%u,%u,%u,%u,%d,%d,%d\n", received_ms - start_ms, applied, rtt_ms,
+                status->data[1], status->data[2], get_duration(&status->data[4]),
+                get_duration(&status->data[6]), get_duration(&status->data[8]),
+                get_duration(&status->data[10]), overflows, stack_used, ramp_saturation);
+    }
+}
+
+static void receive_packets(step_t* step)
+{
+    uint8_t packet[PACKET_MAX_LENGTH];
+    frame_t frame;
+    ssize_t length;
+    ssize_t i;
+    double received_ms;
+
+    while((length = recv(fd, packet, sizeof(packet), MSG_DONTWAIT)) > 0)
+    {
+        received_ms = now_ms();
+
+        for(i = 0; i < length; i++)
+        {
+            if(frame_decoder_push(&decoder, packet[i], &frame) == TRUE &&
+               frame.data[0] == FRAME_TYPE_STATUS && frame.length >= 12)
+            {
+                receive_status(&frame, received_ms, step);
+            }
+        }
+    }
+}
+
+/**
+    \brief envoie les commandes a une cadence pendant une duree et recoit les reponses
+*/
+static void run_step(step_t* step, double duration_s)
+{
+    struct pollfd poll_fd = {fd, POLLIN, 0};
+    struct timespec timeout;
+    double period_ms = 1000.0 / step->rate;
+    double step_start = now_ms();
+    double next = step_start;
+    double end = step_start + duration_s * 1000.0;
+    double wait;
+
+    while(running && now_ms() < end)
+    {
+        // une commande en retard part tout de suite, sans rattraper les suivantes
+        if(now_ms() >= next)
+        {
+            send_command(now_ms() - start_ms, step);
+            next += period_ms;
+
+            if(next < now_ms())
+            {
+                next = now_ms();
+            }
+        }
+
+        wait = fmin(next, end) - now_ms();
+
+        if(wait < 0)
+        {
+            wait = 0;
+        }
+
+        timeout.tv_sec = (time_t)(wait / 1000.0);
+        timeout.tv_nsec = (long)((wait - timeout.tv_sec * 1000.0) * 1e6);
+
+        if(ppoll(&poll_fd, 1, &timeout, NULL) > 0)
+        {
+            receive_packets(step);
+        }
+    }
+
+    step->achieved = step->sent * 1000.0 / (now_ms() - step_start);
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+static int compare_durations(const void* a, const void* b)
+{
+    return (int)*(const uint16_t*)a - (int)*(const uint16_t*)b;
+}
+
+static size_t percentile_index(size_t length, double fraction)
+{
+    return (size_t)(fraction * (length - 1) + 0.5);
+}
+
+static int is_sustained(const step_t* step)
+{
+    return step->statuses > 0 && step->overflows == 0 && step->trips == 0;
+}
+
+static void print_header(void)
+{
+    printf("%8s %8s %8s %8s %10s %7s %8s %9s %9s %9s %9s\n", "hz", "obtenu", "envoyees", "statuts",
+           "appliquees", "debord.", "coupures", "rtt p50", "rtt p99", "TOTAL p50", "TOTAL p99");
+}
+
+static void print_step(step_t* step)
+{
+    printf("%8.0f %8.1f %8llu %8llu %10llu %7u %8u", step->rate, step->achieved,
+           (unsigned long long)step->sent, (unsigned long long)step->statuses,
+           (unsigned long long)step->applied, step->overflows, step->trips);
+
+    if(step->nb_samples > 0)
+    {
+        qsort(step->rtt_ms, step->nb_samples, sizeof(double), compare_doubles);
+        qsort(step->total_us, step->nb_samples, sizeof(uint16_t), compare_durations);
+
+        printf(" %6.1f ms %6.1f ms %6u us %6u us",
+               step->rtt_ms[percentile_index(step->nb_samples, 0.5)],
+               step->rtt_ms[percentile_index(step->nb_samples, 0.99)],
+               step->total_us[percentile_index(step->nb_samples, 0.5)],
+               step->total_us[percentile_index(step->nb_samples, 0.99)]);
+    }
+
+    printf("%s\n", is_sustained(step) ? "" : "  non soutenue");
+    fflush(stdout);
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-t adresse:port] [-l [adresse:]port] [-f hz] [-b debut:fin:pas] [-d secondes]\n"
+                    "       [-m fixe|sinus|aleatoire|script] [-s fichier] [-v poussee] [-u sustentation]\n"
+                    "       [-o fichier] [-r graine]\n", program);
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    struct sockaddr_in local;
+    step_t step;
+    double first = 20;
+    double last = 20;
+    double increment = 1;
+    double rate;
+    double duration_s = 10;
+    double best = 0;
+    const char* script_path = NULL;
+    unsigned seed = time(NULL);
+    int failed = 0;
+    int option;
+
+    parse_address("192.168.4.1:1337", &target, 1);
+    parse_address("31337", &local, 0);
+
+    while((option = getopt(argc, argv, "t:l:f:b:d:m:s:v:u:o:r:")) != -1)
+    {
+        switch(option)
+        {
+            case 'd': duration_s = atof(optarg); break;
+            case 's': script_path = optarg; break;
+            case 'v': max_thrust = atoi(optarg); break;
+            case 'u': lift = atoi(optarg); break;
+            case 'r': seed = strtoul(optarg, NULL, 0); break;
+
+            case 't':
+                if(!parse_address(optarg, &target, 1))
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+
+            case 'l':
+                if(!parse_address(optarg, &local, 0))
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+
+            case 'f':
+                first = last = atof(optarg);
+                break;
+
+            case 'b':
+                if(sscanf(optarg, "%lf:%lf:%lf", &first, &last, &increment) != 3 || increment <= 0)
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+
+            case 'm':
+                if(strcmp(optarg, "fixe") == 0)
+                {
+                    mode = FIXED_MODE;
+                }
+                else if(strcmp(optarg, "sinus") == 0)
+                {
+                    mode = SINE_MODE;
+                }
+                else if(strcmp(optarg, "aleatoire") == 0)
+                {
+                    mode = RANDOM_MODE;
+                }
+                else if(strcmp(optarg, "script") == 0)
+                {
+                    mode = SCRIPT_MODE;
+                }
+                else
+                {
+                    fprintf(stderr, "mode inconnu: %s\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'o':
+                output = fopen(optarg, "w");
+                if(output == NULL)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                fprintf(output, "t_ms,seq,rtt_ms,batterie,coupures,uart_rx_us,decode_us,apply_us,total_us,debordements,pile,rampe\n");
+                break;
+
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(first < 1 || last > MAX_RATE || first > last || duration_s <= 0)
+    {
+        fprintf(stderr, "les cadences doivent etre entre 1 et %d hz\n", MAX_RATE);
+        return 1;
+    }
+
+    if(mode == SCRIPT_MODE && (script_path == NULL || !load_script(script_path)))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    srand(seed);
+    frame_decoder_init(&decoder);
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if(bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0)
+    {
+        perror("udp_manette: bind");
+        return 1;
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    start_ms = now_ms();
+    print_header();
+
+    for(rate = first; running && rate <= last + 1e-9; rate += increment)
+    {
+        memset(&step, 0, sizeof(step));
+        step.rate = rate;
+
+        run_step(&step, duration_s);
+        print_step(&step);
+
+        // la cadence maximale est celle qui precede le premier echec
+        if(is_sustained(&step) && !failed)
+        {
+            best = rate;
+        }
+        else
+        {
+            failed = 1;
+        }
+
+        free(step.rtt_ms);
+        free(step.total_us);
+    }
+
+    if(last > first)
+    {
+        if(best > 0)
+        {
+            printf("cadence soutenue maximale: %.0f hz\n", best);
+        }
+        else
+        {
+            printf("aucune cadence soutenue\n");
+        }
+    }
+
+    if(output != NULL)
+    {
+        fclose(output);
+    }
+
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,352 @@
+/**
+	\file udp_param.c
+	\brief lit et change les reglages de l'aeroglisseur par UDP, sans le reprogrammer
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: udp_param [-t adresse:port] [-l [adresse:]port] [-s] [-w ms] [cle[=valeur] ...]
+
+        -t adresse:port  aeroglisseur (192.168.4.1:1337 par defaut, comme manette.c)
+        -l [adresse:]port port local (31337 par defaut, l'aeroglisseur repond a ce port)
+        -s               sauvegarde les nouvelles valeurs dans l'EEPROM (PARAM_PERSIST)
+        -w ms            attente maximale de la reponse (1000 par defaut)
+
+    Sans cle, toutes les valeurs sont lues. Avec des "cle=valeur", elles sont changees ensemble
+    (voir param.h), sinon les cles donnees sont lues. Les cles sont les noms ci-dessous ou leur
+    numero dans config_value_enum:
+
+        centre, droite, gauche       servomoteur, en us
+        batterie_zero, batterie_plage echelle de la batterie (lectures de l'ADC)
+        osccal                       correction de l'oscillateur, -128 a 127
+        courbe                       courbe de la propulsion, 0 (lineaire) a 255 (cubique)
+        telemetrie                   une trame de statut toutes les N commandes
+        profil                       race ou drag (ou 0, 1), voir profile.h
+
+    Par exemple, pour passer au debattement de la configuration drag et le garder:
+
+        udp_param -s profil=drag
+
+    La reponse affiche une ligne "cle valeur" par reglage. Le programme retourne 0 si
+    l'aeroglisseur a accepte la trame, 1 sinon (aucune reponse, valeur refusee, ...).
+
+    L'aeroglisseur ne repond qu'une fois le ESP en mode transparent, apres sa premiere commande:
+    avant, la trame est appliquee mais la reponse attend (voir aero.c).
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "utils.h"
+#include "frame.h"
+#include "config.h"
+#include "param.h"
+#include "profile.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define PACKET_MAX_LENGTH 2048
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+// noms des cles, dans l'ordre de config_value_enum
+static const char* key_names[CONFIG_NB_VALUES] =
+{
+    "centre", "droite", "gauche", "batterie_zero", "batterie_plage", "osccal", "courbe", "telemetrie", "profil"
+};
+
+// noms des profils, dans l'ordre de profile_enum
+static const char* profile_names[PROFILE_NB] =
+{
+    "race", "drag"
+};
+
+static const char* result_names[] =
+{
+    "ok", "trame invalide", "cle inconnue", "valeur hors limites"
+};
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static double now_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
+
+static int parse_address(const char* text, struct sockaddr_in* address, int address_required)
+{
+    char host[64] = "0.0.0.0";
+    const char* colon = strrchr(text, ':');
+
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+
+    if(colon != NULL)
+    {
+        snprintf(host, sizeof(host), "%.*s", (int)(colon - text), text);
+        text = colon + 1;
+    }
+    else if(address_required)
+    {
+        return 0;
+    }
+
+    address->sin_port = htons(atoi(text));
+
+    return inet_pton(AF_INET, host, &address->sin_addr) == 1;
+}
+
+/**
+    \brief trouve une cle par son nom ou son numero
+    \return la cle, ou -1
+*/
+static int parse_key(const char* text, size_t length)
+{
+    char* end;
+    long key;
+    int i;
+
+    for(i = 0; i < CONFIG_NB_VALUES; i++)
+    {
+        if(strlen(key_names[i]) == length && strncmp(text, key_names[i], length) == 0)
+        {
+            return i;
+        }
+    }
+
+    key = strtol(text, &end, 0);
+
+    return (end == text + length && key >= 0 && key < CONFIG_NB_VALUES) ? (int)key : -1;
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-t adresse:port] [-l [adresse:]port] [-s] [-w ms] [cle[=valeur] ...]\n", program);
+}
+
+/**
+    \brief affiche les valeurs d'une reponse FRAME_TYPE_PARAM_VALUES
+*/
+static void print_values(const frame_t* reply)
+{
+    uint8_t i;
+    uint16_t value;
+
+    for(i = 2; i + 2 < reply->length; i += 3)
+    {
+        value = reply->data[i + 1] | ((uint16_t)reply->data[i + 2] << 8);
+
+        if(reply->data[i] == CONFIG_PROFILE && value < PROFILE_NB)
+        {
+            printf("%-15s %s\n", key_names[reply->data[i]], profile_names[value]);
+        }
+        // la correction de l'oscillateur est signee
+        else if(reply->data[i] == CONFIG_OSCCAL_OFFSET)
+        {
+            printf("%-15s %d\n", key_names[reply->data[i]], (int16_t)value);
+        }
+        else if(reply->data[i] < CONFIG_NB_VALUES)
+        {
+            printf("%-15s %u\n", key_names[reply->data[i]], value);
+        }
+    }
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    struct sockaddr_in target;
+    struct sockaddr_in local;
+    struct pollfd poller;
+    frame_decoder_t decoder;
+    frame_t reply;
+    uint8_t request[FRAME_MAX_LENGTH];
+    uint8_t request_length;
+    char encoded[FRAME_ENCODED_MAX_LENGTH];
+    uint8_t packet[PACKET_MAX_LENGTH];
+    uint8_t length;
+    uint8_t persist = 0;
+    int nb_sets = 0;
+    double timeout_ms = 1000;
+    double deadline;
+    ssize_t received;
+    ssize_t j;
+    long value;
+    char* equal;
+    char* end;
+    int option;
+    int key;
+    int fd;
+    int i;
+
+    parse_address("192.168.4.1:1337", &target, 1);
+    parse_address("31337", &local, 0);
+
+    while((option = getopt(argc, argv, "t:l:sw:")) != -1)
+    {
+        switch(option)
+        {
+            case 's': persist = PARAM_PERSIST; break;
+            case 'w': timeout_ms = atof(optarg); break;
+
+            case 't':
+                if(!parse_address(optarg, &target, 1))
+                {
+                    usage(argv[0]);
+                    return 2;
+                }
+                break;
+
+            case 'l':
+                if(!parse_address(optarg, &local, 0))
+                {
+                    usage(argv[0]);
+                    return 2;
+                }
+                break;
+
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    for(i = optind; i < argc; i++)
+    {
+        if(strchr(argv[i], '=') != NULL)
+        {
+            nb_sets++;
+        }
+    }
+
+    if((nb_sets > 0 && nb_sets != argc - optind) || argc - optind > PARAM_MAX_PAIRS)
+    {
+        fprintf(stderr, "toutes les cles doivent avoir une valeur, ou aucune (au plus %d)\n", PARAM_MAX_PAIRS);
+        return 2;
+    }
+
+    // construit la trame P ou Q
+    request[0] = (nb_sets > 0) ? FRAME_TYPE_PARAM_SET : FRAME_TYPE_PARAM_GET;
+    request_length = 1;
+
+    if(nb_sets > 0)
+    {
+        request[request_length++] = persist;
+    }
+
+    for(i = optind; i < argc; i++)
+    {
+        equal = strchr(argv[i], '=');
+        key = parse_key(argv[i], equal ? (size_t)(equal - argv[i]) : strlen(argv[i]));
+
+        if(key < 0)
+        {
+            fprintf(stderr, "cle inconnue: %s\n", argv[i]);
+            return 2;
+        }
+
+        request[request_length++] = (uint8_t)key;
+
+        if(equal != NULL)
+        {
+            value = strtol(equal + 1, &end, 0);
+
+            // un profil peut etre donne par son nom
+            for(j = 0; key == CONFIG_PROFILE && j < PROFILE_NB; j++)
+            {
+                if(strcmp(equal + 1, profile_names[j]) == 0)
+                {
+                    value = j;
+                    end = equal + 1 + strlen(profile_names[j]);
+                }
+            }
+
+            if(*end != '\0' || end == equal + 1 || value < -32768 || value > 65535)
+            {
+                fprintf(stderr, "valeur invalide: %s\n", argv[i]);
+                return 2;
+            }
+
+            request[request_length++] = (uint8_t)(value & 0xFF);
+            request[request_length++] = (uint8_t)((value >> 8) & 0xFF);
+        }
+    }
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if(fd < 0 || bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0)
+    {
+        perror("socket");
+        return 1;
+    }
+
+    length = frame_encode(encoded, request, request_length);
+
+    if(sendto(fd, encoded, length, 0, (struct sockaddr*)&target, sizeof(target)) != length)
+    {
+        perror("sendto");
+        close(fd);
+        return 1;
+    }
+
+    // attend la reponse, les trames de statut et de trace sont ignorees
+    frame_decoder_init(&decoder);
+    deadline = now_ms() + timeout_ms;
+    poller.fd = fd;
+    poller.events = POLLIN;
+
+    while(now_ms() < deadline)
+    {
+        if(poll(&poller, 1, (int)(deadline - now_ms()) + 1) <= 0)
+        {
+            continue;
+        }
+
+        received = recv(fd, packet, sizeof(packet), 0);
+
+        for(j = 0; j < received; j++)
+        {
+            if(frame_decoder_push(&decoder, packet[j], &reply) == TRUE &&
+               reply.data[0] == FRAME_TYPE_PARAM_VALUES && reply.length >= 2)
+            {
+                close(fd);
+                print_values(&reply);
+
+                if(reply.data[1] != PARAM_OK)
+                {
+                    fprintf(stderr, "refuse: %s\n", (reply.data[1] < 4) ? result_names[reply.data[1]] : "?");
+                    return 1;
+                }
+
+                return 0;
+            }
+        }
+    }
+
+    close(fd);
+    fprintf(stderr, "pas de reponse de l'aeroglisseur\n");
+
+    return 1;
+}
@@ -0,0 +1,585 @@
+/**
+	\file udp_relay.c
+	\brief relais UDP qui ajoute du delai, de la gigue, des pertes, des doublons et du desordre
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Usage: udp_relay -l [adresse:]port -t adresse:port [options]
+
+        -l          adresse et port ou la manette envoie ses paquets (ex: 127.0.0.1:1337)
+        -t          adresse et port de l'aeroglisseur (ex: 127.0.0.2:1337)
+        -p profil   clean, wifi, jitter, burst, congested, reorder ou outage (options par defaut)
+        -d ms       delai moyen
+        -j ms       gigue (ecart type pour normal, demi-largeur pour uniform, echelle pour pareto)
+        -D loi      uniform, normal ou pareto
+        -L pourcent perte aleatoire
+        -g pourcent probabilite de passer en rafale de pertes a chaque paquet (Gilbert-Elliott)
+        -r pourcent probabilite de sortir d'une rafale de pertes a chaque paquet
+        -u pourcent doublons
+        -R pourcent paquets retenus pour arriver apres le suivant
+        -b bytes/s  debit maximal, les paquets attendent leur tour
+        -o ms/ms    coupure periodique, ex: 5000/1000 coupe 1 s toutes les 5 s
+        -s graine   graine du generateur aleatoire
+
+    Les options suivant -p modifient le profil. Les degradations s'appliquent aux deux sens. Les
+    reponses de l'aeroglisseur sont renvoyees au dernier expediteur vu sur le port d'ecoute,
+    comme le fait le module ESP8266 de l'aeroglisseur.
+
+    Avec host/esp_sim, l'aeroglisseur ecoute sur une autre adresse de loopback:
+
+        esp_sim -l /tmp/esp_aero -B 127.0.0.2 &
+        udp_relay -l 127.0.0.1:1337 -t 127.0.0.2:1337 -p wifi &
+        esp_sim -l /tmp/esp_manette -H 127.0.0.1 &
+
+    Ctrl-C affiche, pour chaque sens, les paquets recus, perdus, doubles, retenus et envoyes.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#define PACKET_MAX_LENGTH 2048
+#define QUEUE_SIZE 1024
+
+typedef enum
+{
+    UNIFORM_DISTRIBUTION,
+    NORMAL_DISTRIBUTION,
+    PARETO_DISTRIBUTION
+}distribution_enum;
+
+typedef enum
+{
+    UP_DIRECTION,       // manette -> aeroglisseur
+    DOWN_DIRECTION,     // aeroglisseur -> manette
+    NB_DIRECTIONS
+}direction_enum;
+
+/**
+    \brief degradations appliquees au lien
+*/
+typedef struct
+{
+    const char* name;
+    double delay_ms;
+    double jitter_ms;
+    distribution_enum distribution;
+    double loss_percent;
+    double burst_enter_percent;
+    double burst_exit_percent;
+    double duplicate_percent;
+    double reorder_percent;
+    double bandwidth;
+    double outage_period_ms;
+    double outage_ms;
+}profile_t;
+
+/**
+    \brief paquet en attente de son heure de sortie
+*/
+typedef struct
+{
+    double release_ms;
+    direction_enum direction;
+    size_t length;
+    uint8_t data[PACKET_MAX_LENGTH];
+}pending_packet_t;
+
+typedef struct
+{
+    uint64_t received;
+    uint64_t lost;
+    uint64_t duplicated;
+    uint64_t reordered;
+    uint64_t sent;
+    uint64_t overflowed;
+}statistics_t;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static const profile_t profiles[] = {
+    // nom          delai gigue loi                   perte entree sortie doublon desordre debit outage
+    {"clean",       0,    0,    UNIFORM_DISTRIBUTION, 0,    0,     0,     0,      0,       0,    0,    0},
+    {"wifi",        3,    2,    NORMAL_DISTRIBUTION,  1,    0,     0,     0,      0,       0,    0,    0},
+    {"jitter",      10,   15,   PARETO_DISTRIBUTION,  0,    0,     0,     0,      0,       0,    0,    0},
+    {"burst",       3,    2,    NORMAL_DISTRIBUTION,  0,    2,     30,    0,      0,       0,    0,    0},
+    {"congested",   40,   20,   NORMAL_DISTRIBUTION,  2,    0,     0,     0,      0,       400,  0,    0},
+    {"reorder",     5,    2,    NORMAL_DISTRIBUTION,  0,    0,     0,     5,      10,      0,    0,    0},
+    {"outage",      3,    2,    NORMAL_DISTRIBUTION,  0,    0,     0,     0,      0,       0,    5000, 1000}
+};
+
+static profile_t profile;
+
+static int listen_fd = -1;
+static int target_fd = -1;
+static struct sockaddr_in target;
+static struct sockaddr_in client;
+static int client_known = 0;
+
+static pending_packet_t* queue[QUEUE_SIZE];
+static size_t queue_length = 0;
+
+// heure a laquelle le lien a fini d'envoyer le paquet precedent, pour le debit maximal
+static double link_free_ms[NB_DIRECTIONS];
+
+// en rafale de pertes (Gilbert-Elliott)
+static int in_burst[NB_DIRECTIONS];
+
+// paquet retenu pour arriver apres le suivant
+static pending_packet_t* held[NB_DIRECTIONS];
+
+static statistics_t statistics[NB_DIRECTIONS];
+static double start_ms;
+
+static volatile sig_atomic_t running = 1;
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+static double now_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
+
+static void stop(int signal)
+{
+    running = 0;
+}
+
+static double random_uniform(void)
+{
+    return (rand() + 1.0) / (RAND_MAX + 2.0);
+}
+
+static int random_percent(double percent)
+{
+    return random_uniform() * 100.0 < percent;
+}
+
+/**
+    \brief tire un delai selon la loi du profil, jamais negatif
+*/
+static double random_delay(void)
+{
+    double delay = profile.delay_ms;
+
+    switch(profile.distribution)
+    {
+        case UNIFORM_DISTRIBUTION:
+            delay += (2.0 * random_uniform() - 1.0) * profile.jitter_ms;
+            break;
+
+        case NORMAL_DISTRIBUTION:
+            // Box-Muller
+            delay += profile.jitter_ms * sqrt(-2.0 * log(random_uniform())) *
+                     cos(2.0 * M_PI * random_uniform());
+            break;
+
+        case PARETO_DISTRIBUTION:
+            // queue lourde: la plupart des paquets sont a l'heure, quelques-uns tres en retard
+            delay += profile.jitter_ms * (pow(random_uniform(), -1.0 / 2.5) - 1.0);
+            break;
+    }
+
+    return (delay < 0) ? 0 : delay;
+}
+
+static int parse_address(const char* text, struct sockaddr_in* address, int address_required)
+{
+    char host[64] = "0.0.0.0";
+    const char* colon = strrchr(text, ':');
+
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+
+    if(colon != NULL)
+    {
+        snprintf(host, sizeof(host), "%.*s", (int)(colon - text), text);
+        text = colon + 1;
+    }
+    else if(address_required)
+    {
+        return 0;
+    }
+
+    address->sin_port = htons(atoi(text));
+
+    return inet_pton(AF_INET, host, &address->sin_addr) == 1;
+}
+
+static int find_profile(const char* name)
+{
+    size_t i;
+
+    for(i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+    {
+        if(strcmp(profiles[i].name, name) == 0)
+        {
+            profile = profiles[i];
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+    \brief indique si le lien est coupe a cette heure (coupure periodique)
+*/
+static int in_outage(double now)
+{
+    double phase;
+
+    if(profile.outage_period_ms <= 0)
+    {
+        return 0;
+    }
+
+    phase = fmod(now - start_ms, profile.outage_period_ms);
+
+    return phase >= profile.outage_period_ms - profile.outage_ms;
+}
+
+static void enqueue(pending_packet_t* packet)
+{
+    size_t i;
+
+    if(queue_length >= QUEUE_SIZE)
+    {
+        statistics[packet->direction].overflowed++;
+        free(packet);
+        return;
+    }
+
+    // la file est triee par heure de sortie
+    i = queue_length;
+
+    while(i > 0 && queue[i - 1]->release_ms > packet->release_ms)
+    {
+        queue[i] = queue[i - 1];
+        i--;
+    }
+
+    queue[i] = packet;
+    queue_length++;
+}
+
+/**
+    \brief applique les degradations a un paquet recu et le met dans la file
+*/
+static void impair(direction_enum direction, const uint8_t* data, size_t length)
+{
+    pending_packet_t* packet;
+    pending_packet_t* copy;
+    double now = now_ms();
+    double release;
+    double transmit_ms;
+
+    statistics[direction].received++;
+
+    // Gilbert-Elliott: une chaine a deux etats, toutes les pertes en rafale
+    if(in_burst[direction])
+    {
+        in_burst[direction] = !random_percent(profile.burst_exit_percent);
+    }
+    else
+    {
+        in_burst[direction] = random_percent(profile.burst_enter_percent);
+    }
+
+    if(in_burst[direction] || random_percent(profile.loss_percent) || in_outage(now))
+    {
+        statistics[direction].lost++;
+        return;
+    }
+
+    packet = malloc(sizeof(*packet));
+    packet->direction = direction;
+    packet->length = length;
+    memcpy(packet->data, data, length);
+
+    release = now + random_delay();
+
+    // le paquet attend que le lien ait fini d'envoyer les precedents
+    if(profile.bandwidth > 0)
+    {
+        transmit_ms = length * 1000.0 / profile.bandwidth;
+
+        if(link_free_ms[direction] > release)
+        {
+            release = link_free_ms[direction];
+        }
+
+        release += transmit_ms;
+        link_free_ms[direction] = release;
+    }
+
+    packet->release_ms = release;
+
+    if(random_percent(profile.duplicate_percent))
+    {
+        copy = malloc(sizeof(*copy));
+        *copy = *packet;
+        copy->release_ms += random_delay();
+        statistics[direction].duplicated++;
+        enqueue(copy);
+    }
+
+    // un paquet retenu sort juste apres le paquet suivant
+    if(held[direction] != NULL)
+    {
+        held[direction]->release_ms = release + 0.1;
+        enqueue(held[direction]);
+        held[direction] = NULL;
+        enqueue(packet);
+    }
+    else if(random_percent(profile.reorder_percent))
+    {
+        statistics[direction].reordered++;
+        held[direction] = packet;
+    }
+    else
+    {
+        enqueue(packet);
+    }
+}
+
+static void release_packets(void)
+{
+    pending_packet_t* packet;
+    double now = now_ms();
+    size_t i;
+    size_t released = 0;
+
+    while(released < queue_length && queue[released]->release_ms <= now)
+    {
+        packet = queue[released];
+
+        if(packet->direction == UP_DIRECTION)
+        {
+            sendto(target_fd, packet->data, packet->length, 0, (struct sockaddr*)&target,
+                   sizeof(target));
+            statistics[UP_DIRECTION].sent++;
+        }
+        else if(client_known)
+        {
+            sendto(listen_fd, packet->data, packet->length, 0, (struct sockaddr*)&client,
+                   sizeof(client));
+            statistics[DOWN_DIRECTION].sent++;
+        }
+
+        free(packet);
+        released++;
+    }
+
+    for(i = released; i < queue_length; i++)
+    {
+        queue[i - released] = queue[i];
+    }
+
+    queue_length -= released;
+}
+
+static void receive(int fd, direction_enum direction)
+{
+    uint8_t buffer[PACKET_MAX_LENGTH];
+    struct sockaddr_in sender;
+    socklen_t sender_length = sizeof(sender);
+    ssize_t length;
+
+    length = recvfrom(fd, buffer, sizeof(buffer), 0, (struct sockaddr*)&sender, &sender_length);
+
+    if(length <= 0)
+    {
+        return;
+    }
+
+    if(direction == UP_DIRECTION)
+    {
+        client = sender;
+        client_known = 1;
+    }
+
+    impair(direction, buffer, length);
+}
+
+static void print_statistics(void)
+{
+    static const char* names[NB_DIRECTIONS] = {"manette -> aeroglisseur", "aeroglisseur -> manette"};
+    int i;
+
+    fprintf(stderr, "%-24s %9s %9s %9s %9s %9s\n", profile.name, "recus", "perdus", "doubles",
+            "retenus", "envoyes");
+
+    for(i = 0; i < NB_DIRECTIONS; i++)
+    {
+        fprintf(stderr, "%-24s %9llu %9llu %9llu %9llu %9llu\n", names[i],
+                (unsigned long long)statistics[i].received, (unsigned long long)statistics[i].lost,
+                (unsigned long long)statistics[i].duplicated,
+                (unsigned long long)statistics[i].reordered, (unsigned long long)statistics[i].sent);
+    }
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr, "usage: %s -l [adresse:]port -t adresse:port [-p profil] [-d ms] [-j ms] "
+                    "[-D loi] [-L %%] [-g %%] [-r %%] [-u %%] [-R %%] [-b bytes/s] [-o ms/ms] "
+                    "[-s graine]\n", program);
+}
+
+/******************************************************************************
+Programme
+******************************************************************************/
+int main(int argc, char** argv)
+{
+    struct sockaddr_in local;
+    struct pollfd fds[2];
+    int have_local = 0;
+    int have_target = 0;
+    int option;
+    int timeout;
+    unsigned seed = time(NULL);
+
+    profile = profiles[0];
+
+    while((option = getopt(argc, argv, "l:t:p:d:j:D:L:g:r:u:R:b:o:s:")) != -1)
+    {
+        switch(option)
+        {
+            case 'l': have_local = parse_address(optarg, &local, 0); break;
+            case 't': have_target = parse_address(optarg, &target, 1); break;
+            case 'd': profile.delay_ms = atof(optarg); break;
+            case 'j': profile.jitter_ms = atof(optarg); break;
+            case 'L': profile.loss_percent = atof(optarg); break;
+            case 'g': profile.burst_enter_percent = atof(optarg); break;
+            case 'r': profile.burst_exit_percent = atof(optarg); break;
+            case 'u': profile.duplicate_percent = atof(optarg); break;
+            case 'R': profile.reorder_percent = atof(optarg); break;
+            case 'b': profile.bandwidth = atof(optarg); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+
+            case 'p':
+                if(!find_profile(optarg))
+                {
+                    fprintf(stderr, "profil inconnu: %s\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'D':
+                if(strcmp(optarg, "uniform") == 0)
+                {
+                    profile.distribution = UNIFORM_DISTRIBUTION;
+                }
+                else if(strcmp(optarg, "normal") == 0)
+                {
+                    profile.distribution = NORMAL_DISTRIBUTION;
+                }
+                else if(strcmp(optarg, "pareto") == 0)
+                {
+                    profile.distribution = PARETO_DISTRIBUTION;
+                }
+                else
+                {
+                    fprintf(stderr, "loi inconnue: %s\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'o':
+                if(sscanf(optarg, "%lf/%lf", &profile.outage_period_ms, &profile.outage_ms) != 2)
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(!have_local || !have_target)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    srand(seed);
+
+    listen_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    target_fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if(bind(listen_fd, (struct sockaddr*)&local, sizeof(local)) != 0)
+    {
+        perror("udp_relay: bind");
+        return 1;
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    start_ms = now_ms();
+    fprintf(stderr, "udp_relay: profil %s, graine %u\n", profile.name, seed);
+
+    while(running)
+    {
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = target_fd;
+        fds[1].events = POLLIN;
+
+        timeout = 100;
+
+        if(queue_length > 0)
+        {
+            timeout = (int)ceil(queue[0]->release_ms - now_ms());
+            timeout = (timeout < 0) ? 0 : timeout;
+        }
+
+        if(poll(fds, 2, timeout) < 0)
+        {
+            continue;
+        }
+
+        if(fds[0].revents & POLLIN)
+        {
+            receive(listen_fd, UP_DIRECTION);
+        }
+
+        if(fds[1].revents & POLLIN)
+        {
+            receive(target_fd, DOWN_DIRECTION);
+        }
+
+        release_packets();
+    }
+
+    print_statistics();
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+/**
+	\file latency.c
+	\brief mesure du delai entre la lecture des manettes et l'application de la commande
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "latency.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief histogramme d'une etape
+*/
+typedef struct
+{
+    uint32_t min;
+    uint32_t max;
+    uint16_t count;
+    uint8_t bins[LATENCY_NB_BINS];
+}histogram_t;
+
+/**
+    \brief echantillon en attente de la reponse de l'aeroglisseur
+*/
+typedef struct
+{
+    bool valid;
+    uint8_t seq;
+    uint16_t encode;
+    uint16_t tx;
+    uint32_t tx_done;
+}pending_t;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static histogram_t histograms[LATENCY_NB_STAGES];
+static pending_t pendings[LATENCY_NB_PENDING];
+
+/**
+    \brief largeur des cases de chaque etape en puissance de 2 (5 -> 32 us, 12 -> 4.096 ms)
+*/
+static const uint8_t bin_shifts[LATENCY_NB_STAGES] = {
+    5,      // ENCODE   : jusqu'a 512 us
+    10,     // UART_TX  : jusqu'a 16 ms
+    12,     // WIFI     : jusqu'a 65 ms
+    10,     // UART_RX  : jusqu'a 16 ms
+    9,      // DECODE   : jusqu'a 8 ms
+    5,      // APPLY    : jusqu'a 512 us
+    13      // TOTAL    : jusqu'a 131 ms
+};
+
+static const char* stage_names[LATENCY_NB_STAGES] = {
+    "ENC",
+    "TX",
+    "WIFI",
+    "RX",
+    "DEC",
+    "APP",
+    "TOT"
+};
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void latency_init(void)
+{
+    uint8_t i;
+    uint8_t j;
+
+    for(i = 0; i < LATENCY_NB_STAGES; i++)
+    {
+        histograms[i].min = 0xFFFFFFFF;
+        histograms[i].max = 0;
+        histograms[i].count = 0;
+
+        for(j = 0; j < LATENCY_NB_BINS; j++)
+        {
+            histograms[i].bins[j] = 0;
+        }
+    }
+
+    for(i = 0; i < LATENCY_NB_PENDING; i++)
+    {
+        pendings[i].valid = FALSE;
+    }
+}
+
+void latency_start(uint8_t seq, uint16_t encode_us, uint32_t tx_done, uint16_t tx_us)
+{
+    pending_t* pending = &pendings[seq & (LATENCY_NB_PENDING - 1)];
+
+    pending->valid = TRUE;
+    pending->seq = seq;
+    pending->encode = encode_us;
+    pending->tx = tx_us;
+    pending->tx_done = tx_done;
+}
+
+bool latency_complete(uint8_t seq, uint32_t rx_start, const latency_remote_t* remote)
+{
+    pending_t* pending = &pendings[seq & (LATENCY_NB_PENDING - 1)];
+    uint32_t round_trip;
+    uint32_t wifi = 0;
+    bool completed = FALSE;
+
+    // une reponse trop vieille a ete ecrasee par un echantillon plus recent
+    if(pending->valid && pending->seq == seq)
+    {
+        pending->valid = FALSE;
+
+        // de la fin de la transmission de la commande au debut de la reponse
+        round_trip = rx_start - pending->tx_done;
+
+        if(round_trip > remote->turnaround)
+        {
+            wifi = (round_trip - remote->turnaround) / 2;
+        }
+
+        latency_record(LATENCY_ENCODE, pending->encode);
+        latency_record(LATENCY_UART_TX, pending->tx);
+        latency_record(LATENCY_WIFI, wifi);
+        latency_record(LATENCY_UART_RX, remote->uart_rx);
+        latency_record(LATENCY_DECODE, remote->decode);
+        latency_record(LATENCY_APPLY, remote->apply);
+        latency_record(LATENCY_TOTAL, (uint32_t)pending->encode + pending->tx + wifi +
+                                      remote->uart_rx + remote->decode + remote->apply);
+
+        completed = TRUE;
+    }
+
+    return completed;
+}
+
+void latency_record(latency_stage_enum stage, uint32_t us)
+{
+    histogram_t* histogram = &histograms[stage];
+    uint32_t bin;
+    uint8_t i;
+
+    bin = us >> bin_shifts[stage];
+
+    // la derniere case recoit tout ce qui depasse
+    if(bin >= LATENCY_NB_BINS)
+    {
+        bin = LATENCY_NB_BINS - 1;
+    }
+
+    // quand une case est pleine, toutes les cases sont divisees par 2 pour garder la forme
+    if(histogram->bins[bin] == 0xFF)
+    {
+        histogram->count = 0;
+
+        for(i = 0; i < LATENCY_NB_BINS; i++)
+        {
+            histogram->bins[i] >>= 1;
+            histogram->count += histogram->bins[i];
+        }
+    }
+
+    histogram->bins[bin]++;
+    histogram->count++;
+
+    if(us < histogram->min)
+    {
+        histogram->min = us;
+    }
+
+    if(us > histogram->max)
+    {
+        histogram->max = us;
+    }
+}
+
+uint16_t latency_get_count(latency_stage_enum stage)
+{
+    return histograms[stage].count;
+}
+
+uint32_t latency_get_min(latency_stage_enum stage)
+{
+    return (histograms[stage].count > 0) ? histograms[stage].min : 0;
+}
+
+uint32_t latency_get_percentile(latency_stage_enum stage, uint8_t percent)
+{
+    histogram_t* histogram = &histograms[stage];
+    uint32_t target;
+    uint32_t cumulative = 0;
+    uint32_t value = 0;
+    uint8_t i;
+
+    if(histogram->count > 0)
+    {
+        // arrondi vers le haut pour que le p99 de 10 valeurs soit la plus grande
+        target = ((uint32_t)histogram->count * percent + 99) / 100;
+
+        for(i = 0; i < LATENCY_NB_BINS; i++)
+        {
+            cumulative += histogram->bins[i];
+
+            if(cumulative >= target && cumulative > 0)
+            {
+                break;
+            }
+        }
+
+        value = (((uint32_t)i + 1) << bin_shifts[stage]) - 1;
+
+        // la borne de la case ne peut pas depasser la plus grande valeur vue
+        if(i >= LATENCY_NB_BINS - 1 || value > histogram->max)
+        {
+            value = histogram->max;
+        }
+    }
+
+    return value;
+}
+
+const char* latency_get_stage_name(latency_stage_enum stage)
+{
+    return stage_names[stage];
+}
@@ -0,0 +1,139 @@
+#ifndef LATENCY_H_INCLUDED
+#define LATENCY_H_INCLUDED
+
+/**
+	\file latency.h
+	\brief mesure du delai entre la lecture des manettes et l'application de la commande
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Chaque commande envoyee par la manette contient un numero de sequence que l'aeroglisseur
+    renvoie dans sa reponse, accompagne des durees qu'il a mesurees lui-meme (voir
+    FRAME_TYPE_STATUS). La manette garde l'heure de chaque echantillon et reconstitue les etapes
+    suivantes:
+
+    - ENCODE   : de la lecture de l'ADC a la trame encodee (manette)
+    - UART_TX  : de la trame encodee au dernier byte remis au UART (manette)
+    - WIFI     : un aller simple, estime par (aller-retour - temps de traitement de l'aeroglisseur) / 2
+    - UART_RX  : du premier au dernier byte recu (aeroglisseur)
+    - DECODE   : du dernier byte recu a la trame decodee par la boucle principale (aeroglisseur)
+    - APPLY    : de la trame decodee a la premiere ecriture de OCR1A, OCR0 et OCR2 qui suit, au
+                 tick de 20 ms suivant (aeroglisseur, voir slew_get_applied_at et
+                 ramp_get_applied_at). Le gouvernail et les moteurs peuvent n'atteindre leur cible
+                 que plusieurs ticks plus tard, ce delai n'est pas compte
+    - TOTAL    : la somme des etapes precedentes
+
+    Les deux horloges ne sont jamais comparees entre elles, seulement des durees. L'estimation
+    WIFI inclut le delai de regroupement du module ESP8266 en mode transparent.
+
+    Chaque etape a son histogramme de LATENCY_NB_BINS cases dont la largeur est adaptee a l'ordre de
+    grandeur de l'etape. Les percentiles retournes sont la borne superieure de la case.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief nombre de cases par histogramme
+*/
+#define LATENCY_NB_BINS 16
+
+/**
+    \brief nombre d'echantillons en attente de reponse, doit etre une puissance de 2
+*/
+#define LATENCY_NB_PENDING 8
+
+/**
+    \brief etapes mesurees
+*/
+typedef enum
+{
+    LATENCY_ENCODE,
+    LATENCY_UART_TX,
+    LATENCY_WIFI,
+    LATENCY_UART_RX,
+    LATENCY_DECODE,
+    LATENCY_APPLY,
+    LATENCY_TOTAL,
+    LATENCY_NB_STAGES
+}latency_stage_enum;
+
+/**
+    \brief durees mesurees par l'aeroglisseur et renvoyees dans sa reponse, en us
+*/
+typedef struct
+{
+    uint16_t uart_rx;
+    uint16_t decode;
+    uint16_t apply;
+
+    // du premier byte de la commande recu a la reponse remise au UART
+    uint16_t turnaround;
+}latency_remote_t;
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief vide les histogrammes et les echantillons en attente
+    \return void
+*/
+void latency_init(void);
+
+/**
+    \brief memorise l'heure d'un echantillon envoye a l'aeroglisseur
+    \param[in] seq le numero de sequence de la commande
+    \param[in] encode_us la duree de l'etape ENCODE
+    \param[in] tx_done l'heure (time_micros) ou le dernier byte a ete remis au UART
+    \param[in] tx_us la duree de l'etape UART_TX
+    \return void
+*/
+void latency_start(uint8_t seq, uint16_t encode_us, uint32_t tx_done, uint16_t tx_us);
+
+/**
+    \brief complete la mesure d'un echantillon a la reception de la reponse
+    \param[in] seq le numero de sequence renvoye par l'aeroglisseur
+    \param[in] rx_start l'heure (time_micros) du premier byte de la reponse
+    \param[in] remote les durees mesurees par l'aeroglisseur
+    \return TRUE si l'echantillon etait connu et a ete ajoute aux histogrammes
+*/
+bool latency_complete(uint8_t seq, uint32_t rx_start, const latency_remote_t* remote);
+
+/**
+    \brief ajoute une duree a l'histogramme d'une etape
+    \param[in] stage l'etape
+    \param[in] us la duree
+    \return void
+*/
+void latency_record(latency_stage_enum stage, uint32_t us);
+
+/**
+    \brief retourne le nombre de durees dans l'histogramme d'une etape
+*/
+uint16_t latency_get_count(latency_stage_enum stage);
+
+/**
+    \brief retourne la plus petite duree mesuree pour une etape, en us
+*/
+uint32_t latency_get_min(latency_stage_enum stage);
+
+/**
+    \brief retourne un percentile de l'histogramme d'une etape
+    \param[in] stage l'etape
+    \param[in] percent le percentile voulu, 50 pour la mediane
+    \return la borne superieure de la case contenant le percentile, en us
+*/
+uint32_t latency_get_percentile(latency_stage_enum stage, uint8_t percent);
+
+/**
+    \brief retourne le nom court d'une etape pour l'affichage
+*/
+const char* latency_get_stage_name(latency_stage_enum stage);
+
+#endif
@@ -0,0 +1,244 @@
+/**
+	\file launch.c
+	\brief depart du drag execute par l'aeroglisseur, sans passer par le lien wifi
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "launch.h"
+#include "config.h"
+#include "driver.h"
+#include "failsafe.h"
+#include "ramp.h"
+#include "slew.h"
+#include "time.h"
+#include "trace.h"
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static launch_config_t launch_config;
+
+// courbe armee ou en cours
+static launch_curve_t curve;
+
+// temps depuis le depart en ms et point de la courbe ou il se trouve
+static volatile uint16_t elapsed;
+static volatile uint8_t point_index;
+
+static volatile launch_state_enum state;
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static void launch_tick(void);
+static void read_point(uint8_t i, launch_point_t* point);
+static int16_t interpolate(int16_t from, int16_t to, uint16_t done, uint16_t total);
+static void stop(void);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+bool launch_init(const launch_config_t* config)
+{
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    launch_config = *config;
+    state = LAUNCH_IDLE;
+
+    SREG = sreg;
+
+    return time_add_tick_callback(launch_tick);
+}
+
+bool launch_handle(const frame_t* request)
+{
+    bool accepted = FALSE;
+    uint8_t sreg;
+
+    if(request->length < 2)
+    {
+        return FALSE;
+    }
+
+    sreg = SREG;
+    cli();
+
+    switch(request->data[1])
+    {
+        // une courbe en cours ne peut pas etre remplacee, le tick lit toujours le point suivant
+        case LAUNCH_ARM:
+            if(request->length >= 3 && request->data[2] < launch_config.nb_curves && state != LAUNCH_RUNNING &&
+               launch_config.curves[request->data[2]].length >= 2)
+            {
+                curve = launch_config.curves[request->data[2]];
+                state = LAUNCH_ARMED;
+                accepted = TRUE;
+            }
+            break;
+
+        // le premier point est applique au prochain tick, seulement si le lien est surveille
+        case LAUNCH_GO:
+            if(state == LAUNCH_ARMED && curve.length >= 2 && failsafe_is_armed() == TRUE)
+            {
+                elapsed = 0;
+                point_index = 0;
+                state = LAUNCH_RUNNING;
+                TRACE(TRACE_LAUNCH, 1);
+                accepted = TRUE;
+            }
+            break;
+
+        case LAUNCH_ABORT:
+            if(state == LAUNCH_RUNNING)
+            {
+                stop();
+            }
+
+            state = LAUNCH_IDLE;
+            accepted = TRUE;
+            break;
+
+        default:
+            break;
+    }
+
+    SREG = sreg;
+
+    return accepted;
+}
+
+bool launch_feed(uint8_t hor, uint8_t thrust)
+{
+    uint8_t steering;
+
+    if(state != LAUNCH_RUNNING)
+    {
+        return FALSE;
+    }
+
+    steering = (hor > 127) ? hor - 127 : 127 - hor;
+
+    // le pilote reprend la main, sa commande remplace la courbe sans couper les moteurs
+    if(thrust > launch_config.thrust_deadband || steering > launch_config.steering_deadband)
+    {
+        state = LAUNCH_IDLE;
+        TRACE(TRACE_LAUNCH, 0);
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+launch_state_enum launch_get_state(void)
+{
+    return state;
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+/**
+    \brief appelee a chaque fin de periode du timer 1, aux 20 ms, dans l'interruption
+*/
+static void launch_tick(void)
+{
+    launch_point_t from;
+    launch_point_t to;
+    uint16_t done;
+    uint16_t total;
+
+    if(state != LAUNCH_RUNNING)
+    {
+        return;
+    }
+
+    // la coupure du failsafe a deja pris les moteurs
+    if(failsafe_is_tripped() == TRUE)
+    {
+        state = LAUNCH_IDLE;
+        TRACE(TRACE_LAUNCH, 0);
+        return;
+    }
+
+    read_point(curve.length - 1, &to);
+
+    // la courbe se termine a l'heure du dernier point
+    if(elapsed >= to.at_ms)
+    {
+        stop();
+        return;
+    }
+
+    // avance au segment qui contient l'heure courante, le dernier point est plus loin
+    read_point(point_index + 1, &to);
+
+    while(elapsed >= to.at_ms)
+    {
+        point_index++;
+        read_point(point_index + 1, &to);
+    }
+
+    read_point(point_index, &from);
+
+    // avant le premier point, ses valeurs sont appliquees telles quelles
+    done = (elapsed > from.at_ms) ? elapsed - from.at_ms : 0;
+    total = to.at_ms - from.at_ms;
+
+    ramp_set_target(RAMP_LIFT, (uint8_t)interpolate(from.lift, to.lift, done, total));
+    ramp_set_target(RAMP_THRUST, (uint8_t)interpolate(from.thrust, to.thrust, done, total));
+    slew_set_target(config_get(CONFIG_SERVO_CENTER) + interpolate(from.trim, to.trim, done, total));
+
+    // le temps sature au lieu de revenir a 0, la courbe se termine alors au prochain tick
+    elapsed = (elapsed <= 0xFFFF - LAUNCH_TICK_MS) ? elapsed + LAUNCH_TICK_MS : 0xFFFF;
+}
+
+/**
+    \brief copie un point de la courbe armee depuis la flash
+*/
+static void read_point(uint8_t i, launch_point_t* point)
+{
+    uint8_t j;
+
+    for(j = 0; j < sizeof(launch_point_t); j++)
+    {
+        ((uint8_t*)point)[j] = pgm_read_byte((const uint8_t*)&curve.points[i] + j);
+    }
+}
+
+/**
+    \brief interpolation en ligne droite, from quand done = 0, to quand done = total
+*/
+static int16_t interpolate(int16_t from, int16_t to, uint16_t done, uint16_t total)
+{
+    // deux premiers points a la meme heure
+    if(total == 0)
+    {
+        return from;
+    }
+
+    return from + (int16_t)(((int32_t)(to - from) * done) / total);
+}
+
+/**
+    \brief fin de la courbe: moteurs coupes et servomoteur centre
+*/
+static void stop(void)
+{
+    ramp_set_target(RAMP_LIFT, 0);
+    ramp_set_target(RAMP_THRUST, 0);
+    slew_set_target(config_get(CONFIG_SERVO_CENTER));
+
+    state = LAUNCH_IDLE;
+    TRACE(TRACE_LAUNCH, 0);
+}
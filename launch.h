@@ -0,0 +1,137 @@
+#ifndef LAUNCH_H_INCLUDED
+#define LAUNCH_H_INCLUDED
+
+/**
+	\file launch.h
+	\brief depart du drag execute par l'aeroglisseur, sans passer par le lien wifi
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Une courbe de depart est une suite de points en flash: l'heure depuis le depart, la
+    sustentation (PWM A), la propulsion (PWM B) et une correction du servomoteur autour du centre.
+    Entre deux points, les valeurs sont interpolees en ligne droite. Apres le dernier point, les
+    moteurs sont coupes et le servomoteur est centre.
+
+    Une trame FRAME_TYPE_LAUNCH LAUNCH_ARM choisit la courbe, puis LAUNCH_GO la demarre. La courbe
+    est jouee par le tick de la base de temps (l'interruption de fin de periode du timer 1, aux
+    20 ms, voir time.h): les sorties changent toujours aux memes ticks apres le depart, peu importe
+    la latence du wifi ou la charge de la boucle principale, et deux departs avec la meme courbe
+    sont identiques.
+
+    Le pilote garde la priorite: une commande dont la propulsion ou la direction sort de la zone
+    morte de la configuration arrete la courbe (launch_feed) et est appliquee normalement. La
+    perte du lien (failsafe.h) arrete aussi la courbe, la coupure du failsafe prend le relais.
+    LAUNCH_GO est refuse tant que le failsafe n'est pas arme par une commande de la manette: sans
+    lien surveille, rien ne couperait les moteurs si la manette se tait pendant la courbe.
+
+    Une courbe doit avoir au moins deux points, les autres sont refusees par LAUNCH_ARM.
+
+    host/udp_launch.c envoie ces trames depuis un PC.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+#include "frame.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief periode du tick de la base de temps en ms, resolution des courbes
+*/
+#define LAUNCH_TICK_MS 20
+
+/**
+    \brief un point d'une courbe de depart
+*/
+typedef struct
+{
+    uint16_t at_ms;         // heure du point depuis le depart, croissante
+    uint8_t lift;           // sustentation (PWM A)
+    uint8_t thrust;         // propulsion (PWM B)
+    int8_t trim;            // correction du servomoteur autour du centre, en us
+}launch_point_t;
+
+/**
+    \brief une courbe de depart
+*/
+typedef struct
+{
+    const launch_point_t* points;   // en flash (PROGMEM)
+    uint8_t length;
+}launch_curve_t;
+
+/**
+    \brief configuration des departs
+*/
+typedef struct
+{
+    // courbes qui peuvent etre armees, en RAM (les points sont en flash)
+    const launch_curve_t* curves;
+    uint8_t nb_curves;
+
+    // le pilote reprend la main au-dela de cette propulsion...
+    uint8_t thrust_deadband;
+
+    // ...ou de cet ecart de la direction par rapport au centre (127)
+    uint8_t steering_deadband;
+}launch_config_t;
+
+/**
+    \brief action d'une trame FRAME_TYPE_LAUNCH
+*/
+typedef enum
+{
+    LAUNCH_ABORT,           // arrete ou desarme, les moteurs sont coupes si la courbe jouait
+    LAUNCH_ARM,             // suivi du numero de la courbe
+    LAUNCH_GO
+}launch_action_enum;
+
+/**
+    \brief etat du depart
+*/
+typedef enum
+{
+    LAUNCH_IDLE,
+    LAUNCH_ARMED,
+    LAUNCH_RUNNING
+}launch_state_enum;
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief initialise les departs et les enregistre aupres de la base de temps
+    \param[in] config la configuration, copiee par le module
+    \return TRUE si le tick a ete enregistre, FALSE si la base de temps n'a plus de place
+    (TIME_NB_TICK_CALLBACKS): le module ne ferait alors rien
+
+    time_init et failsafe_init doivent avoir ete appeles
+*/
+bool launch_init(const launch_config_t* config);
+
+/**
+    \brief traite une trame FRAME_TYPE_LAUNCH
+    \param[in] request la trame recue
+    \return TRUE si l'action a ete acceptee
+*/
+bool launch_handle(const frame_t* request);
+
+/**
+    \brief donne au module la commande du pilote, a chaque commande recue
+    \param[in] hor la direction commandee
+    \param[in] thrust la propulsion commandee
+    \return TRUE si la courbe garde la main (l'appelant n'applique pas la commande), FALSE si la
+    commande doit etre appliquee
+*/
+bool launch_feed(uint8_t hor, uint8_t thrust);
+
+/**
+    \brief retourne l'etat du depart
+*/
+launch_state_enum launch_get_state(void);
+
+#endif
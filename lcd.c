@@ -18,9 +18,8 @@
 Includes
 ******************************************************************************/
 
-#include <avr/io.h>
+#include "hal.h"
 #include "lcd.h"
-#include <util/delay.h>
 
 
 /******************************************************************************
@@ -268,7 +267,7 @@ void lcd_clear_display(){
 
 void lcd_set_cursor_position(uint8_t col, uint8_t row){
 
-    if((col >= 0) && (col < LCD_NB_COL) && (row >= 0) && (row < LCD_NB_ROW)){
+    if((col < LCD_NB_COL) && (row < LCD_NB_ROW)){
 
         hd44780_set_cursor_position(col, row);
 
@@ -384,7 +383,8 @@ void lcd_write_char(char character){
 		if(clear_required_flag == TRUE){
 
 			hd44780_clear_display();
-			//hd44780_set_cursor_position(index_to_col(local_index), index_to_row(local_index));
+			// clear display ramene le curseur a 0, local_index garde la colonne
+			hd44780_set_cursor_position(index_to_col(local_index), index_to_row(local_index));
 			clear_required_flag = FALSE;
 		}
 
@@ -413,6 +413,19 @@ void lcd_write_string(const char* string){
 }
 
 
+void lcd_write_string_P(const char* string){
+
+    char character;
+
+    while((character = pgm_read_byte(string)) != '\0'){
+
+        lcd_write_char(character);
+
+        string++;
+    }
+}
+
+
 /** Text *********************************************************************/
 
 #ifdef LCD_ENABLE_TEXT_MODULE
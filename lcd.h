@@ -429,6 +429,12 @@ void lcd_write_char(char character);
 
 */
 void lcd_write_string(const char* string);
+
+/**
+    \brief Comme lcd_write_string, mais la string est lue dans la mémoire flash.
+    \param[in] string La string en flash, ex: PSTR("Hello World")
+*/
+void lcd_write_string_P(const char* string);
 
 
 #endif // LCD_H_INCLUDED
@@ -9,64 +9,108 @@
 /******************************************************************************
 Includes
 ******************************************************************************/
-#include <avr/io.h>
-#include <avr/interrupt.h>
-#include <util/delay.h>
+#include "hal.h"
 
 #include "driver.h"
 #include "uart.h"
+#include "frame.h"
 #include "utils.h"
 #include "lcd.h"
 #include "util_29.h"
+#include "packet.h"
+#include "config.h"
+
+#ifdef LATENCY_MEASUREMENT
+    #include "time.h"
+    #include "latency.h"
+#endif
 
 /******************************************************************************
 Defines
 ******************************************************************************/
 /**
-    \brief contient la valeur de l'escape byte
+    \brief lecture de l'ADC de la batterie a 0%, et ecart de lecture entre 0% et 100%
 */
-#define ESCAPE 'A'
+#define BATTERY_OFFSET 125
+#define BATTERY_SPAN 38
 
 /**
-    \brief contient la valeur signifiant "debut"
+    \brief correction de l'oscillateur interne
 */
-#define BEGIN 'B'
+#define OSCCAL_OFFSET 8
 
 /**
-    \brief contient la valeur signifiant "fin"
+    \brief identifiants du point d'acces de l'aeroglisseur
 */
-#define END 'C'
+#define WIFI_SSID "THING"
+#define WIFI_PASSWORD "f8aa2328679b"
 
+#ifdef LATENCY_MEASUREMENT
 /**
-    \brief contient la valeur signifiant 'A'
+    \brief nombre de reponses pendant lesquelles une etape reste affichee
 */
-#define VALUE 'A'
+#define LATENCY_DISPLAY_PERIOD 32
+#endif
 
 /**
-    \brief contient la valeur signifiant 0
+    \brief reglages utilises tant que l'EEPROM ne contient pas de configuration valide (voir config.h),
+    la manette n'a pas de servomoteur
 */
-#define ZERO_VALUE 'D'
+static const config_t config_defaults PROGMEM =
+{
+    {0, 0, 0, BATTERY_OFFSET, BATTERY_SPAN, OSCCAL_OFFSET, 0, 1, 0},
+    {WIFI_SSID, WIFI_PASSWORD}
+};
 
+#ifdef LATENCY_MEASUREMENT
+/******************************************************************************
+Static functions
+******************************************************************************/
 /**
-    \brief etat possible de la machine state
+    \brief ajoute une duree en dixiemes de ms sur 4 chiffres, saturee a 999.9 ms
+    \param[out] string la string a completer
+    \param[in] us la duree
+    \return void
 */
-typedef enum
+static void append_tenths(char* string, uint32_t us)
 {
-    REJECT_STATE,
-    ESCAPE_STATE,
-    ACCEPT_STATE,
-    BEGIN_STATE,
-    END_STATE
-}state_enum;
+    char digits[6];
+    uint32_t tenths = us / 100;
+
+    if(tenths > 9999)
+    {
+        tenths = 9999;
+    }
+
+    // uint16_to_string donne toujours 5 chiffres, le premier est toujours 0
+    uint16_to_string(digits, (uint16_t)tenths);
+    string_concat(string, string, &digits[1]);
+}
 
 /**
-    \brief etat possible des bytes
+    \brief affiche le min, la mediane et le p99 d'une etape en dixiemes de ms
+    \param[in] stage l'etape
+    \return void
 */
-typedef enum
+static void display_latency(latency_stage_enum stage)
 {
-    OLD_BYTE,
-    NEW_BYTE
-}byte_state_enum;
+    char result[32];
+
+    result[0] = '\0';
+
+    string_concat(result, result, (char*)latency_get_stage_name(stage));
+    string_concat_P(result, result, PSTR(" min/p50/p99"));
+    string_concat_P(result, result, PSTR("\n\r"));
+    append_tenths(result, latency_get_min(stage));
+    string_concat_P(result, result, PSTR(" "));
+    append_tenths(result, latency_get_percentile(stage, 50));
+    string_concat_P(result, result, PSTR(" "));
+    append_tenths(result, latency_get_percentile(stage, 99));
+
+    lcd_clear_display();
+    lcd_write_string(result);
+}
+#endif
 
 /******************************************************************************
 Programme
@@ -87,252 +131,205 @@ Programme
 */
 int main(int argc, char** argv)
 {
-    char data[64];
-    char result[32];
     char hor_buffer[4];
     char ver_buffer[4];
     char sus_buffer[4];
     char bat_man[4];
+#ifndef LATENCY_MEASUREMENT
+    char result[32];
     char bat_aero[4];
-    char transmit_data[64];
+    char failsafe_count[2] = {0};
+#endif
+    uint8_t command[5];
+    char transmit_data[FRAME_ENCODED_MAX_LENGTH];
 
     uint8_t ver;
     uint8_t hor;
     uint8_t sus;
     uint8_t bat;
 
-    uint8_t index = 0;
-    uint8_t byte = 0;
+    // numero de la commande, renvoye par l'aeroglisseur dans sa reponse
+    uint8_t seq = 0;
+
+#ifdef LATENCY_MEASUREMENT
+    // heures (time_micros) de l'echantillonnage, de l'encodage et de la fin de l'envoi
+    uint32_t sampled_at;
+    uint32_t encoded_at;
+    uint32_t sent_at;
+    uint32_t rx_first;
+    uint32_t rx_last;
+    latency_remote_t remote;
+    uint8_t nb_replies = 0;
+#endif
 
-    // egal 1 si le programme enregistre les bytes;
-    uint8_t in_data_write = 0;
+    // egal TRUE si une nouvelle reponse est arrivee depuis le dernier tour de boucle
+    bool new_status = FALSE;
 
-    // regarde si le byte est un nouveau byte
-    byte_state_enum byte_state = OLD_BYTE;
+    // decodeur des trames, trame en reception et boite aux lettres contenant la derniere reponse
+    // de l'aeroglisseur, les trames viennent de la reserve de packet.h
+    frame_decoder_t decoder;
+    frame_t* received;
+    frame_t* status = NULL;
 
-    // contient l'etat l'etat de la state machine
-    state_enum state = REJECT_STATE;
+    // pas d'arguments sur le microcontroleur
+    (void)argc;
+    (void)argv;
+
+    // les reglages de l'EEPROM remplacent les valeurs par defaut avant d'initialiser les composantes
+    config_init(&config_defaults);
 
     uart_init();
     lcd_init();
     adc_init();
+#ifdef LATENCY_MEASUREMENT
+    time_init();
+    latency_init();
+#endif
     sei();
     DDRD = set_bit(DDRD, PD2);
     PORTD = clear_bit(PORTD, PD2);
     PORTD = set_bit(PORTD, PD2);
 
     // initialise le wifi
-    OSCCAL = OSCCAL + 8;
-    lcd_write_string("connecting...");
+    OSCCAL = OSCCAL + (int8_t)config_get(CONFIG_OSCCAL_OFFSET);
+    lcd_write_string_P(PSTR("connecting..."));
 
-    uart_put_string("AT+CWMODE_DEF=1\r\n");
+    uart_put_string_P(PSTR("AT+CWMODE_DEF=1\r\n"));
     _delay_ms(1000);
     uart_flush();
-    uart_put_string("AT+CWJAP_DEF=\"THING\",\"f8aa2328679b\"\r\n");
+    uart_put_string_P(PSTR("AT+CWJAP_DEF=\""));
+    uart_put_string((char*)config_get_string(CONFIG_WIFI_SSID));
+    uart_put_string_P(PSTR("\",\""));
+    uart_put_string((char*)config_get_string(CONFIG_WIFI_PASSWORD));
+    uart_put_string_P(PSTR("\"\r\n"));
     _delay_ms(5000);
     uart_flush();
-    uart_put_string("AT+CIPMODE=1\r\n");
+    uart_put_string_P(PSTR("AT+CIPMODE=1\r\n"));
     _delay_ms(1000);
     uart_flush();
-    uart_put_string("AT+CIPSTART=\"UDP\",\"192.168.4.1\",1337,31337\r\n");
+    uart_put_string_P(PSTR("AT+CIPSTART=\"UDP\",\"192.168.4.1\",1337,31337\r\n"));
     _delay_ms(1000);
     uart_flush();
-    uart_put_string("AT+CIPSEND\r\n");
+    uart_put_string_P(PSTR("AT+CIPSEND\r\n"));
     _delay_ms(1000);
     uart_flush();
 
     // le message restera a l'ecran plus de 10 seconde si la connection a echouer
     lcd_clear_display();
-    lcd_write_string("failed to connect");
+    lcd_write_string_P(PSTR("failed to connect"));
+
+    frame_decoder_init(&decoder);
+    packet_init();
+    received = packet_alloc();
 
     while(1)
     {
-        // si le rx buffer n'est pas vide
-        if(uart_is_rx_buffer_empty() == FALSE && !byte_state)
+#ifdef LATENCY_MEASUREMENT
+        sampled_at = time_micros();
+#endif
+
+        // regarde le pourcentage de la batterie
+        ver = 255-adc_read(PA1);
+        hor = 255-adc_read(PA0);
+        sus = adc_read(PA3);
+        bat = ((adc_read(PA2)-(int16_t)config_get(CONFIG_BATTERY_OFFSET))*100)/(int16_t)config_get(CONFIG_BATTERY_SPAN);
+
+        // transmission des donnees a l'aeroglisseur
+        command[0] = FRAME_TYPE_COMMAND;
+        command[1] = hor;
+        command[2] = ver;
+        command[3] = sus;
+        command[4] = seq;
+        frame_encode(transmit_data, command, sizeof(command));
+
+#ifdef LATENCY_MEASUREMENT
+        encoded_at = time_micros();
+        uart_put_string(transmit_data);
+
+        // attendre la fin de l'envoi donne la duree UART_TX et le depart de l'aller-retour
+        uart_flush();
+        sent_at = time_micros();
+        latency_start(seq, encoded_at - sampled_at, sent_at, sent_at - encoded_at);
+#else
+        uart_put_string(transmit_data);
+#endif
+
+        seq++;
+
+        uint8_to_string(hor_buffer, hor);
+        uint8_to_string(ver_buffer, ver);
+        uint8_to_string(sus_buffer, sus);
+        uint8_to_string(bat_man, bat);
+        _delay_ms(50);
+
+        // vide le rx buffer, seule la reponse la plus recente est conservee
+        new_status = FALSE;
+        while(uart_is_rx_buffer_empty() == FALSE)
         {
-            byte = uart_get_byte();
-            byte_state = NEW_BYTE;
+            if(frame_decoder_push(&decoder, uart_get_byte(), received) == TRUE)
+            {
+                // une reponse contient au moins le type et la batterie de l'aeroglisseur
+                if(received->data[0] == FRAME_TYPE_STATUS && received->length >= 2)
+                {
+                    packet_free(status);
+                    status = received;
+                    received = packet_alloc();
+                    new_status = TRUE;
+                }
+            }
         }
 
-        // state machine
-        switch(state)
+#ifdef LATENCY_MEASUREMENT
+        // la reponse contient la sequence de la commande et les durees mesurees par l'aeroglisseur
+        if(new_status == TRUE && status->length >= 12)
         {
-            // si en reject state
-            case REJECT_STATE:
-
-                // regarde le pourcentage de la batterie
-                ver = 255-adc_read(PA1);
-                hor = 255-adc_read(PA0);
-                sus = adc_read(PA3);
-                bat = ((adc_read(PA2)-125)*100)/38;
-
-                // transmission des donnees a l'aeroglisseur
-                memory_set(transmit_data, 0, 64);
-                string_concat(transmit_data, transmit_data, "AB");
-                add_data_to_string(transmit_data, hor_buffer, hor);
-                add_data_to_string(transmit_data, ver_buffer, ver);
-                add_data_to_string(transmit_data, sus_buffer, sus);
-                string_concat(transmit_data, transmit_data, "AC");
-                uint8_to_string(bat_man, bat);
-                uart_put_string(transmit_data);
-                _delay_ms(50);
-
-                // regarde si le byte est nouveau
-                if(byte_state)
-                {
-                    // si c'est un escape byte entre en escape state
-                    if(byte == ESCAPE)
-                    {
-                        state = ESCAPE_STATE;
-                        byte_state = OLD_BYTE;
-                    }
-
-                    // jete tout les autres byte
-                    else
-                    {
-                        byte_state = OLD_BYTE;
-                    }
-                }
-                break;
+            uart_get_rx_timestamps(&rx_first, &rx_last);
 
-            // si en escape state
-            case ESCAPE_STATE:
-                if(byte_state)
-                {
-                    switch(byte)
-                    {
-
-                        // si le prochain byte est 'B'
-                        case BEGIN:
-                            if(!in_data_write)
-                            {
-                                state = BEGIN_STATE;
-                                byte_state = OLD_BYTE;
-                            }
-                            else
-                            {
-                                state = REJECT_STATE;
-                            }
-                            break;
-
-                        // si le prochain byte est 'C'
-                        case END:
-                            if(in_data_write)
-                            {
-                                state = END_STATE;
-                                byte_state = OLD_BYTE;
-                            }
-                            else
-                            {
-                                state = REJECT_STATE;
-                            }
-                            break;
-
-                        // si le prochain byte est 'A'
-                        case VALUE:
-                            if(in_data_write)
-                            {
-                                data[index] = VALUE;
-                                index++;
-                                byte_state = OLD_BYTE;
-                                state = ACCEPT_STATE;
-                            }
-                            else
-                            {
-                                state = REJECT_STATE;
-                            }
-                            break;
-
-                        // si le prochain byte est 'D'
-                        case ZERO_VALUE:
-                            if(in_data_write)
-                            {
-                                data[index] = 0;
-                                index++;
-                                byte_state = OLD_BYTE;
-                                state = ACCEPT_STATE;
-                            }
-                            else
-                            {
-                                state = REJECT_STATE;
-                            }
-                            break;
-
-                        // si le prochain byte est du garbage
-                        default:
-                            byte_state = OLD_BYTE;
-                            state = REJECT_STATE;
-                            in_data_write = 0;
-                            break;
-                    }
-                }
-                break;
-
-            // si en begin state, initialise les donnees
-            case BEGIN_STATE:
-                state = ACCEPT_STATE;
-                in_data_write = 1;
-                index = 0;
-
-                memory_set(data, 0, 64);
-                break;
-
-            // si en end state, utilise les donnees
-            case END_STATE:
-                state = REJECT_STATE;
-                in_data_write = 0;
-                data[index] = 0;
-
-                //affiche les donnees receuillis
-                uint8_to_string(bat_aero, data[0]);
-
-                memory_set(result, 0, 32);
-
-                string_concat(result, result, "H");
-                string_concat(result, result, hor_buffer);
-                string_concat(result, result, "/V");
-                string_concat(result, result, ver_buffer);
-                string_concat(result, result, "/S");
-                string_concat(result, result, sus_buffer);
-                string_concat(result, result, "\n\r");
-                string_concat(result, result, "M:");
-                string_concat(result, result, bat_man);
-                string_concat(result, result, "%/");
-                string_concat(result, result, "A:");
-                string_concat(result, result, bat_aero);
-                string_concat(result, result, "%");
-
-                lcd_clear_display();
-                lcd_write_string(result);
-                break;
-
-            // si en accept state, met les donnees dans le buffer
-            case ACCEPT_STATE:
-                if(byte_state)
-                {
-                    // si on trouve un escape byte
-                    if(byte == ESCAPE)
-                    {
-                        state = ESCAPE_STATE;
-                        byte_state = OLD_BYTE;
-                    }
-
-                    // sinon on garde la donnees
-                    else
-                    {
-                        data[index] = byte;
-                        index++;
-                        byte_state = OLD_BYTE;
-                    }
-                }
-                break;
-
-            // si l'evenement qui arrive n'est pas gerer
-            default:
-                lcd_clear_display();
-                lcd_write_string("error 101");
-                return 101;
-                break;
+            remote.uart_rx = status->data[4] | (status->data[5] << 8);
+            remote.decode = status->data[6] | (status->data[7] << 8);
+            remote.apply = status->data[8] | (status->data[9] << 8);
+            remote.turnaround = status->data[10] | (status->data[11] << 8);
+
+            if(latency_complete(status->data[3], rx_first, &remote) == TRUE)
+            {
+                nb_replies++;
+            }
+
+            display_latency((nb_replies / LATENCY_DISPLAY_PERIOD) % LATENCY_NB_STAGES);
+        }
+#else
+        //affiche les donnees receuillis
+        if(new_status == TRUE)
+        {
+            uint8_to_string(bat_aero, status->data[1]);
+
+            result[0] = '\0';
+
+            string_concat_P(result, result, PSTR("H"));
+            string_concat(result, result, hor_buffer);
+            string_concat_P(result, result, PSTR("/V"));
+            string_concat(result, result, ver_buffer);
+            string_concat_P(result, result, PSTR("/S"));
+            string_concat(result, result, sus_buffer);
+            string_concat_P(result, result, PSTR("\n\r"));
+            string_concat_P(result, result, PSTR("M:"));
+            string_concat(result, result, bat_man);
+            string_concat_P(result, result, PSTR("%/"));
+            string_concat_P(result, result, PSTR("A:"));
+            string_concat(result, result, bat_aero);
+            string_concat_P(result, result, PSTR("%"));
+
+            // nombre de pertes de lien vues par l'aeroglisseur
+            if(status->length >= 3)
+            {
+                failsafe_count[0] = uint_to_char(status->data[2] % 10);
+                string_concat_P(result, result, PSTR("F"));
+                string_concat(result, result, failsafe_count);
+            }
+
+            lcd_clear_display();
+            lcd_write_string(result);
         }
+#endif
     }
 }
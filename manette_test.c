@@ -8,9 +8,7 @@
 /******************************************************************************
 Includes
 ******************************************************************************/
-#include <avr/io.h>
-#include <avr/interrupt.h>
-#include <util/delay.h>
+#include "hal.h"
 
 #include "driver.h"
 #include "uart.h"
@@ -41,6 +39,10 @@ int main(int argc, char** argv)
     uint8_t sus;
     uint8_t bat;
 
+    // pas d'arguments sur le microcontroleur
+    (void)argc;
+    (void)argv;
+
     lcd_init();
     adc_init();
 
@@ -0,0 +1,102 @@
+/**
+	\file packet.c
+	\brief reserve statique de trames partagee entre le decodeur, le programme et l'envoi
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "packet.h"
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static frame_t pool[PACKET_POOL_SIZE];
+
+// pile des indices des trames libres, les nb_free premiers sont valides
+static uint8_t free_indexes[PACKET_POOL_SIZE];
+static volatile uint8_t nb_free;
+static volatile uint8_t min_free;
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void packet_init(void)
+{
+    uint8_t i;
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    for(i = 0; i < PACKET_POOL_SIZE; i++)
+    {
+        free_indexes[i] = i;
+    }
+
+    nb_free = PACKET_POOL_SIZE;
+    min_free = PACKET_POOL_SIZE;
+
+    SREG = sreg;
+}
+
+frame_t* packet_alloc(void)
+{
+    frame_t* packet = NULL;
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    if(nb_free > 0)
+    {
+        nb_free--;
+        packet = &pool[free_indexes[nb_free]];
+        packet->length = 0;
+
+        if(nb_free < min_free)
+        {
+            min_free = nb_free;
+        }
+    }
+
+    SREG = sreg;
+
+    return packet;
+}
+
+void packet_free(frame_t* packet)
+{
+    uint8_t sreg;
+
+    if(packet == NULL)
+    {
+        return;
+    }
+
+    sreg = SREG;
+    cli();
+
+    if(nb_free < PACKET_POOL_SIZE)
+    {
+        free_indexes[nb_free] = (uint8_t)(packet - pool);
+        nb_free++;
+    }
+
+    SREG = sreg;
+}
+
+uint8_t packet_get_nb_free(void)
+{
+    return nb_free;
+}
+
+uint8_t packet_get_min_free(void)
+{
+    return min_free;
+}
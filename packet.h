@@ -0,0 +1,75 @@
+#ifndef PACKET_H_INCLUDED
+#define PACKET_H_INCLUDED
+
+/**
+	\file packet.h
+	\brief reserve statique de trames partagee entre le decodeur, le programme et l'envoi
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Les trames (frame_t, 33 bytes) ne vivent plus sur la pile de main: elles sont prises dans une
+    reserve de PACKET_POOL_SIZE blocs alloues une fois pour toutes en .bss. packet_alloc et
+    packet_free sont en O(1) (pile des indices libres) et peuvent etre appeles d'une interruption.
+
+    Une trame passe d'une etape a l'autre par son pointeur: le decodeur ecrit directement dedans,
+    la boucle principale la garde comme commande courante, puis la rend a la reserve quand une
+    commande plus recente arrive. Celui qui detient le pointeur est le seul a pouvoir utiliser la
+    trame et doit la rendre avec packet_free.
+
+    aero.c garde trois trames pour toute l'execution (reception, commande, statut). La quatrieme
+    permet a une trame d'attendre son traitement pendant que le decodeur remplit la suivante.
+    PACKET_POOL_SIZE peut etre change a la compilation (-DPACKET_POOL_SIZE=5) pour en garder plus.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+#include "frame.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief nombre de trames dans la reserve, au plus 255
+*/
+#ifndef PACKET_POOL_SIZE
+    #define PACKET_POOL_SIZE 4
+#endif
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief rend toutes les trames a la reserve
+    \return void
+
+    les pointeurs obtenus avant l'appel ne doivent plus etre utilises
+*/
+void packet_init(void);
+
+/**
+    \brief prend une trame dans la reserve
+    \return la trame, de longueur 0 et au contenu indefini, ou NULL si la reserve est vide
+*/
+frame_t* packet_alloc(void);
+
+/**
+    \brief rend une trame a la reserve
+    \param[in] packet une trame obtenue par packet_alloc, ou NULL (rien n'est fait)
+    \return void
+*/
+void packet_free(frame_t* packet);
+
+/**
+    \brief nombre de trames disponibles dans la reserve
+*/
+uint8_t packet_get_nb_free(void);
+
+/**
+    \brief plus petit nombre de trames disponibles vu depuis packet_init
+*/
+uint8_t packet_get_min_free(void);
+
+#endif
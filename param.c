@@ -0,0 +1,182 @@
+/**
+	\file param.c
+	\brief lecture et reglage des parametres de config.h par le lien de commande
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "param.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+// la reponse a une lecture de tous les reglages (type, resultat, puis un triplet par cle) doit
+// tenir dans une trame, sinon la taille du tableau est negative
+typedef char get_all_fits_in_frame[(2 + 3 * CONFIG_NB_VALUES <= FRAME_MAX_LENGTH) ? 1 : -1];
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static param_apply_callback_t apply_callback;
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static param_result_enum check_set(const frame_t* request);
+static void apply_set(const frame_t* request);
+static void append_value(frame_t* reply, uint8_t key);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void param_init(param_apply_callback_t callback)
+{
+    apply_callback = callback;
+}
+
+param_result_enum param_handle(const frame_t* request, frame_t* reply)
+{
+    param_result_enum result = PARAM_OK;
+    uint8_t key;
+    uint8_t i;
+
+    reply->data[0] = FRAME_TYPE_PARAM_VALUES;
+    reply->length = 2;
+
+    if(request->data[0] == FRAME_TYPE_PARAM_SET)
+    {
+        result = check_set(request);
+
+        if(result == PARAM_OK)
+        {
+            apply_set(request);
+
+            if(request->data[1] & PARAM_PERSIST)
+            {
+                config_save();
+            }
+        }
+
+        // les valeurs courantes des cles connues de la trame, meme si elle est refusee
+        for(i = 2; i + 2 < request->length && reply->length + 3 <= FRAME_MAX_LENGTH; i += 3)
+        {
+            if(request->data[i] < CONFIG_NB_VALUES)
+            {
+                append_value(reply, request->data[i]);
+            }
+        }
+    }
+    else if(request->length <= 1)
+    {
+        // tient toujours dans la trame (voir get_all_fits_in_frame)
+        for(key = 0; key < CONFIG_NB_VALUES; key++)
+        {
+            append_value(reply, key);
+        }
+    }
+    else
+    {
+        for(i = 1; i < request->length && reply->length + 3 <= FRAME_MAX_LENGTH; i++)
+        {
+            if(request->data[i] < CONFIG_NB_VALUES)
+            {
+                append_value(reply, request->data[i]);
+            }
+            else
+            {
+                result = PARAM_UNKNOWN_KEY;
+            }
+        }
+    }
+
+    reply->data[1] = result;
+
+    return result;
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+/**
+    \brief verifie toutes les valeurs d'une trame FRAME_TYPE_PARAM_SET avant d'en appliquer une
+*/
+static param_result_enum check_set(const frame_t* request)
+{
+    uint8_t i;
+
+    if(request->length < 2 || (request->length - 2) % 3 != 0 || (request->length - 2) / 3 > PARAM_MAX_PAIRS)
+    {
+        return PARAM_MALFORMED;
+    }
+
+    for(i = 2; i < request->length; i += 3)
+    {
+        if(request->data[i] >= CONFIG_NB_VALUES)
+        {
+            return PARAM_UNKNOWN_KEY;
+        }
+
+        if(!config_is_valid(request->data[i], request->data[i + 1] | ((uint16_t)request->data[i + 2] << 8)))
+        {
+            return PARAM_OUT_OF_RANGE;
+        }
+    }
+
+    return PARAM_OK;
+}
+
+/**
+    \brief applique toutes les valeurs d'une trame deja verifiee, sans interruption entre deux
+
+    Le profil passe avant les autres cles, quelle que soit sa place dans la trame: il remplace les
+    reglages qui en dependent (voir profile_select), les retouches de la meme trame s'appliquent
+    donc par-dessus au lieu d'etre ecrasees.
+*/
+static void apply_set(const frame_t* request)
+{
+    uint8_t pass;
+    uint8_t i;
+    uint8_t sreg;
+    uint16_t value;
+
+    sreg = SREG;
+    cli();
+
+    // passe 0: CONFIG_PROFILE, passe 1: les autres cles
+    for(pass = 0; pass < 2; pass++)
+    {
+        for(i = 2; i < request->length; i += 3)
+        {
+            if((request->data[i] == CONFIG_PROFILE) != (pass == 0))
+            {
+                continue;
+            }
+
+            value = request->data[i + 1] | ((uint16_t)request->data[i + 2] << 8);
+            config_set(request->data[i], value);
+
+            if(apply_callback != NULL)
+            {
+                apply_callback(request->data[i], value);
+            }
+        }
+    }
+
+    SREG = sreg;
+}
+
+static void append_value(frame_t* reply, uint8_t key)
+{
+    uint16_t value = config_get(key);
+
+    reply->data[reply->length] = key;
+    reply->data[reply->length + 1] = (uint8_t)(value & 0xFF);
+    reply->data[reply->length + 2] = (uint8_t)(value >> 8);
+    reply->length += 3;
+}
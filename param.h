@@ -0,0 +1,93 @@
+#ifndef PARAM_H_INCLUDED
+#define PARAM_H_INCLUDED
+
+/**
+	\file param.h
+	\brief lecture et reglage des parametres de config.h par le lien de commande
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Une trame FRAME_TYPE_PARAM_SET contient les options puis jusqu'a PARAM_MAX_PAIRS triplets
+    cle, valeur:
+
+        'P' | options | cle | valeur LSB | valeur MSB | cle | ...
+
+    Toutes les valeurs sont verifiees (config_is_valid) avant d'en appliquer une seule: la trame
+    est appliquee au complet ou pas du tout. Les valeurs sont ecrites avec les interruptions
+    masquees, le tick du timer 1 (failsafe, ...) voit donc soit les anciennes, soit les nouvelles
+    valeurs, jamais un melange. Avec PARAM_PERSIST, la configuration est ensuite sauvegardee
+    dans l'EEPROM (config_save, quelques dizaines de ms).
+
+    Les cles sont appliquees dans l'ordre de la trame, sauf CONFIG_PROFILE qui passe toujours en
+    premier: choisir un profil remplace les reglages qui en dependent (voir profile.h), une trame
+    qui change le profil et retouche un de ces reglages garde donc la retouche, comme la reponse
+    l'indique.
+
+    Une trame FRAME_TYPE_PARAM_GET contient la liste des cles a lire, ou rien pour toutes.
+
+    Dans les deux cas, la reponse FRAME_TYPE_PARAM_VALUES donne le resultat puis les valeurs
+    courantes des cles demandees (celles de la configuration, donc les anciennes si la trame est
+    refusee):
+
+        'V' | resultat | cle | valeur LSB | valeur MSB | cle | ...
+
+    host/udp_param.c envoie ces trames depuis un PC.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+#include "frame.h"
+#include "config.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief option de FRAME_TYPE_PARAM_SET: sauvegarde la configuration dans l'EEPROM
+*/
+#define PARAM_PERSIST 0x01
+
+/**
+    \brief nombre maximal de triplets dans une trame, pour que la reponse tienne dans une trame
+*/
+#define PARAM_MAX_PAIRS ((FRAME_MAX_LENGTH - 2) / 3)
+
+/**
+    \brief resultat d'une trame de reglage
+*/
+typedef enum
+{
+    PARAM_OK,
+    PARAM_MALFORMED,            // longueur qui n'est pas un nombre entier de triplets
+    PARAM_UNKNOWN_KEY,          // cle plus grande ou egale a CONFIG_NB_VALUES
+    PARAM_OUT_OF_RANGE          // valeur refusee par config_is_valid
+}param_result_enum;
+
+/**
+    \brief appelee pour chaque valeur changee, interruptions masquees, pour les modules qui
+    gardent leur propre copie d'un reglage
+*/
+typedef void (*param_apply_callback_t)(config_value_enum key, uint16_t value);
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief installe la fonction appelee pour chaque valeur changee
+    \param[in] callback la fonction, ou NULL
+    \return void
+*/
+void param_init(param_apply_callback_t callback);
+
+/**
+    \brief traite une trame FRAME_TYPE_PARAM_SET ou FRAME_TYPE_PARAM_GET
+    \param[in] request la trame recue
+    \param[out] reply la reponse FRAME_TYPE_PARAM_VALUES a envoyer
+    \return le resultat, aussi place dans la reponse
+*/
+param_result_enum param_handle(const frame_t* request, frame_t* reply);
+
+#endif
@@ -0,0 +1,97 @@
+/**
+	\file profile.c
+	\brief profils de conduite de l'aeroglisseur (race, drag) dans un seul firmware
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "profile.h"
+#include "config.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief un cote du servomoteur: valeur = hor * gain / 255 + base
+*/
+typedef struct
+{
+    uint16_t gain;
+    uint16_t base;
+}steering_t;
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+// table des profils, en flash
+static const profile_t* table;
+
+// cote gauche (hor <= 126) puis cote droit, precalcules par profile_update
+static steering_t steering[2];
+
+static uint8_t thrust_max = 255;
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static void set_side(steering_t* side, uint16_t angle);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void profile_init(const profile_t* profiles)
+{
+    table = profiles;
+    profile_update();
+}
+
+void profile_select(profile_enum profile)
+{
+    const profile_t* selected = &table[profile];
+
+    config_set(CONFIG_PROFILE, profile);
+    config_set(CONFIG_SERVO_RIGHT, pgm_read_word(&selected->servo_right));
+    config_set(CONFIG_SERVO_LEFT, pgm_read_word(&selected->servo_left));
+    config_set(CONFIG_TELEMETRY_DIVIDER, pgm_read_byte(&selected->telemetry_divider));
+
+    profile_update();
+}
+
+void profile_update(void)
+{
+    set_side(&steering[0], config_get(CONFIG_SERVO_LEFT));
+    set_side(&steering[1], config_get(CONFIG_SERVO_RIGHT));
+
+    thrust_max = pgm_read_byte(&table[config_get(CONFIG_PROFILE)].thrust_max);
+}
+
+uint16_t profile_get_servo(uint8_t hor)
+{
+    // le cote est un index (0 ou 1), pas un branchement
+    const steering_t* side = &steering[hor > 126];
+
+    return (uint16_t)(((uint32_t)hor * side->gain) / 255UL) + side->base;
+}
+
+uint8_t profile_get_thrust(uint8_t thrust)
+{
+    return (thrust > thrust_max) ? thrust_max : thrust;
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+/**
+    \brief precalcule un cote: 0 -> centre - angle, 255 -> centre + angle
+*/
+static void set_side(steering_t* side, uint16_t angle)
+{
+    side->gain = angle * 2;
+    side->base = config_get(CONFIG_SERVO_CENTER) - angle;
+}
@@ -0,0 +1,96 @@
+#ifndef PROFILE_H_INCLUDED
+#define PROFILE_H_INCLUDED
+
+/**
+	\file profile.h
+	\brief profils de conduite de l'aeroglisseur (race, drag) dans un seul firmware
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Un profil regroupe les reglages qui changent entre les configurations: debattement du
+    servomoteur de chaque cote, poussee maximale et cadence de la telemetrie. Le firmware donne
+    sa table de profils (en flash) a profile_init.
+
+    profile_select copie les valeurs d'un profil dans la configuration (config.h), ou elles
+    peuvent ensuite etre retouchees par le lien de commande (param.h), puis precalcule la table
+    utilisee par la boucle principale. Le profil courant est la cle CONFIG_PROFILE: il est donc
+    choisi au demarrage par la configuration de l'EEPROM et change par une trame
+    FRAME_TYPE_PARAM_SET, par exemple:
+
+        host/udp_param -s profil=drag
+
+    Pour chaque commande, profile_get_servo et profile_get_thrust ne font qu'indexer la table
+    precalculee, sans relire la configuration ni choisir le cote par un if. Apres un changement du
+    centre ou d'un debattement, profile_update recalcule la table.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief profils connus, dans l'ordre de la table donnee a profile_init
+*/
+typedef enum
+{
+    PROFILE_RACE,
+    PROFILE_DRAG,
+    PROFILE_NB
+}profile_enum;
+
+/**
+    \brief reglages d'un profil
+*/
+typedef struct
+{
+    uint16_t servo_right;           // debattement vers la droite, en us
+    uint16_t servo_left;            // debattement vers la gauche, en us
+    uint8_t thrust_max;             // poussee maximale, 0 a 255
+    uint8_t telemetry_divider;      // une trame de statut toutes les N commandes
+}profile_t;
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief installe la table des profils et precalcule celui de la configuration
+    \param[in] profiles PROFILE_NB profils, en flash (PROGMEM)
+    \return void
+
+    config_init doit etre appele avant
+*/
+void profile_init(const profile_t* profiles);
+
+/**
+    \brief passe a un autre profil: ses valeurs remplacent celles de la configuration
+    \param[in] profile le profil, plus petit que PROFILE_NB
+    \return void
+*/
+void profile_select(profile_enum profile);
+
+/**
+    \brief recalcule la table precalculee apres un changement de la configuration
+    \return void
+*/
+void profile_update(void);
+
+/**
+    \brief valeur du servomoteur pour une commande de direction
+    \param[in] hor la direction, 0 (gauche) a 255 (droite)
+    \return la valeur a donner a servo_set_a, en us
+*/
+uint16_t profile_get_servo(uint8_t hor);
+
+/**
+    \brief limite la poussee au maximum du profil
+    \param[in] thrust la poussee demandee
+    \return la poussee a appliquer
+*/
+uint8_t profile_get_thrust(uint8_t thrust);
+
+#endif
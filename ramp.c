@@ -0,0 +1,194 @@
+/**
+	\file ramp.c
+	\brief limite l'acceleration et la deceleration des moteurs de sustentation et de propulsion
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "ramp.h"
+#include "driver.h"
+#include "time.h"
+#include "trace.h"
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static ramp_config_t ramp_config;
+
+static volatile bool initialized;
+
+// duty voulu et duty applique de chaque canal
+static volatile uint8_t target[RAMP_NB_CHANNELS];
+static volatile uint8_t duty[RAMP_NB_CHANNELS];
+
+// canaux qui saturent, un bit par canal
+static volatile uint8_t saturation;
+
+// une cible n'a pas encore ete vue par un tick, et heure (time_micros) du tick qui l'a vue
+static volatile bool applying;
+static volatile uint32_t applied_at;
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static void ramp_tick(void);
+static void write_channel(ramp_channel_enum channel, uint8_t value);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+bool ramp_init(const ramp_config_t* config)
+{
+    uint8_t channel;
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    ramp_config = *config;
+
+    for(channel = 0; channel < RAMP_NB_CHANNELS; channel++)
+    {
+        target[channel] = 0;
+        duty[channel] = 0;
+        write_channel(channel, 0);
+    }
+
+    saturation = 0;
+    applying = FALSE;
+    applied_at = time_micros();
+    initialized = TRUE;
+
+    SREG = sreg;
+
+    return time_add_tick_callback(ramp_tick);
+}
+
+void ramp_set_target(ramp_channel_enum channel, uint8_t new_target)
+{
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    target[channel] = new_target;
+    applying = initialized;
+
+    if(!initialized)
+    {
+        duty[channel] = new_target;
+        write_channel(channel, new_target);
+    }
+
+    SREG = sreg;
+}
+
+uint8_t ramp_get_duty(ramp_channel_enum channel)
+{
+    return duty[channel];
+}
+
+uint8_t ramp_get_saturation(void)
+{
+    return saturation;
+}
+
+bool ramp_get_applied_at(uint32_t* at)
+{
+    bool applied;
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    applied = !applying;
+    *at = applied_at;
+
+    SREG = sreg;
+
+    return applied;
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+/**
+    \brief appelee a chaque fin de periode du timer 1, aux 20 ms, dans l'interruption
+
+    enregistree apres le failsafe et la courbe de depart, leurs cibles sont donc appliquees au
+    meme tick
+*/
+static void ramp_tick(void)
+{
+    uint8_t new_saturation = 0;
+    uint8_t channel;
+    uint8_t distance;
+    uint8_t limit;
+
+    for(channel = 0; channel < RAMP_NB_CHANNELS; channel++)
+    {
+        if(duty[channel] == target[channel])
+        {
+            continue;
+        }
+
+        if(target[channel] > duty[channel])
+        {
+            distance = target[channel] - duty[channel];
+            limit = ramp_config.limits[channel].accel_step;
+        }
+        else
+        {
+            distance = duty[channel] - target[channel];
+            limit = ramp_config.limits[channel].decel_step;
+        }
+
+        // la limite empeche d'atteindre la cible a ce tick, 0 = sans limite
+        if(limit == 0 || distance <= limit)
+        {
+            duty[channel] = target[channel];
+        }
+        else
+        {
+            duty[channel] = (target[channel] > duty[channel]) ? duty[channel] + limit : duty[channel] - limit;
+            new_saturation |= 1 << channel;
+        }
+
+        write_channel(channel, duty[channel]);
+    }
+
+    // OCR0 et OCR2 viennent d'etre ecrits (ou contenaient deja les cibles) depuis ramp_set_target,
+    // une cible limitee par accel_step ou decel_step n'est atteinte que plusieurs ticks plus tard
+    if(applying)
+    {
+        applying = FALSE;
+        applied_at = time_micros();
+    }
+
+    if(new_saturation != saturation)
+    {
+        saturation = new_saturation;
+        TRACE(TRACE_RAMP, new_saturation);
+    }
+}
+
+/**
+    \brief ecrit le duty d'un canal, un duty de 0 force la broche a 0 (voir pwm_set_a)
+*/
+static void write_channel(ramp_channel_enum channel, uint8_t value)
+{
+    if(channel == RAMP_LIFT)
+    {
+        pwm_set_a(value);
+    }
+    else
+    {
+        pwm_set_b(value);
+    }
+}
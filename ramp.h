@@ -0,0 +1,105 @@
+#ifndef RAMP_H_INCLUDED
+#define RAMP_H_INCLUDED
+
+/**
+	\file ramp.h
+	\brief limite l'acceleration et la deceleration des moteurs de sustentation et de propulsion
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Sans ce module, pwm_set_a et pwm_set_b passent d'un coup au duty commande. Un saut a pleine
+    puissance tire un pic de courant qui fait chuter la batterie, et la lecture de la batterie sur
+    PA0 est alors fausse.
+
+    Les modules donnent plutot une cible a ramp_set_target pour chaque canal. Le tick de la base de
+    temps (l'interruption de fin de periode du timer 1, aux 20 ms, voir time.h) rapproche le duty de
+    la cible d'au plus accel_step en montee et decel_step en descente, puis ecrit OCR0 (sustentation,
+    PWM A) ou OCR2 (propulsion, PWM B). Chaque canal a ses propres limites. Le tick est enregistre
+    apres ceux qui donnent des cibles (failsafe.c, launch.c) pour les appliquer a la meme periode
+    (voir time.h).
+
+    Un canal sature tant que sa limite l'empeche d'atteindre la cible. ramp_get_saturation donne les
+    canaux qui saturent, et chaque changement est enregistre dans la trace (TRACE_RAMP).
+
+    Tant que ramp_init n'a pas ete appele, ramp_set_target ecrit le PWM tout de suite.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief canaux de moteur
+*/
+typedef enum
+{
+    RAMP_LIFT,              // sustentation, PWM A (timer 0)
+    RAMP_THRUST,            // propulsion, PWM B (timer 2)
+    RAMP_NB_CHANNELS
+}ramp_channel_enum;
+
+/**
+    \brief limites d'un canal, en duty par periode de 20 ms, 0 = sans limite
+*/
+typedef struct
+{
+    uint8_t accel_step;
+    uint8_t decel_step;
+}ramp_limit_t;
+
+/**
+    \brief configuration des rampes
+*/
+typedef struct
+{
+    ramp_limit_t limits[RAMP_NB_CHANNELS];
+}ramp_config_t;
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief initialise les rampes et les enregistre aupres de la base de temps
+    \param[in] config la configuration, copiee par le module
+    \return TRUE si le tick a ete enregistre, FALSE si la base de temps n'a plus de place
+    (TIME_NB_TICK_CALLBACKS): le module ne ferait alors rien
+
+    pwm_init et time_init doivent avoir ete appeles. Les deux canaux partent de 0.
+*/
+bool ramp_init(const ramp_config_t* config);
+
+/**
+    \brief change la cible d'un canal, peut etre appelee dans une interruption
+    \param[in] channel le canal
+    \param[in] new_target le duty voulu
+    \return void
+*/
+void ramp_set_target(ramp_channel_enum channel, uint8_t new_target);
+
+/**
+    \brief retourne le duty presentement applique a un canal
+*/
+uint8_t ramp_get_duty(ramp_channel_enum channel);
+
+/**
+    \brief retourne les canaux qui saturent, un bit par canal (1 << RAMP_LIFT, 1 << RAMP_THRUST)
+*/
+uint8_t ramp_get_saturation(void);
+
+/**
+    \brief donne l'heure de la premiere ecriture de OCR0 et OCR2 depuis le dernier ramp_set_target
+    \param[out] at l'heure (time_micros) du tick qui a ecrit les deux canaux
+    \return FALSE tant que le tick suivant ramp_set_target n'a pas eu lieu
+
+    Comme slew_get_applied_at: le premier pas vers chaque cible est ecrit au premier tick, la
+    sustentation et la propulsion peuvent n'atteindre leur cible que plusieurs ticks plus tard
+    (ramp_get_saturation). Un canal deja a sa cible n'est pas reecrit, l'heure est celle du tick.
+*/
+bool ramp_get_applied_at(uint32_t* at);
+
+#endif
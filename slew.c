@@ -0,0 +1,197 @@
+/**
+	\file slew.c
+	\brief limite la vitesse du servomoteur et applique ses changements a la fin des periodes
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "slew.h"
+#include "driver.h"
+#include "time.h"
+#include "trace.h"
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static slew_config_t slew_config;
+
+static volatile bool initialized;
+
+// impulsion voulue et impulsion appliquee, en us
+static volatile uint16_t target;
+static volatile uint16_t position;
+
+// pas de l'interpolation vers la cible courante, en us par periode
+static volatile uint16_t step;
+
+// periodes depuis le dernier changement de cible
+static volatile uint8_t nb_ticks;
+
+// la cible n'a pas encore ete vue par un tick, et heure (time_micros) du tick qui l'a vue
+static volatile bool applying;
+static volatile uint32_t applied_at;
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static void slew_tick(void);
+static void write_servo(uint16_t value);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+bool slew_init(const slew_config_t* config, uint16_t initial)
+{
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    slew_config = *config;
+    target = initial;
+    position = initial;
+    step = 0;
+    nb_ticks = 0;
+    applying = FALSE;
+    applied_at = time_micros();
+    write_servo(initial);
+    initialized = TRUE;
+
+    SREG = sreg;
+
+    return time_add_tick_callback(slew_tick);
+}
+
+void slew_set_target(uint16_t new_target)
+{
+    uint16_t distance;
+    uint8_t periods;
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    // l'ecriture de OCR1A ne peut pas etre coupee par une interruption qui lit TCNT1
+    if(!initialized)
+    {
+        position = new_target;
+        write_servo(new_target);
+    }
+    else if(slew_config.interpolate)
+    {
+        // le deplacement est reparti sur l'intervalle entre les deux dernieres cibles
+        periods = (nb_ticks == 0) ? 1 : (nb_ticks > SLEW_MAX_PERIOD_TICKS) ? SLEW_MAX_PERIOD_TICKS : nb_ticks;
+        distance = (new_target > position) ? new_target - position : position - new_target;
+        step = (distance + periods - 1) / periods;
+    }
+
+    target = new_target;
+    nb_ticks = 0;
+    applying = initialized;
+
+    SREG = sreg;
+}
+
+bool slew_get_applied_at(uint32_t* at)
+{
+    bool applied;
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    applied = !applying;
+    *at = applied_at;
+
+    SREG = sreg;
+
+    return applied;
+}
+
+uint16_t slew_get_position(void)
+{
+    uint16_t value;
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    value = position;
+
+    SREG = sreg;
+
+    return value;
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+/**
+    \brief appelee a chaque fin de periode du timer 1, aux 20 ms, dans l'interruption
+
+    la valeur ecrite dans OCR1A est prise par le timer au TOP suivant, au debut d'une periode
+*/
+static void slew_tick(void)
+{
+    uint16_t limit = slew_config.interpolate ? step : 0;
+    uint16_t distance;
+
+    if(nb_ticks < 0xFF)
+    {
+        nb_ticks++;
+    }
+
+    // OCR1A contient deja la cible, la nouvelle cible est tout de meme appliquee a ce tick
+    if(position == target)
+    {
+        applying = FALSE;
+        applied_at = time_micros();
+        return;
+    }
+
+    // le pas de l'interpolation ne peut pas depasser la limite de vitesse, 0 = sans limite
+    if(slew_config.max_step_us != 0 && (limit == 0 || limit > slew_config.max_step_us))
+    {
+        limit = slew_config.max_step_us;
+    }
+
+    distance = (target > position) ? target - position : position - target;
+
+    if(limit == 0 || distance <= limit)
+    {
+        position = target;
+    }
+    else if(target > position)
+    {
+        position += limit;
+    }
+    else
+    {
+        position -= limit;
+    }
+
+    write_servo(position);
+
+    // premiere ecriture de OCR1A depuis slew_set_target, la cible peut demander d'autres ticks
+    if(applying)
+    {
+        applying = FALSE;
+        applied_at = time_micros();
+    }
+}
+
+/**
+    \brief ecrit OCR1A et l'enregistre dans la trace, driver.c ne depend pas de la trace
+*/
+static void write_servo(uint16_t value)
+{
+    servo_set_a(value);
+
+    TRACE(TRACE_SERVO_UPDATE, (uint8_t)(value >> 3));
+}
@@ -0,0 +1,94 @@
+#ifndef SLEW_H_INCLUDED
+#define SLEW_H_INCLUDED
+
+/**
+	\file slew.h
+	\brief limite la vitesse du servomoteur et applique ses changements a la fin des periodes
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Sans ce module, chaque commande ecrit OCR1A tout de suite: l'impulsion saute d'un coup a la
+    nouvelle valeur aux 50 ms, et l'ecriture de OCR1A (16 bits, deux acces qui passent par le
+    registre TEMP du timer 1) peut etre coupee par une interruption qui lit TCNT1 (time_micros dans
+    l'interruption RX), ce qui donne une impulsion fausse pendant une periode.
+
+    Les modules donnent plutot une cible a slew_set_target. Le tick de la base de temps
+    (l'interruption de fin de periode du timer 1, aux 20 ms, voir time.h) rapproche la position de
+    la cible d'au plus max_step_us et est le seul a ecrire OCR1A. Comme OCR1A est lui-meme double
+    en mode fast PWM (la valeur ecrite est prise au TOP), chaque nouvelle impulsion commence au
+    debut d'une periode et aucune impulsion n'est coupee.
+
+    Avec interpolate, le deplacement vers une nouvelle cible est aussi reparti sur l'intervalle
+    mesure entre les deux dernieres cibles (au plus SLEW_MAX_PERIOD_TICKS periodes): le gouvernail
+    suit une rampe continue entre les commandes de la manette au lieu de marches, au prix d'un
+    retard d'environ une commande.
+
+    Tant que slew_init n'a pas ete appele, slew_set_target ecrit OCR1A tout de suite.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief intervalle maximal entre deux cibles pris en compte par l'interpolation, en periodes
+*/
+#define SLEW_MAX_PERIOD_TICKS 10
+
+/**
+    \brief configuration du servomoteur
+*/
+typedef struct
+{
+    // variation maximale de l'impulsion a chaque periode de 20 ms, en us, 0 = sans limite
+    uint16_t max_step_us;
+
+    // TRUE pour repartir chaque deplacement sur l'intervalle entre les commandes
+    bool interpolate;
+}slew_config_t;
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief initialise la limitation et l'enregistre aupres de la base de temps
+    \param[in] config la configuration, copiee par le module
+    \param[in] initial l'impulsion actuelle, en us, ecrite tout de suite
+    \return TRUE si le tick a ete enregistre, FALSE si la base de temps n'a plus de place
+    (TIME_NB_TICK_CALLBACKS): le module ne ferait alors rien
+
+    servo_init et time_init doivent avoir ete appeles
+*/
+bool slew_init(const slew_config_t* config, uint16_t initial);
+
+/**
+    \brief change la cible du servomoteur, peut etre appelee dans une interruption
+    \param[in] new_target l'impulsion voulue, en us
+    \return void
+*/
+void slew_set_target(uint16_t new_target);
+
+/**
+    \brief donne l'heure de la premiere ecriture de OCR1A depuis le dernier slew_set_target
+    \param[out] at l'heure (time_micros) du tick qui a ecrit OCR1A
+    \return FALSE tant que le tick suivant slew_set_target n'a pas eu lieu
+
+    Le premier pas vers la cible est ecrit au premier tick, la cible peut n'etre atteinte que
+    plusieurs ticks plus tard (max_step_us, interpolate). Si OCR1A contenait deja la cible, l'heure
+    est celle du tick qui l'a constate. Une cible donnee ensuite par un autre module (failsafe,
+    courbe de depart) remplace l'heure au tick suivant. Avant slew_init, slew_set_target ecrit
+    OCR1A tout de suite et l'heure ne change pas.
+*/
+bool slew_get_applied_at(uint32_t* at);
+
+/**
+    \brief retourne l'impulsion presentement appliquee, en us
+*/
+uint16_t slew_get_position(void);
+
+#endif
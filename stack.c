@@ -0,0 +1,103 @@
+/**
+	\file stack.c
+	\brief mesure de la profondeur maximale atteinte par la pile depuis le demarrage
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "stack.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+#ifdef HAL_HOST
+    #define FREE_RAM_START (&hal_host_free_ram[0])
+    #define FREE_RAM_END (&hal_host_free_ram[HAL_HOST_FREE_RAM_LENGTH - 1])
+#else
+    // symboles de l'editeur de liens: fin de .bss (et debut du tas), haut de la pile
+    extern uint8_t _end;
+    extern uint8_t __stack;
+
+    #define FREE_RAM_START (&_end)
+    #define FREE_RAM_END (&__stack)
+#endif
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+static const uint8_t* find_deepest(void);
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+#ifdef HAL_HOST
+void stack_paint(void)
+{
+    uint8_t* p = FREE_RAM_START;
+
+    while(p <= FREE_RAM_END)
+    {
+        *p = STACK_CANARY;
+        p++;
+    }
+}
+#else
+/*
+    dans .init1, le registre r1 n'est pas encore a 0 et la pile n'est pas initialisee: la boucle
+    est ecrite en assembleur pour ne dependre ni de l'un ni de l'autre
+*/
+void stack_paint(void) __attribute__((naked, used, section(".init1")));
+
+void stack_paint(void)
+{
+    __asm__ volatile(
+        "    ldi r30, lo8(_end)\n"
+        "    ldi r31, hi8(_end)\n"
+        "    ldi r24, %0\n"
+        "    ldi r25, hi8(__stack)\n"
+        "    rjmp 2f\n"
+        "1:  st Z+, r24\n"
+        "2:  cpi r30, lo8(__stack)\n"
+        "    cpc r31, r25\n"
+        "    brlo 1b\n"
+        "    breq 1b\n"
+        :
+        : "i"(STACK_CANARY)
+    );
+}
+#endif
+
+uint16_t stack_get_max_used(void)
+{
+    return (uint16_t)(FREE_RAM_END - find_deepest() + 1);
+}
+
+uint16_t stack_get_min_free(void)
+{
+    return (uint16_t)(find_deepest() - FREE_RAM_START);
+}
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+/**
+    \brief cherche le premier byte ecrase en partant du bas de la RAM libre
+    \return son adresse, ou le byte apres FREE_RAM_END si la pile n'a jamais servi
+*/
+static const uint8_t* find_deepest(void)
+{
+    const uint8_t* p = FREE_RAM_START;
+
+    while(p <= FREE_RAM_END && *p == STACK_CANARY)
+    {
+        p++;
+    }
+
+    return p;
+}
@@ -0,0 +1,65 @@
+#ifndef STACK_H_INCLUDED
+#define STACK_H_INCLUDED
+
+/**
+	\file stack.h
+	\brief mesure de la profondeur maximale atteinte par la pile depuis le demarrage
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    La RAM libre de l'ATmega32 va de la fin des variables globales (_end, le tas n'est pas
+    utilise) jusqu'au haut de la pile (__stack, RAMEND). Au demarrage, avant que la pile serve,
+    stack_paint remplit cette zone avec STACK_CANARY. La pile descend ensuite dans la zone et
+    ecrase le motif: le premier byte qui n'est plus STACK_CANARY en partant du bas donne le point
+    le plus profond jamais atteint.
+
+    La mesure sous-estime la profondeur si une fonction reserve un buffer sans ecrire ses premiers
+    bytes, ou si elle y ecrit justement STACK_CANARY: les valeurs sont un minimum, il faut garder
+    une marge.
+
+    Sur l'ATmega32, stack_paint est placee dans la section .init1 et s'execute toute seule avant
+    l'initialisation des variables. Sur PC (HAL_HOST), la zone est le tableau hal_host_free_ram et
+    les tests appellent stack_paint eux-memes.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief motif ecrit dans la RAM libre, peu probable dans les variables de la pile
+*/
+#define STACK_CANARY 0xC5
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief remplit la RAM libre avec STACK_CANARY
+    \return void
+
+    sur l'ATmega32, appelee par le code de demarrage, ne pas l'appeler depuis le programme
+*/
+void stack_paint(void);
+
+/**
+    \brief nombre de bytes de pile utilises au plus profond depuis le demarrage
+    \return les bytes entre le haut de la pile et le premier byte ecrase
+*/
+uint16_t stack_get_max_used(void);
+
+/**
+    \brief plus petit ecart vu entre les variables et la pile depuis le demarrage
+    \return les bytes de RAM libre jamais touches
+
+    parcourt toute la zone libre (environ 1 ms pour 1 ko a 8 MHz), a appeler quand le temps
+    n'est pas critique
+*/
+uint16_t stack_get_min_free(void);
+
+#endif
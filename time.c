@@ -0,0 +1,146 @@
+/**
+	\file time.c
+	\brief base de temps monotone en microsecondes partagee par tous les modules
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "time.h"
+#include "trace.h"
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+// nombre de periodes completes du timer 1 depuis time_init
+static volatile uint32_t period_count;
+
+// 16 bits de poids faible de period_count * TIME_PERIOD_US, pour time_micros16
+static volatile uint16_t period_base16;
+
+static time_tick_callback_t tick_callbacks[TIME_NB_TICK_CALLBACKS];
+static volatile uint8_t nb_tick_callbacks;
+
+/******************************************************************************
+Interupts
+******************************************************************************/
+/**
+    \brief interruption de fin de periode du timer 1, aux 20 ms
+*/
+ISR(TIMER1_OVF_vect)
+{
+    uint8_t i;
+
+    period_count++;
+    period_base16 += (uint16_t)TIME_PERIOD_US;
+
+    TRACE(TRACE_ISR_TICK, 0);
+
+    for(i = 0; i < nb_tick_callbacks; i++)
+    {
+        tick_callbacks[i]();
+    }
+}
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void time_init(void)
+{
+    // mode 14: fast PWM avec TOP = ICR1, identique a servo_init
+    TCCR1A = set_bit(TCCR1A, WGM11);
+    TCCR1A = clear_bit(TCCR1A, WGM10);
+    TCCR1B = set_bit(TCCR1B, WGM13);
+    TCCR1B = set_bit(TCCR1B, WGM12);
+
+    ICR1 = TIME_TOP;
+
+    // facteur de division de frequence a 8, donc 1 MHz a 8 MHz
+    TCCR1B = clear_bit(TCCR1B, CS12);
+    TCCR1B = clear_bit(TCCR1B, CS10);
+    TCCR1B = set_bit(TCCR1B, CS11);
+
+    period_count = 0;
+    period_base16 = 0;
+
+    TIMSK = set_bit(TIMSK, TOIE1);
+}
+
+uint32_t time_micros(void)
+{
+    uint8_t sreg;
+    uint32_t periods;
+    uint16_t count;
+
+    sreg = SREG;
+    cli();
+
+    periods = period_count;
+    count = TCNT1;
+
+    // en mode 14, TOV1 monte quand le compteur atteint TOP: TOP est deja le debut de la periode
+    // suivante, que l'interruption l'ait comptee ou non
+    if(count >= TIME_TOP)
+    {
+        count = 0;
+    }
+
+    // si la periode vient de se terminer mais que l'interruption n'a pas encore ete servie,
+    // le compteur est deja reparti de 0 et il faut compter la periode nous-meme
+    if(read_bit(TIFR, TOV1) && count < TIME_TOP / 2)
+    {
+        periods++;
+    }
+
+    SREG = sreg;
+
+    return periods * TIME_PERIOD_US + count;
+}
+
+uint32_t time_millis(void)
+{
+    return time_micros() / 1000UL;
+}
+
+uint16_t time_micros16(void)
+{
+    uint16_t base;
+    uint16_t count;
+
+    base = period_base16;
+    count = TCNT1;
+
+    // meme lecture de TOP que time_micros
+    if(count >= TIME_TOP)
+    {
+        count = 0;
+    }
+
+    // meme correction que time_micros si l'interruption est en attente
+    if(read_bit(TIFR, TOV1) && count < TIME_TOP / 2)
+    {
+        base += (uint16_t)TIME_PERIOD_US;
+    }
+
+    return base + count;
+}
+
+bool time_add_tick_callback(time_tick_callback_t callback)
+{
+    bool added = FALSE;
+
+    if(nb_tick_callbacks < TIME_NB_TICK_CALLBACKS)
+    {
+        // le callback doit etre en place avant que l'interruption puisse le voir
+        tick_callbacks[nb_tick_callbacks] = callback;
+        nb_tick_callbacks++;
+        added = TRUE;
+    }
+
+    return added;
+}
@@ -0,0 +1,103 @@
+#ifndef TIME_H_INCLUDED
+#define TIME_H_INCLUDED
+
+/**
+	\file time.h
+	\brief base de temps monotone en microsecondes partagee par tous les modules
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Le module ne consomme aucun timer supplementaire: il reutilise le timer 1 configure pour les
+    servomoteurs (compte a 1 MHz, TOP = ICR1 = 20000). L'interruption de fin de periode compte les
+    periodes et le temps courant est obtenu en ajoutant TCNT1. En mode 14, l'interruption est
+    demandee quand le compteur atteint TOP: TOP est donc lu comme le 0 de la periode suivante. Le
+    temps avance de 2 us en arrivant a TOP puis reste sur la meme valeur jusqu'a BOTTOM, mais ne
+    recule jamais, que l'interruption soit servie ou encore en attente.
+
+    L'interruption de fin de periode sert aussi de "tick" aux modules qui doivent faire un traitement
+    periodique (failsafe, ...). Ceux-ci s'enregistrent avec time_add_tick_callback. Les callbacks
+    s'executent dans l'interruption, ils doivent donc etre courts.
+
+    Les callbacks s'executent dans l'ordre de leur enregistrement. Un module qui applique des cibles
+    donnees par d'autres ticks (slew.c, ramp.c) doit donc s'enregistrer apres eux, sinon leurs
+    cibles ne sont appliquees qu'a la periode suivante. aero.c enregistre le failsafe, la courbe de
+    depart, puis slew.c et ramp.c.
+
+    time_micros revient a 0 apres environ 71 minutes, les durees doivent etre calculees par
+    soustraction (fin - debut) pour rester valides au passage.
+
+    Une implementation pour les tests sur PC existe dans host/time_stub.c.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief valeur de TOP du timer 1 (ICR1)
+*/
+#define TIME_TOP 20000
+
+/**
+    \brief duree d'une periode du timer 1 en us, le compteur va de 0 a TOP inclusivement
+*/
+#define TIME_PERIOD_US (TIME_TOP + 1UL)
+
+/**
+    \brief nombre maximal de callbacks appeles a chaque fin de periode
+*/
+#define TIME_NB_TICK_CALLBACKS 6
+
+/**
+    \brief fonction appelee a chaque fin de periode, dans l'interruption
+*/
+typedef void (*time_tick_callback_t)(void);
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief demarre la base de temps
+    \return void
+
+    Configure le timer 1 de la meme maniere que servo_init (sans toucher aux sorties ni au compteur),
+    l'ordre des appels n'a donc pas d'importance. Active l'interruption de fin de periode.
+*/
+void time_init(void);
+
+/**
+    \brief retourne le temps ecoule depuis time_init
+    \return le temps en us
+*/
+uint32_t time_micros(void);
+
+/**
+    \brief retourne le temps ecoule depuis time_init
+    \return le temps en ms
+*/
+uint32_t time_millis(void);
+
+/**
+    \brief retourne les 16 bits de poids faible de time_micros, beaucoup plus rapidement
+    \return le temps en us, revient a 0 aux 65.536 ms
+
+    Doit etre appele avec les interruptions masquees, c'est a l'appelant de garantir que
+    l'interruption de fin de periode ne survient pas pendant la lecture.
+*/
+uint16_t time_micros16(void);
+
+/**
+    \brief ajoute une fonction a appeler a chaque fin de periode (aux 20 ms)
+    \param[in] callback la fonction a appeler
+    \return TRUE si la fonction a ete ajoutee, FALSE s'il n'y a plus de place
+
+    la fonction est appelee apres celles deja enregistrees
+*/
+bool time_add_tick_callback(time_tick_callback_t callback);
+
+#endif
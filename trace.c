@@ -0,0 +1,104 @@
+/**
+	\file trace.c
+	\brief trace d'evenements horodates conservee en RAM et envoyee sur demande par le UART
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "hal.h"
+
+#include "trace.h"
+#include "time.h"
+#include "frame.h"
+#include "uart.h"
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+static trace_record_t records[TRACE_SIZE];
+
+// position du prochain enregistrement
+static volatile uint8_t next_index;
+
+// nombre d'enregistrements valides, sature a TRACE_SIZE
+static volatile uint8_t nb_records;
+
+static volatile bool recording;
+
+/******************************************************************************
+Definitions des fonctions
+******************************************************************************/
+void trace_init(void)
+{
+    uint8_t sreg;
+
+    sreg = SREG;
+    cli();
+
+    next_index = 0;
+    nb_records = 0;
+    recording = TRUE;
+
+    SREG = sreg;
+}
+
+void trace_record(uint8_t event, uint8_t arg)
+{
+    uint8_t sreg;
+    trace_record_t* record;
+
+    sreg = SREG;
+    cli();
+
+    if(recording)
+    {
+        record = &records[next_index];
+        record->event = event;
+        record->arg = arg;
+        record->timestamp = time_micros16() >> TRACE_TIMESTAMP_SHIFT;
+
+        next_index = (next_index + 1) & (TRACE_SIZE - 1);
+
+        if(nb_records < TRACE_SIZE)
+        {
+            nb_records++;
+        }
+    }
+
+    SREG = sreg;
+}
+
+void trace_dump(void)
+{
+    uint8_t i;
+    uint8_t index;
+    uint8_t data[5];
+    char encoded[FRAME_ENCODED_MAX_LENGTH];
+
+    recording = FALSE;
+
+    // le plus vieux enregistrement est juste apres le plus recent dans le buffer circulaire
+    index = (next_index - nb_records) & (TRACE_SIZE - 1);
+
+    for(i = 0; i < nb_records; i++)
+    {
+        data[0] = FRAME_TYPE_TRACE_RECORD;
+        data[1] = records[index].event;
+        data[2] = records[index].arg;
+        data[3] = (uint8_t)(records[index].timestamp & 0xFF);
+        data[4] = (uint8_t)(records[index].timestamp >> 8);
+
+        frame_encode(encoded, data, sizeof(data));
+        uart_put_string(encoded);
+
+        index = (index + 1) & (TRACE_SIZE - 1);
+    }
+
+    uart_flush();
+
+    trace_init();
+}
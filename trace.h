@@ -0,0 +1,109 @@
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+/**
+	\file trace.h
+	\brief trace d'evenements horodates conservee en RAM et envoyee sur demande par le UART
+	\author Lucas Mongrain
+    \author Temuujin Darkhantsetseg
+	\date 19/10/26
+
+    Chaque enregistrement contient un evenement, un argument et un timestamp de 16 bits en unites
+    de 8 us (TRACE_TIMESTAMP_SHIFT), qui revient donc a 0 aux 524 ms. Les enregistrements sont
+    conserves dans un buffer circulaire, les plus vieux sont ecrases.
+
+    L'enregistrement ne coute que quelques cycles et peut rester actif dans la version de course.
+    Pour le retirer completement, il suffit de compiler avec -DTRACE_DISABLE.
+
+    Sur reception d'une trame FRAME_TYPE_TRACE_REQUEST, l'aeroglisseur envoie chaque enregistrement
+    dans une trame FRAME_TYPE_TRACE_RECORD. Le programme host/trace_decode.c transforme une capture
+    de ces trames en ligne du temps, par exemple:
+
+        printf 'ABTAC' | nc -u -w1 -p 31337 192.168.4.1 1337 > dump.bin
+        host/trace_decode dump.bin
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+#include "utils.h"
+
+/******************************************************************************
+Defines
+******************************************************************************/
+/**
+    \brief nombre d'enregistrements conserves, doit etre une puissance de 2
+*/
+#define TRACE_SIZE 32
+
+/**
+    \brief nombre de bits de poids faible de time_micros16 retires du timestamp (unites de 8 us)
+*/
+#define TRACE_TIMESTAMP_SHIFT 3
+
+/**
+    \brief evenements enregistres
+*/
+typedef enum
+{
+    TRACE_FRAME_START = 1,      // debut du traitement d'une commande
+    TRACE_FRAME_END,            // fin du traitement d'une commande (reponse envoyee)
+    TRACE_SERVO_UPDATE,         // ecriture de OCR1A par slew.c, arg = OCR1A / 8
+    TRACE_LCD_FLUSH,            // mise a jour du LCD, arg = 0 au debut, 1 a la fin
+    TRACE_ISR_RX,               // interruption de reception, arg = byte recu (-DUART_TRACE_BYTES)
+    TRACE_ISR_UDRE,             // interruption de transmission, arg = byte envoye (-DUART_TRACE_BYTES)
+    TRACE_ISR_TICK,             // interruption de fin de periode du timer 1
+    TRACE_FAILSAFE,             // perte du lien, arg = nombre de pertes
+    TRACE_LAUNCH,               // courbe de depart, arg = 1 au depart, 0 a la fin ou a l'arret
+    TRACE_RAMP,                 // rampe des moteurs, arg = canaux qui saturent (voir ramp.h)
+    TRACE_FRAME_RX,             // trame complete decodee par la boucle principale, arg = type
+    TRACE_FRAME_TX,             // trame remise au UART par la boucle principale, arg = type
+    TRACE_NB_EVENTS
+}trace_event_enum;
+
+/**
+    \brief un enregistrement
+*/
+typedef struct
+{
+    uint8_t event;
+    uint8_t arg;
+    uint16_t timestamp;
+}trace_record_t;
+
+#ifdef TRACE_DISABLE
+    #define TRACE(event, arg)
+#else
+    #define TRACE(event, arg) trace_record((event), (arg))
+#endif
+
+/******************************************************************************
+Prototypes
+******************************************************************************/
+/**
+    \brief vide la trace et demarre l'enregistrement
+    \return void
+*/
+void trace_init(void);
+
+/**
+    \brief ajoute un enregistrement a la trace, peut etre appele d'une interruption
+    \param[in] event l'evenement (trace_event_enum)
+    \param[in] arg l'argument de l'evenement
+    \return void
+
+    utiliser plutot la macro TRACE pour pouvoir retirer la trace a la compilation
+*/
+void trace_record(uint8_t event, uint8_t arg);
+
+/**
+    \brief envoie tous les enregistrements, du plus vieux au plus recent, puis vide la trace
+    \return void
+
+    l'enregistrement est suspendu pendant l'envoi pour que les interruptions de transmission
+    n'ecrasent pas les enregistrements qui n'ont pas encore ete envoyes. Cette fonction attend
+    que tout soit dans le buffer de transmission et peut donc etre longue a retourner.
+*/
+void trace_dump(void);
+
+#endif
@@ -18,12 +18,19 @@
 Includes and defines
 ******************************************************************************/
 
-#include <avr/io.h>
-#include <avr/interrupt.h>
+#include "hal.h"
 
 #include "uart.h"
 
-#include "fifo.h"
+#include "fifo.h"
+
+#ifdef UART_TRACE_BYTES
+    #include "trace.h"
+#endif
+
+#ifdef UART_RX_TIMESTAMPS
+    #include "time.h"
+#endif
 
 
 /******************************************************************************
@@ -76,6 +83,15 @@ static volatile uint8_t tx_buffer[UART_TX_BUFFER_SIZE];
 static fifo_t rx_fifo;
 static fifo_t tx_fifo;
 
+static volatile uart_overflow_policy_e rx_overflow_policy;
+static volatile bool rx_overflowed;
+
+#ifdef UART_RX_TIMESTAMPS
+// heures de réception du premier byte de la dernière rafale et du dernier byte
+static volatile uint32_t rx_first;
+static volatile uint32_t rx_last;
+#endif
+
 
 /******************************************************************************
 Static prototypes
@@ -98,7 +114,14 @@ Interupts
 */
 ISR(USART_UDRE_vect){
 
-    UDR = fifo_pop(&tx_fifo);
+    uint8_t byte;
+
+    byte = fifo_pop(&tx_fifo);
+    UDR = byte;
+
+#ifdef UART_TRACE_BYTES
+    TRACE(TRACE_ISR_UDRE, byte);
+#endif
 
     if(fifo_is_empty(&tx_fifo) == TRUE){
 
@@ -112,7 +135,39 @@ ISR(USART_UDRE_vect){
 */
 ISR(USART_RXC_vect){
 
-    fifo_push(&rx_fifo, UDR);
+    // UDR ne peut être lu qu'une seule fois par byte reçu
+    uint8_t byte = UDR;
+
+#ifdef UART_RX_TIMESTAMPS
+    uint32_t now = time_micros();
+
+    // la ligne est restée silencieuse, ce byte commence une nouvelle rafale
+    if(now - rx_last > UART_RX_IDLE_US){
+
+        rx_first = now;
+    }
+
+    rx_last = now;
+#endif
+
+#ifdef UART_TRACE_BYTES
+    TRACE(TRACE_ISR_RX, byte);
+#endif
+
+    if(fifo_is_full(&rx_fifo) == TRUE){
+
+        rx_overflowed = TRUE;
+    }
+
+    if(rx_overflow_policy == UART_OVERFLOW_DROP_OLDEST){
+
+        fifo_push_overwrite(&rx_fifo, byte);
+    }
+
+    else{
+
+        fifo_push(&rx_fifo, byte);
+    }
 }
 
 
@@ -123,6 +178,17 @@ Global functions
 /*** initialize uart ***/
 void uart_init(void){
 
+    /*initialisation des fifos respectifs, avant d'activer l'interruption RX */
+    fifo_init(&rx_fifo, (uint8_t*)rx_buffer, UART_RX_BUFFER_SIZE);
+    fifo_init(&tx_fifo, (uint8_t*)tx_buffer, UART_TX_BUFFER_SIZE);
+
+    rx_overflow_policy = UART_OVERFLOW_DROP_NEWEST;
+    rx_overflowed = FALSE;
+#ifdef UART_RX_TIMESTAMPS
+    rx_first = 0;
+    rx_last = 0;
+#endif
+
     /* configure asynchronous operation, no parity, 1 stop bit, 8 data bits,  */
     UCSRC = (	(1 << URSEL) |	/*Doit absolument être a 1 pour écrire le registe UCSRC (gros caca d'ATmega32) */
                 (0 << UMSEL) |	/*USART Mode Select : Asynchronous USART*/
@@ -144,10 +210,6 @@ void uart_init(void){
     UCSRA = (	(0 << U2X) |    /*Double the USART Transmission Speed*/
 				(0 << MPCM));   /*Multi-processor Communication Mode*/
 
-    /*initialisation des fifos respectifs */
-    fifo_init(&rx_fifo, (uint8_t*)rx_buffer, UART_RX_BUFFER_SIZE);
-    fifo_init(&tx_fifo, (uint8_t*)tx_buffer, UART_TX_BUFFER_SIZE);
-
     uart_set_baudrate(DEFAULT_BAUDRATE);
 }
 
@@ -185,7 +247,9 @@ void uart_put_string(char* string){
 	
 	while(string[i] != '\0'){
 		
-		while(fifo_is_full(&tx_fifo)  == TRUE);
+		while(fifo_is_full(&tx_fifo)  == TRUE){
+			hal_spin();
+		}
 		
 		//on commence par désactiver l'interuption pour éviter que celle-ci
 		//se produise pendant qu'on ajoute un caractère au buffer
@@ -205,6 +269,31 @@ void uart_put_string(char* string){
 	}
 }
 
+/*** uart_put_string_P ***/
+void uart_put_string_P(const char* string){
+
+	char character = pgm_read_byte(string);
+
+	while(character != '\0'){
+
+		while(fifo_is_full(&tx_fifo)  == TRUE){
+			hal_spin();
+		}
+
+		disable_UDRE_interupt();
+
+		while((character != '\0') && (fifo_is_full(&tx_fifo)  == FALSE)){
+
+			fifo_push(&tx_fifo, character);
+
+			string++;
+			character = pgm_read_byte(string);
+		}
+
+		enable_UDRE_interupt();
+	}
+}
+
 /*** uart_get_byte ***/
 uint8_t uart_get_byte(void){
 
@@ -258,7 +347,9 @@ void uart_clean_rx_buffer(void){
 /*** uart_flush ***/
 void uart_flush(void){
 	
-	while(uart_is_tx_buffer_empty() == FALSE);
+	while(uart_is_tx_buffer_empty() == FALSE){
+		hal_spin();
+	}
 }
 
 /*** is_rx_buffer_empty ***/
@@ -274,6 +365,41 @@ bool uart_is_tx_buffer_empty(void){
 }
 
 
+/*** uart_set_rx_overflow_policy ***/
+void uart_set_rx_overflow_policy(uart_overflow_policy_e policy){
+
+    rx_overflow_policy = policy;
+}
+
+/*** uart_is_rx_overflowed ***/
+bool uart_is_rx_overflowed(void){
+
+    bool overflowed;
+
+    disable_RX_interupt();
+
+    overflowed = rx_overflowed;
+    rx_overflowed = FALSE;
+
+    enable_RX_interupt();
+
+    return overflowed;
+}
+
+#ifdef UART_RX_TIMESTAMPS
+/*** uart_get_rx_timestamps ***/
+void uart_get_rx_timestamps(uint32_t* first, uint32_t* last){
+
+    disable_RX_interupt();
+
+    *first = rx_first;
+    *last = rx_last;
+
+    enable_RX_interupt();
+}
+#endif
+
+
 /******************************************************************************
 Static functions
 ******************************************************************************/
@@ -46,6 +46,36 @@ typedef enum{
 
 #define DEFAULT_BAUDRATE BAUDRATE_9600
 
+/**
+    \brief Silence minimal sur la ligne, en us, pour qu'un byte reçu commence une nouvelle rafale
+
+	Environ 3 bytes à 9600 bauds. Le module wifi remet chaque paquet UDP d'un seul coup.
+*/
+#define UART_RX_IDLE_US 3000UL
+
+/*
+    Options de compilation (désactivées par défaut)
+
+    UART_RX_TIMESTAMPS : l'interruption de réception note l'heure (time_micros) de chaque
+    rafale, lue par uart_get_rx_timestamps. Demande time.c au link. Activé pour aero et
+    pour la mesure de latence de la manette.
+
+    UART_TRACE_BYTES : chaque byte reçu ou envoyé est enregistré dans la trace (TRACE_ISR_RX,
+    TRACE_ISR_UDRE). Demande trace.c au link. Une trame de statut remplit à elle seule la
+    trace, à n'utiliser que pour déboguer la liaison série.
+*/
+
+
+/**
+    \brief Comportement du buffer de réception lorsqu'il déborde
+*/
+typedef enum{
+
+    UART_OVERFLOW_DROP_NEWEST = 0,  /* Les nouveaux bytes sont perdus (par défaut) */
+    UART_OVERFLOW_DROP_OLDEST,      /* Les plus vieux bytes sont écrasés par les nouveaux */
+
+}uart_overflow_policy_e;
+
 /******************************************************************************
 Prototypes
 ******************************************************************************/
@@ -80,6 +110,15 @@ void uart_put_byte(uint8_t byte);
 */
 void uart_put_string(char* string);
 
+/**
+    \brief Comme uart_put_string, mais la string est lue dans la mémoire flash.
+    \param un pointeur en flash sur le premier char de la string, ex: PSTR("AT\r\n")
+
+	Les littéraux passés à uart_put_string sont copiés en SRAM au démarrage, ceux
+	passés ici restent en flash et sont copiés directement dans le rolling buffer.
+*/
+void uart_put_string_P(const char* string);
+
 /**
     \brief Retire un byte au rolling buffer reçu par le UART.
     \return le byte reçu
@@ -149,4 +188,37 @@ bool uart_is_rx_buffer_empty(void);
 bool uart_is_tx_buffer_empty(void);
 
 
+/**
+    \brief Choisit ce qui arrive quand un byte est reçu alors que le buffer de réception est plein
+    \param policy UART_OVERFLOW_DROP_NEWEST ou UART_OVERFLOW_DROP_OLDEST
+
+	Avec UART_OVERFLOW_DROP_OLDEST, le buffer contient toujours les bytes les plus récents, ce qui
+	est préférable quand seule la dernière commande reçue a de l'importance.
+*/
+void uart_set_rx_overflow_policy(uart_overflow_policy_e policy);
+
+
+/**
+    \brief Indique si des bytes ont été perdus depuis le dernier appel
+    \return TRUE si le buffer de réception a débordé depuis le dernier appel
+
+	L'indicateur est remis à FALSE par l'appel. Après un débordement, une trame en cours de
+	réception est probablement corrompue.
+*/
+bool uart_is_rx_overflowed(void);
+
+
+/**
+    \brief Donne l'heure de réception de la dernière rafale de bytes
+    \param[out] first l'heure (time_micros) du premier byte de la rafale
+    \param[out] last l'heure (time_micros) du dernier byte reçu
+
+	Une rafale est une suite de bytes sans silence plus long que UART_RX_IDLE_US. Les heures
+	ne sont valides que si time_init a été appelé. Compilé seulement avec UART_RX_TIMESTAMPS.
+*/
+#ifdef UART_RX_TIMESTAMPS
+void uart_get_rx_timestamps(uint32_t* first, uint32_t* last);
+#endif
+
+
 #endif // UART_H_INCLUDED
@@ -9,6 +9,7 @@
 /******************************************************************************
 Includes
 ******************************************************************************/
+#include "hal.h"
 #include "utils.h"
 #include "util_29.h"
 
@@ -22,6 +23,18 @@ void string_concat(char* dst, char* src1, char* src2)
     string_copy(&dst[index], src2);
 }
 
+void string_concat_P(char* dst, char* src1, const char* src2)
+{
+    uint32_t index = 0;
+    index = string_copy(dst, src1);
+
+    while((dst[index] = pgm_read_byte(src2)) != '\0')
+    {
+        index++;
+        src2++;
+    }
+}
+
 void add_data_to_string(char* str, char* data_str, uint8_t data)
 {
     uint8_to_string(data_str, data);
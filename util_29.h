@@ -18,6 +18,15 @@
 */
 void string_concat(char* dst, char* src1, char* src2);
 
+/**
+    \brief concatene deux chaine en une seule, la deuxieme etant en flash
+    \param[in,out] dst chaine de destination de la concatenation
+    \param[in] src1 premiere chaine a concatener
+    \param[in] src2 deuxieme chaine a concatener, en flash (PSTR)
+    \return void
+*/
+void string_concat_P(char* dst, char* src1, const char* src2);
+
 /**
     \brief ajoute a la chaine de transmission une valeur et converti un nombre en ascii par la meme occasion
     \param[in,out] str chaine de transmission
@@ -169,7 +169,7 @@ char uint_to_char(uint8_t digit){
 
     char caracter = '\0';
 
-    if((digit >= 0) && (digit <= 9)){
+    if(digit <= 9){
 
         caracter = digit + '0';
     }
@@ -182,7 +182,7 @@ char uint_to_hex_char(uint8_t hex_digit){
 
 	char caracter = '\0';
 
-	if((hex_digit >= 0x00) && (hex_digit <= 0x09)){
+	if(hex_digit <= 0x09){
 
 		caracter = hex_digit + '0';
 	}